@@ -20,29 +20,50 @@
 #include <cstdint>
 #include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <thread>
 #include <unordered_map>
 #include <vector>
 
 #include "midi_client.h"
 #include "midi_service_interface.h"
+#include "midi_histogram.h"
 #include "midi_shared_ring.h"
+#include "midi_thread_config.h"
 #include "midi_callback_stub.h"
 #include "midi_device_open_callback_stub.h"
 namespace OHOS {
 namespace MIDI {
 
 class MidiClientCallback;
+
+// receiver side settings of a client, shared with every device it opened
+struct MidiReceiverThreadSettings {
+    std::mutex mutex;
+    MidiThreadConfig config;
+    // fixed by MidiClientPrivate::Init before any device is opened
+    OH_OnMIDIInputOverflow onInputOverflow = nullptr;
+    void *userData = nullptr;
+
+    MidiThreadConfig Get()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return config;
+    }
+};
+
 class MidiClientDeviceOpenCallback : public MidiDeviceOpenCallbackStub {
 public:
     MidiClientDeviceOpenCallback(std::shared_ptr<MidiServiceInterface> midiServiceInterface,
-        OH_MIDIOnDeviceOpened callback, void *userData);
+        OH_MIDIOnDeviceOpened callback, void *userData,
+        std::shared_ptr<MidiReceiverThreadSettings> receiverSettings = nullptr);
     ~MidiClientDeviceOpenCallback() = default;
     int32_t NotifyDeviceOpened(bool opened, const std::map<int32_t, std::string> &deviceInfo) override;
 private:
     std::weak_ptr<MidiServiceInterface> ipc_;
     OH_MIDIOnDeviceOpened callback_;
     void *userData_;
+    std::shared_ptr<MidiReceiverThreadSettings> receiverSettings_;
 };
     
 class MidiInputPort {
@@ -50,14 +71,21 @@ public:
     MidiInputPort(OH_OnMIDIReceived callback, void *userData, OH_MIDIProtocol protocol);
     ~MidiInputPort();
     std::shared_ptr<MidiSharedRing> &GetRingBuffer();
+    // takes effect when the receiver thread starts
+    void SetThreadConfig(const MidiThreadConfig &config);
+    // called on the receiver thread for every overflow marker the service wrote
+    void SetOverflowCallback(OH_OnMIDIInputOverflow callback, void *userData, int64_t deviceId, uint32_t portIndex);
 
     bool StartReceiverThread();
     bool StopReceiverThread();
+    // ns from the driver timestamp to the callback; minus the service's delivery_delay it is the ring residence
+    const MidiHistogram &GetDispatchDelayHistogram() const { return dispatchDelayHistogram_; }
 
 private:
     void ReceiverThreadLoop();
 
     void DrainRingAndDispatch();
+    void DispatchRange(size_t begin, size_t end);
 
     bool ShouldWakeForReadOrExit() const;
 
@@ -67,6 +95,13 @@ private:
     std::thread receiverThread_;
     void *userData_ = nullptr;
     OH_MIDIProtocol protocol_;
+    MidiThreadConfig threadConfig_;
+    std::vector<OH_MIDIEvent> callbackEvents_;  // views into ringBuffer_, reused by receiver thread
+    MidiHistogram dispatchDelayHistogram_;      // written by the receiver thread
+    OH_OnMIDIInputOverflow overflowCallback_ = nullptr;
+    void *overflowUserData_ = nullptr;
+    int64_t deviceId_ = 0;
+    uint32_t portIndex_ = 0;
 };
 
 class MidiOutputPort {
@@ -74,15 +109,64 @@ public:
     MidiOutputPort(OH_MIDIProtocol protocol);
     ~MidiOutputPort();
     int32_t Send(OH_MIDIEvent *events, uint32_t eventCount, uint32_t *eventsWritten);
+    int32_t SendBlocking(OH_MIDIEvent *events, uint32_t eventCount, uint32_t *eventsWritten, int64_t timeoutInNs);
+    int32_t SendSysEx(const uint8_t *data, uint32_t byteSize);
+    // drops everything queued so far, including events the service already scheduled for later
+    int32_t Flush();
     std::shared_ptr<MidiSharedRing> &GetRingBuffer();
+    // extra single producer rings, set once before the port is published
+    void SetLanes(std::vector<std::shared_ptr<MidiSharedRing>> rings);
+    // releases senders parked in SendBlocking, called before the port is removed
+    void Close();
 private:
+    // an extra ring of the port and the one thread allowed to write it
+    struct Lane {
+        std::shared_ptr<MidiSharedRing> ring;
+        std::atomic<std::thread::id> owner{};
+    };
+
+    // counts a SendBlocking or SendSysEx on ringBuffer_ from before it takes sendMutex_ until it returns
+    class BlockingSendScope {
+    public:
+        explicit BlockingSendScope(std::atomic<uint32_t> &counter) : counter_(counter)
+        {
+            counter_.fetch_add(1, std::memory_order_acq_rel);
+        }
+        ~BlockingSendScope() { counter_.fetch_sub(1, std::memory_order_acq_rel); }
+        BlockingSendScope(const BlockingSendScope &) = delete;
+        BlockingSendScope &operator=(const BlockingSendScope &) = delete;
+
+    private:
+        std::atomic<uint32_t> &counter_;
+    };
+
+    // the lane bound to the calling thread, binding a free one on first use; nullptr when every lane is taken
+    MidiSharedRing *LaneOfThisThread();
+    int32_t CheckSendArgs(OH_MIDIEvent *events, uint32_t eventCount, uint32_t *eventsWritten) const;
+    std::vector<MidiEventInner> &ToInnerEvents(OH_MIDIEvent *events, uint32_t eventCount) const;
+    int32_t FlushSysExBatch();
+
     std::shared_ptr<MidiSharedRing> ringBuffer_ = nullptr;
+    // Send and SendBlocking of a bound thread go to its lane without sendMutex_, SendSysEx and unbound
+    // threads stay on ringBuffer_; the service orders the lanes against each other by timestamp only
+    std::unique_ptr<Lane[]> lanes_;
+    size_t laneCount_ = 0;
     OH_MIDIProtocol protocol_;
+    std::atomic<bool> closed_ = false;
+    // keeps the ring single producer across Send, SendBlocking and SendSysEx; a MULTI_PRODUCER ring only
+    // serialises SendBlocking and SendSysEx, Send writes without it
+    std::mutex sendMutex_;
+    // Send waits behind another Send, but returns WOULD_BLOCK instead of waiting behind one of these
+    std::atomic<uint32_t> blockingSenders_{0};
+    std::mutex flushMutex_;  // separate from sendMutex_ so a flush is not stuck behind a blocked sender
+    std::vector<uint32_t> sysExWords_;         // UMP words of the batch being built, guarded by sendMutex_
+    std::vector<MidiEventInner> sysExEvents_;  // one event per UMP packet, pointing into sysExWords_
 };
 
 class MidiDevicePrivate : public MidiDevice {
 public:
-    MidiDevicePrivate(std::shared_ptr<MidiServiceInterface> midiServiceInterface, int64_t deviceId);
+    MidiDevicePrivate(std::shared_ptr<MidiServiceInterface> midiServiceInterface, int64_t deviceId,
+        std::shared_ptr<MidiReceiverThreadSettings> receiverSettings = nullptr);
     virtual ~MidiDevicePrivate();
     OH_MIDIStatusCode CloseDevice() override;
     OH_MIDIStatusCode OpenInputPort(OH_MIDIPortDescriptor descriptor,
@@ -91,13 +175,17 @@ public:
     OH_MIDIStatusCode ClosePort(uint32_t portIndex) override;
     OH_MIDIStatusCode Send(uint32_t portIndex, OH_MIDIEvent *events,
                             uint32_t eventCount, uint32_t *eventsWritten) override;
+    OH_MIDIStatusCode SendBlocking(uint32_t portIndex, OH_MIDIEvent *events, uint32_t eventCount,
+                                   uint32_t *eventsWritten, int64_t timeoutInNs) override;
+    OH_MIDIStatusCode SendSysEx(uint32_t portIndex, uint8_t *data, uint32_t byteSize) override;
     OH_MIDIStatusCode FlushOutputPort(uint32_t portIndex) override;
 
 private:
     std::weak_ptr<MidiServiceInterface> ipc_;
     int64_t deviceId_;
+    std::shared_ptr<MidiReceiverThreadSettings> receiverSettings_;
     std::mutex inputPortsMutex_;
-    std::mutex outputPortsMutex_;
+    std::shared_mutex outputPortsMutex_;  // shared for sending, exclusive for open and close
     std::unordered_map<uint32_t, std::shared_ptr<MidiInputPort>> inputPortsMap_;
     std::unordered_map<uint32_t, std::shared_ptr<MidiOutputPort>> outputPortsMap_;
 };
@@ -112,12 +200,14 @@ public:
     OH_MIDIStatusCode OpenBleDevice(std::string address, OH_MIDIOnDeviceOpened callback, void *userData) override;
     OH_MIDIStatusCode GetDevicePorts(int64_t deviceId, OH_MIDIPortInformation *infos, size_t *numPorts) override;
     OH_MIDIStatusCode DestroyMidiClient() override;
+    OH_MIDIStatusCode SetReceiverThreadConfig(const OH_MIDIThreadConfig &config) override;
 private:
     void DeviceChange(OH_MIDIDeviceChangeAction change, OH_MIDIDeviceInformation info);
     std::shared_ptr<MidiServiceInterface> ipc_;
     uint32_t clientId_;
     std::vector<OH_MIDIDeviceInformation> deviceInfos_;
     sptr<MidiClientCallback> callback_;
+    std::shared_ptr<MidiReceiverThreadSettings> receiverSettings_;
     std::mutex mutex_;
 };
 } // namespace MIDI
@@ -37,12 +37,15 @@ public:
     OH_MIDIStatusCode CloseDevice(int64_t deviceId) override;
     OH_MIDIStatusCode GetDevicePorts(int64_t deviceId, std::vector<std::map<int32_t, std::string>> &portInfos) override;
     OH_MIDIStatusCode OpenInputPort(std::shared_ptr<MidiSharedRing> &buffer, int64_t deviceId,
-                                    uint32_t portIndex) override;
+                                    uint32_t portIndex, uint32_t bufferSize) override;
     OH_MIDIStatusCode OpenOutputPort(std::shared_ptr<MidiSharedRing> &buffer, int64_t deviceId,
-                                    uint32_t portIndex) override;
+                                    uint32_t portIndex, uint32_t bufferSize, bool multiProducer) override;
     OH_MIDIStatusCode CloseInputPort(int64_t deviceId, uint32_t portIndex) override;
     OH_MIDIStatusCode CloseOutputPort(int64_t deviceId, uint32_t portIndex) override;
     OH_MIDIStatusCode DestroyMidiClient() override;
+    OH_MIDIStatusCode GetStatistics(std::string &statistics) override;
+    OH_MIDIStatusCode OpenOutputLane(std::shared_ptr<MidiSharedRing> &buffer, int64_t deviceId,
+                                    uint32_t portIndex, uint32_t bufferSize) override;
 
 private:
     sptr<IIpcMidiInServer> ipc_;
@@ -35,12 +35,17 @@ public:
                                              std::vector<std::map<int32_t, std::string>> &portInfos) = 0;
     virtual OH_MIDIStatusCode OpenBleDevice(std::string address, sptr<MidiDeviceOpenCallbackStub> callback) = 0;
     virtual OH_MIDIStatusCode OpenInputPort(std::shared_ptr<MidiSharedRing> &buffer, int64_t deviceId,
-                                            uint32_t portIndex) = 0;
+                                            uint32_t portIndex, uint32_t bufferSize) = 0;
     virtual OH_MIDIStatusCode OpenOutputPort(std::shared_ptr<MidiSharedRing> &buffer, int64_t deviceId,
-                                    uint32_t portIndex) = 0;
+                                    uint32_t portIndex, uint32_t bufferSize, bool multiProducer) = 0;
     virtual OH_MIDIStatusCode CloseInputPort(int64_t deviceId, uint32_t portIndex) = 0;
     virtual OH_MIDIStatusCode CloseOutputPort(int64_t deviceId, uint32_t portIndex) = 0;
     virtual OH_MIDIStatusCode DestroyMidiClient() = 0;
+    // counters of this client's own ports as text, for diagnostics
+    virtual OH_MIDIStatusCode GetStatistics(std::string &statistics) = 0;
+    // one more single producer ring on an output port this client already opened
+    virtual OH_MIDIStatusCode OpenOutputLane(std::shared_ptr<MidiSharedRing> &buffer, int64_t deviceId,
+                                    uint32_t portIndex, uint32_t bufferSize) = 0;
 };
 } // namespace MIDI
 } // namespace OHOS
@@ -17,18 +17,31 @@
 #define LOG_TAG "MidiClient"
 #endif
 
+#include <algorithm>
 #include <cstring>
 #include <chrono>
+#include <optional>
 
 #include "midi_log.h"
 #include "midi_client_private.h"
 #include "midi_service_client.h"
 #include "securec.h"
+#include "ump_processor.h"
 
 namespace OHOS {
 namespace MIDI {
 namespace {
     constexpr uint32_t MAX_EVENTS_NUMS = 1000;
+    constexpr uint8_t SYSEX_START = 0xF0;
+    constexpr uint8_t SYSEX_END = 0xF7;
+    constexpr uint32_t SYSEX_MIN_BYTES = 2;
+    // packets handed to the ring per write, one MT=3 packet carries 6 data bytes
+    constexpr size_t SYSEX_BATCH_PACKETS = 256;
+    constexpr size_t SYSEX_CHUNK_BYTES = SYSEX_BATCH_PACKETS * UmpProcessor::SYSEX_BUFFER_SIZE;
+    // give up when the service has not freed any space for this long
+    constexpr int64_t SYSEX_STALL_TIMEOUT_NS = 2000LL * 1000 * 1000;
+    // rings per output port, the shared one included; the service enforces the same limit
+    constexpr uint32_t MAX_OUTPUT_LANES = 8;
 }  // namespace
 class MidiClientCallback : public MidiCallbackStub {
 public:
@@ -85,8 +98,8 @@ static bool ConvertToDeviceInformation(
     return true;
 }
 MidiClientDeviceOpenCallback::MidiClientDeviceOpenCallback(std::shared_ptr<MidiServiceInterface> midiServiceInterface,
-    OH_MIDIOnDeviceOpened callback, void *userData)
-    : ipc_(midiServiceInterface), callback_(callback), userData_(userData)
+    OH_MIDIOnDeviceOpened callback, void *userData, std::shared_ptr<MidiReceiverThreadSettings> receiverSettings)
+    : ipc_(midiServiceInterface), callback_(callback), userData_(userData), receiverSettings_(receiverSettings)
 {
 }
 
@@ -100,7 +113,7 @@ int32_t MidiClientDeviceOpenCallback::NotifyDeviceOpened(bool opened, const std:
     }
     bool ret = ConvertToDeviceInformation(deviceInfo, info);
     CHECK_AND_RETURN_RET_LOG(ret, MIDI_STATUS_UNKNOWN_ERROR, "ConvertToDeviceInformation failed");
-    auto newDevice = new MidiDevicePrivate(ipc_.lock(), info.midiDeviceId);
+    auto newDevice = new MidiDevicePrivate(ipc_.lock(), info.midiDeviceId, receiverSettings_);
     callback_(userData_, opened, (OH_MIDIDevice *)newDevice, info);
     return 0;
 }
@@ -137,6 +150,10 @@ static int32_t GetStatusCode(MidiStatusCode code)
             return MIDI_STATUS_OK;
         case MidiStatusCode::WOULD_BLOCK:
             return MIDI_STATUS_WOULD_BLOCK;
+        case MidiStatusCode::TIMEOUT:
+            return MIDI_STATUS_TIMEOUT;
+        case MidiStatusCode::INVALID_ARGUMENT:
+            return MIDI_STATUS_GENERIC_INVALID_ARGUMENT;
         default:
             return MIDI_STATUS_UNKNOWN_ERROR;
     }
@@ -168,8 +185,9 @@ int32_t MidiClientCallback::NotifyError(int32_t code)
     return 0;
 }
 
-MidiDevicePrivate::MidiDevicePrivate(std::shared_ptr<MidiServiceInterface> midiServiceInterface, int64_t deviceId)
-    : ipc_(midiServiceInterface), deviceId_(deviceId)
+MidiDevicePrivate::MidiDevicePrivate(std::shared_ptr<MidiServiceInterface> midiServiceInterface, int64_t deviceId,
+    std::shared_ptr<MidiReceiverThreadSettings> receiverSettings)
+    : ipc_(midiServiceInterface), deviceId_(deviceId), receiverSettings_(receiverSettings)
 {
     MIDI_INFO_LOG("MidiDevicePrivate created");
 }
@@ -198,8 +216,13 @@ OH_MIDIStatusCode MidiDevicePrivate::OpenInputPort(OH_MIDIPortDescriptor descrip
     auto inputPort = std::make_shared<MidiInputPort>(callback, userData, descriptor.protocol);
 
     std::shared_ptr<MidiSharedRing> &buffer = inputPort->GetRingBuffer();
-    auto ret = ipc->OpenInputPort(buffer, deviceId_, descriptor.portIndex);
+    auto ret = ipc->OpenInputPort(buffer, deviceId_, descriptor.portIndex, descriptor.bufferSize);
     CHECK_AND_RETURN_RET_LOG(ret == MIDI_STATUS_OK, ret, "open inputport fail");
+    if (receiverSettings_ != nullptr) {
+        inputPort->SetThreadConfig(receiverSettings_->Get());
+        inputPort->SetOverflowCallback(receiverSettings_->onInputOverflow, receiverSettings_->userData, deviceId_,
+            descriptor.portIndex);
+    }
 
     CHECK_AND_RETURN_RET_LOG(
         inputPort->StartReceiverThread() == true, MIDI_STATUS_UNKNOWN_ERROR, "start receiver thread fail");
@@ -211,18 +234,38 @@ OH_MIDIStatusCode MidiDevicePrivate::OpenInputPort(OH_MIDIPortDescriptor descrip
 
 OH_MIDIStatusCode MidiDevicePrivate::OpenOutputPort(OH_MIDIPortDescriptor descriptor)
 {
-    std::lock_guard<std::mutex> lock(outputPortsMutex_);
+    std::unique_lock<std::shared_mutex> lock(outputPortsMutex_);
     auto ipc = ipc_.lock();
     CHECK_AND_RETURN_RET_LOG(ipc != nullptr, MIDI_STATUS_UNKNOWN_ERROR, "ipc_ is nullptr");
 
     auto iter = outputPortsMap_.find(descriptor.portIndex);
     CHECK_AND_RETURN_RET(iter == outputPortsMap_.end(), MIDI_STATUS_PORT_ALREADY_OPEN);
+    CHECK_AND_RETURN_RET_LOG(descriptor.laneCount <= MAX_OUTPUT_LANES, MIDI_STATUS_GENERIC_INVALID_ARGUMENT,
+        "laneCount %{public}u is invalid", descriptor.laneCount);
 
     auto outputPort = std::make_shared<MidiOutputPort>(descriptor.protocol);
     std::shared_ptr<MidiSharedRing> &buffer = outputPort->GetRingBuffer();
-    auto ret = ipc->OpenOutputPort(buffer, deviceId_, descriptor.portIndex);
+    auto ret = ipc->OpenOutputPort(buffer, deviceId_, descriptor.portIndex, descriptor.bufferSize,
+        descriptor.multiProducer);
     CHECK_AND_RETURN_RET_LOG(ret == MIDI_STATUS_OK, ret, "open outputport fail");
 
+    std::vector<std::shared_ptr<MidiSharedRing>> lanes;
+    for (uint32_t lane = 1; lane < descriptor.laneCount; ++lane) {
+        std::shared_ptr<MidiSharedRing> laneBuffer = nullptr;
+        ret = ipc->OpenOutputLane(laneBuffer, deviceId_, descriptor.portIndex, descriptor.bufferSize);
+        if (ret == MIDI_STATUS_OK && laneBuffer == nullptr) {
+            ret = MIDI_STATUS_UNKNOWN_ERROR;
+        }
+        if (ret != MIDI_STATUS_OK) {
+            // closing the port drops the lanes opened so far as well
+            MIDI_ERR_LOG("open lane %{public}u of outputport fail: %{public}d", lane, ret);
+            (void)ipc->CloseOutputPort(deviceId_, descriptor.portIndex);
+            return ret;
+        }
+        lanes.push_back(std::move(laneBuffer));
+    }
+    outputPort->SetLanes(std::move(lanes));
+
     outputPortsMap_.emplace(descriptor.portIndex, std::move(outputPort));
     MIDI_INFO_LOG("port[%{public}u] success", descriptor.portIndex);
     return MIDI_STATUS_OK;
@@ -231,19 +274,46 @@ OH_MIDIStatusCode MidiDevicePrivate::OpenOutputPort(OH_MIDIPortDescriptor descri
 OH_MIDIStatusCode MidiDevicePrivate::Send(uint32_t portIndex, OH_MIDIEvent *events,
     uint32_t eventCount, uint32_t *eventsWritten)
 {
-    std::lock_guard<std::mutex> lock(outputPortsMutex_);
+    // shared: senders on different ports, or on one multi-producer port, do not wait for each other here
+    std::shared_lock<std::shared_mutex> lock(outputPortsMutex_);
     auto iter = outputPortsMap_.find(portIndex);
     CHECK_AND_RETURN_RET_LOG(iter != outputPortsMap_.end(), MIDI_STATUS_INVALID_PORT, "invalid port");
     auto outputPort = iter->second;
     return (OH_MIDIStatusCode)outputPort->Send(events, eventCount, eventsWritten);
 }
 
+OH_MIDIStatusCode MidiDevicePrivate::SendBlocking(uint32_t portIndex, OH_MIDIEvent *events, uint32_t eventCount,
+    uint32_t *eventsWritten, int64_t timeoutInNs)
+{
+    std::shared_ptr<MidiOutputPort> outputPort = nullptr;
+    {
+        std::shared_lock<std::shared_mutex> lock(outputPortsMutex_);
+        auto iter = outputPortsMap_.find(portIndex);
+        CHECK_AND_RETURN_RET_LOG(iter != outputPortsMap_.end(), MIDI_STATUS_INVALID_PORT, "invalid port");
+        outputPort = iter->second;
+    }
+    // wait without the map lock, ClosePort wakes us through MidiOutputPort::Close
+    return (OH_MIDIStatusCode)outputPort->SendBlocking(events, eventCount, eventsWritten, timeoutInNs);
+}
+
+OH_MIDIStatusCode MidiDevicePrivate::SendSysEx(uint32_t portIndex, uint8_t *data, uint32_t byteSize)
+{
+    std::shared_ptr<MidiOutputPort> outputPort = nullptr;
+    {
+        std::shared_lock<std::shared_mutex> lock(outputPortsMutex_);
+        auto iter = outputPortsMap_.find(portIndex);
+        CHECK_AND_RETURN_RET_LOG(iter != outputPortsMap_.end(), MIDI_STATUS_INVALID_PORT, "invalid port");
+        outputPort = iter->second;
+    }
+    return (OH_MIDIStatusCode)outputPort->SendSysEx(data, byteSize);
+}
+
 OH_MIDIStatusCode MidiDevicePrivate::FlushOutputPort(uint32_t portIndex)
 {
-    std::lock_guard<std::mutex> lock(outputPortsMutex_);
+    std::shared_lock<std::shared_mutex> lock(outputPortsMutex_);
     auto iter = outputPortsMap_.find(portIndex);
     CHECK_AND_RETURN_RET(iter != outputPortsMap_.end(), MIDI_STATUS_INVALID_PORT);
-    return MIDI_STATUS_OK;
+    return (OH_MIDIStatusCode)iter->second->Flush();
 }
 
 OH_MIDIStatusCode MidiDevicePrivate::ClosePort(uint32_t portIndex)
@@ -260,9 +330,10 @@ OH_MIDIStatusCode MidiDevicePrivate::ClosePort(uint32_t portIndex)
         }
     }
     {
-        std::lock_guard<std::mutex> lock(outputPortsMutex_);
+        std::unique_lock<std::shared_mutex> lock(outputPortsMutex_);
         auto it = outputPortsMap_.find(portIndex);
         if (it != outputPortsMap_.end()) {
+            it->second->Close();
             ret = ipc->CloseOutputPort(deviceId_, portIndex);
             outputPortsMap_.erase(it);
         }
@@ -277,6 +348,20 @@ MidiInputPort::MidiInputPort(OH_OnMIDIReceived callback, void *userData, OH_MIDI
     MIDI_INFO_LOG("InputPort created");
 }
 
+void MidiInputPort::SetThreadConfig(const MidiThreadConfig &config)
+{
+    threadConfig_ = config;
+}
+
+void MidiInputPort::SetOverflowCallback(OH_OnMIDIInputOverflow callback, void *userData, int64_t deviceId,
+    uint32_t portIndex)
+{
+    overflowCallback_ = callback;
+    overflowUserData_ = userData;
+    deviceId_ = deviceId;
+    portIndex_ = portIndex;
+}
+
 bool MidiInputPort::StartReceiverThread()
 {
     CHECK_AND_RETURN_RET_LOG(running_.load() != true, false, "already start");
@@ -301,6 +386,7 @@ bool MidiInputPort::StopReceiverThread()
     if (receiverThread_.joinable()) {
         receiverThread_.join();
     }
+    MIDI_INFO_LOG("input dispatch delay ns: %{public}s", dispatchDelayHistogram_.Summary().c_str());
     return true;
 }
 
@@ -317,10 +403,17 @@ void MidiInputPort::ReceiverThreadLoop()
         return;
     }
 
-    constexpr int64_t kWaitForever = -1;
+    (void)MidiThreadTool::ApplyToCurrentThread(threadConfig_);
+    if (threadConfig_.lockMemory) {
+        (void)ringBuffer_->LockMemory();
+    }
+
+    // -1 unless the service coalesces wakes, then it only wakes us past a threshold and we poll within its budget
+    const int64_t parkTimeoutNs = ringBuffer_->GetParkTimeoutNs();
+    ringBuffer_->SetWaitStrategy(threadConfig_.waitStrategy);
 
     while (running_.load()) {
-        (void)FutexTool::FutexWait(futexPtr, kWaitForever, [this]() { return ShouldWakeForReadOrExit(); });
+        (void)ringBuffer_->WaitFor(parkTimeoutNs, [this]() { return ShouldWakeForReadOrExit(); });
 
         if (!running_.load()) {
             break;
@@ -350,29 +443,43 @@ void MidiInputPort::DrainRingAndDispatch()
         return;
     }
 
-    std::vector<MidiEvent> midiEvents;
-    std::vector<std::vector<uint32_t>> payloadBuffers;
-
-    ringBuffer_->DrainToBatch(midiEvents, payloadBuffers, 0);
-
-    if (midiEvents.empty()) {
+    MidiStatusCode status = ringBuffer_->PeekBatch(callbackEvents_, 0);
+    if (status != MidiStatusCode::OK) {
         return;
     }
 
-    std::vector<OH_MIDIEvent> callbackEvents;
-    callbackEvents.reserve(midiEvents.size());
+    MIDI_DEBUG_LOG("[client] receive midi events from server");
+    MIDI_DEBUG_LOG("%{public}s", DumpMidiEvents(callbackEvents_).c_str());
+    const int64_t now = ClockTime::GetCurNano();
+    for (const auto &event : callbackEvents_) {
+        if (event.timestamp != 0 && now >= static_cast<int64_t>(event.timestamp)) {
+            dispatchDelayHistogram_.Record(static_cast<uint64_t>(now) - event.timestamp);
+        }
+    }
+    // an overflow marker splits the batch: events before the gap, the overflow notice, events after it
+    size_t begin = 0;
+    for (size_t i = 0; i < callbackEvents_.size(); ++i) {
+        if (!MidiSharedRing::IsOverflowMarker(callbackEvents_[i].data, callbackEvents_[i].length)) {
+            continue;
+        }
+        DispatchRange(begin, i);
+        begin = i + 1;
+        const uint32_t lostEvents = callbackEvents_[i].data[1];
+        MIDI_WARNING_LOG("port[%{public}u] lost %{public}u input events", portIndex_, lostEvents);
+        if (overflowCallback_ != nullptr) {
+            overflowCallback_(overflowUserData_, deviceId_, portIndex_, lostEvents);
+        }
+    }
+    DispatchRange(begin, callbackEvents_.size());
+    // events point into the ring, release them only after the callback returns
+    ringBuffer_->CommitBatch();
+}
 
-    for (const auto &event : midiEvents) {
-        OH_MIDIEvent callbackEvent{};
-        callbackEvent.timestamp = event.timestamp;
-        callbackEvent.length = event.length;
-        callbackEvent.data = event.data;
-        callbackEvents.push_back(callbackEvent);
+void MidiInputPort::DispatchRange(size_t begin, size_t end)
+{
+    if (begin < end && (protocol_ == MIDI_PROTOCOL_1_0 || protocol_ == MIDI_PROTOCOL_2_0)) {
+        callback_(userData_, callbackEvents_.data() + begin, end - begin);
     }
-    MIDI_DEBUG_LOG("[client] receive midi events from server");
-    MIDI_DEBUG_LOG("%{public}s", DumpMidiEvents(midiEvents).c_str());
-    CHECK_AND_RETURN(protocol_ == MIDI_PROTOCOL_1_0 || protocol_ == MIDI_PROTOCOL_2_0);
-    callback_(userData_, callbackEvents.data(), callbackEvents.size());
 }
 
 MidiInputPort::~MidiInputPort()
@@ -390,7 +497,7 @@ MidiOutputPort::MidiOutputPort(OH_MIDIProtocol protocol) : protocol_(protocol)
     MIDI_INFO_LOG("OutputPort created");
 }
 
-int32_t MidiOutputPort::Send(OH_MIDIEvent *events, uint32_t eventCount, uint32_t *eventsWritten)
+int32_t MidiOutputPort::CheckSendArgs(OH_MIDIEvent *events, uint32_t eventCount, uint32_t *eventsWritten) const
 {
     CHECK_AND_RETURN_RET_LOG(events && eventsWritten, MIDI_STATUS_GENERIC_INVALID_ARGUMENT,
         "parameter is nullptr");
@@ -398,7 +505,11 @@ int32_t MidiOutputPort::Send(OH_MIDIEvent *events, uint32_t eventCount, uint32_t
         "parameter is invalid");
     CHECK_AND_RETURN_RET_LOG(protocol_ == MIDI_PROTOCOL_1_0 || protocol_ == MIDI_PROTOCOL_2_0,
         MIDI_STATUS_GENERIC_INVALID_ARGUMENT, "protocol is invalid");
+    return MIDI_STATUS_OK;
+}
 
+std::vector<MidiEventInner> &MidiOutputPort::ToInnerEvents(OH_MIDIEvent *events, uint32_t eventCount) const
+{
     thread_local std::vector<MidiEventInner> innerEvents;
     innerEvents.clear();
     innerEvents.resize(eventCount);
@@ -408,10 +519,161 @@ int32_t MidiOutputPort::Send(OH_MIDIEvent *events, uint32_t eventCount, uint32_t
     }
     MIDI_DEBUG_LOG("[client] send midi events");
     MIDI_DEBUG_LOG("%{public}s", DumpMidiEvents(innerEvents).c_str());
+    return innerEvents;
+}
+
+void MidiOutputPort::SetLanes(std::vector<std::shared_ptr<MidiSharedRing>> rings)
+{
+    laneCount_ = rings.size();
+    lanes_ = laneCount_ == 0 ? nullptr : std::make_unique<Lane[]>(laneCount_);
+    for (size_t i = 0; i < laneCount_; ++i) {
+        lanes_[i].ring = std::move(rings[i]);
+    }
+}
+
+MidiSharedRing *MidiOutputPort::LaneOfThisThread()
+{
+    if (laneCount_ == 0) {
+        return nullptr;
+    }
+    const std::thread::id self = std::this_thread::get_id();
+    for (size_t i = 0; i < laneCount_; ++i) {
+        if (lanes_[i].owner.load(std::memory_order_relaxed) == self) {
+            return lanes_[i].ring.get();
+        }
+    }
+    // first send from this thread, a lane once bound stays with its thread until the port is closed
+    for (size_t i = 0; i < laneCount_; ++i) {
+        std::thread::id unbound;
+        if (lanes_[i].owner.compare_exchange_strong(unbound, self, std::memory_order_relaxed)) {
+            return lanes_[i].ring.get();
+        }
+    }
+    return nullptr;
+}
+
+int32_t MidiOutputPort::Send(OH_MIDIEvent *events, uint32_t eventCount, uint32_t *eventsWritten)
+{
+    int32_t check = CheckSendArgs(events, eventCount, eventsWritten);
+    CHECK_AND_RETURN_RET(check == MIDI_STATUS_OK, check);
+    MidiSharedRing *lane = LaneOfThisThread();
+    if (lane != nullptr) {
+        // only this thread writes the lane, no lock needed
+        std::vector<MidiEventInner> &innerEvents = ToInnerEvents(events, eventCount);
+        return GetStatusCode(lane->TryWriteEvents(innerEvents.data(), eventCount, eventsWritten));
+    }
+    std::unique_lock<std::mutex> lock(sendMutex_, std::defer_lock);
+    if (ringBuffer_->GetFormat() != MidiRingFormat::MULTI_PRODUCER && !lock.try_lock()) {
+        if (blockingSenders_.load(std::memory_order_acquire) != 0) {
+            // a blocking sender owns the ring and may be waiting for space
+            *eventsWritten = 0;
+            return MIDI_STATUS_WOULD_BLOCK;
+        }
+        // another non-blocking Send, it holds the lock for one ring write only
+        lock.lock();
+    }
+
+    std::vector<MidiEventInner> &innerEvents = ToInnerEvents(events, eventCount);
     auto ret = ringBuffer_->TryWriteEvents(innerEvents.data(), eventCount, eventsWritten);
     return GetStatusCode(ret);
 }
 
+int32_t MidiOutputPort::SendBlocking(OH_MIDIEvent *events, uint32_t eventCount, uint32_t *eventsWritten,
+    int64_t timeoutInNs)
+{
+    int32_t check = CheckSendArgs(events, eventCount, eventsWritten);
+    CHECK_AND_RETURN_RET(check == MIDI_STATUS_OK, check);
+    CHECK_AND_RETURN_RET_LOG(!closed_.load(), MIDI_STATUS_INVALID_PORT, "port is closed");
+    MidiSharedRing *ring = LaneOfThisThread();
+    std::unique_lock<std::mutex> lock(sendMutex_, std::defer_lock);
+    std::optional<BlockingSendScope> blocking;
+    if (ring == nullptr) {
+        ring = ringBuffer_.get();
+        blocking.emplace(blockingSenders_);
+        lock.lock();
+    }
+
+    std::vector<MidiEventInner> &innerEvents = ToInnerEvents(events, eventCount);
+    auto ret = ring->WriteEventsBlocking(innerEvents.data(), eventCount, eventsWritten, timeoutInNs);
+    CHECK_AND_RETURN_RET_LOG(ret == MidiStatusCode::OK || !closed_.load(), MIDI_STATUS_INVALID_PORT,
+        "port closed while sending");
+    return GetStatusCode(ret);
+}
+
+int32_t MidiOutputPort::SendSysEx(const uint8_t *data, uint32_t byteSize)
+{
+    CHECK_AND_RETURN_RET_LOG(data != nullptr && byteSize >= SYSEX_MIN_BYTES, MIDI_STATUS_GENERIC_INVALID_ARGUMENT,
+        "parameter is invalid");
+    CHECK_AND_RETURN_RET_LOG(data[0] == SYSEX_START && data[byteSize - 1] == SYSEX_END,
+        MIDI_STATUS_GENERIC_INVALID_ARGUMENT, "not a complete sysex message");
+    CHECK_AND_RETURN_RET_LOG(!closed_.load(), MIDI_STATUS_INVALID_PORT, "port is closed");
+    BlockingSendScope blocking(blockingSenders_);
+    std::lock_guard<std::mutex> lock(sendMutex_);
+
+    sysExWords_.resize(SYSEX_BATCH_PACKETS * UmpPacket::MAX_WORD_COUNT);
+    sysExEvents_.clear();
+    sysExEvents_.reserve(SYSEX_BATCH_PACKETS);
+    int32_t ret = MIDI_STATUS_OK;
+    auto onPacket = [this, &ret](const UmpPacket &packet) {
+        if (sysExEvents_.size() == SYSEX_BATCH_PACKETS) {
+            ret = FlushSysExBatch();
+        }
+        CHECK_AND_RETURN(ret == MIDI_STATUS_OK);
+        uint32_t *words = sysExWords_.data() + sysExEvents_.size() * UmpPacket::MAX_WORD_COUNT;
+        for (uint8_t i = 0; i < packet.WordCount(); ++i) {
+            words[i] = packet.Word(i);
+        }
+        // timestamp 0: play immediately, in ring order
+        sysExEvents_.push_back(MidiEventInner{0, packet.WordCount(), words});
+    };
+
+    UmpProcessor processor;
+    for (uint32_t offset = 0; offset < byteSize && ret == MIDI_STATUS_OK; offset += SYSEX_CHUNK_BYTES) {
+        const size_t chunk = std::min<size_t>(SYSEX_CHUNK_BYTES, byteSize - offset);
+        processor.ProcessBytes(data + offset, chunk, onPacket);
+    }
+    if (ret == MIDI_STATUS_OK && !sysExEvents_.empty()) {
+        ret = FlushSysExBatch();
+    }
+    CHECK_AND_RETURN_RET_LOG(ret == MIDI_STATUS_OK, ret, "send sysex failed: %{public}d", ret);
+    return MIDI_STATUS_OK;
+}
+
+int32_t MidiOutputPort::FlushSysExBatch()
+{
+    uint32_t written = 0;
+    auto ret = ringBuffer_->WriteEventsBlocking(sysExEvents_.data(), sysExEvents_.size(), &written,
+        SYSEX_STALL_TIMEOUT_NS);
+    sysExEvents_.clear();
+    CHECK_AND_RETURN_RET_LOG(ret == MidiStatusCode::OK || !closed_.load(), MIDI_STATUS_INVALID_PORT,
+        "port closed while sending sysex");
+    return GetStatusCode(ret);
+}
+
+int32_t MidiOutputPort::Flush()
+{
+    CHECK_AND_RETURN_RET_LOG(!closed_.load(), MIDI_STATUS_INVALID_PORT, "port is closed");
+    CHECK_AND_RETURN_RET_LOG(ringBuffer_ != nullptr, MIDI_STATUS_UNKNOWN_ERROR, "ringBuffer_ is nullptr");
+    std::lock_guard<std::mutex> lock(flushMutex_);
+    // the service drops the ring backlog and this client's scheduled events on its next wakeup
+    ringBuffer_->RequestFlush();
+    for (size_t i = 0; i < laneCount_; ++i) {
+        lanes_[i].ring->RequestFlush();
+    }
+    return MIDI_STATUS_OK;
+}
+
+void MidiOutputPort::Close()
+{
+    closed_.store(true);
+    if (ringBuffer_) {
+        ringBuffer_->NotifyProducer(IS_PRE_EXIT);
+    }
+    for (size_t i = 0; i < laneCount_; ++i) {
+        lanes_[i].ring->NotifyProducer(IS_PRE_EXIT);
+    }
+}
+
 std::shared_ptr<MidiSharedRing> &MidiOutputPort::GetRingBuffer()
 {
     return ringBuffer_;
@@ -422,7 +684,8 @@ MidiOutputPort::~MidiOutputPort()
     MIDI_INFO_LOG("OutputPort destroy");
 }
 
-MidiClientPrivate::MidiClientPrivate() : ipc_(std::make_shared<MidiServiceClient>())
+MidiClientPrivate::MidiClientPrivate()
+    : ipc_(std::make_shared<MidiServiceClient>()), receiverSettings_(std::make_shared<MidiReceiverThreadSettings>())
 {
     MIDI_INFO_LOG("MidiClientPrivate created");
 }
@@ -435,6 +698,8 @@ MidiClientPrivate::~MidiClientPrivate()
 OH_MIDIStatusCode MidiClientPrivate::Init(OH_MIDICallbacks callbacks, void *userData)
 {
     CHECK_AND_RETURN_RET_LOG(ipc_ != nullptr, MIDI_STATUS_UNKNOWN_ERROR, "ipc_ is nullptr");
+    receiverSettings_->onInputOverflow = callbacks.onInputOverflow;
+    receiverSettings_->userData = userData;
     callback_ = sptr<MidiClientCallback>::MakeSptr(callbacks,
         userData,
         [this](OH_MIDIDeviceChangeAction change, OH_MIDIDeviceInformation info) { this->DeviceChange(change, info); });
@@ -494,7 +759,7 @@ OH_MIDIStatusCode MidiClientPrivate::OpenDevice(int64_t deviceId, MidiDevice **m
     CHECK_AND_RETURN_RET_LOG(ipc_ != nullptr, MIDI_STATUS_UNKNOWN_ERROR, "ipc_ is nullptr");
     auto ret = ipc_->OpenDevice(deviceId);
     CHECK_AND_RETURN_RET(ret == MIDI_STATUS_OK, ret);
-    auto newDevice = new MidiDevicePrivate(ipc_, deviceId);
+    auto newDevice = new MidiDevicePrivate(ipc_, deviceId, receiverSettings_);
     *midiDevice = newDevice;
     MIDI_INFO_LOG("Device opened: %{public}" PRId64, deviceId);
     return MIDI_STATUS_OK;
@@ -503,7 +768,8 @@ OH_MIDIStatusCode MidiClientPrivate::OpenDevice(int64_t deviceId, MidiDevice **m
 OH_MIDIStatusCode MidiClientPrivate::OpenBleDevice(std::string address, OH_MIDIOnDeviceOpened callback, void *userData)
 {
     CHECK_AND_RETURN_RET_LOG(ipc_ != nullptr, MIDI_STATUS_UNKNOWN_ERROR, "ipc_ is nullptr");
-    auto deivceOpenCallback = sptr<MidiClientDeviceOpenCallback>::MakeSptr(ipc_, callback, userData);
+    auto deivceOpenCallback = sptr<MidiClientDeviceOpenCallback>::MakeSptr(ipc_, callback, userData,
+        receiverSettings_);
     auto ret = ipc_->OpenBleDevice(address, deivceOpenCallback);
     return ret;
 }
@@ -539,6 +805,24 @@ OH_MIDIStatusCode MidiClientPrivate::DestroyMidiClient()
     return ipc_->DestroyMidiClient();
 }
 
+OH_MIDIStatusCode MidiClientPrivate::SetReceiverThreadConfig(const OH_MIDIThreadConfig &config)
+{
+    CHECK_AND_RETURN_RET_LOG(config.policy >= MIDI_THREAD_POLICY_DEFAULT && config.policy <= MIDI_THREAD_POLICY_RR,
+        MIDI_STATUS_GENERIC_INVALID_ARGUMENT, "invalid policy %{public}d", static_cast<int32_t>(config.policy));
+    CHECK_AND_RETURN_RET_LOG(config.waitStrategy == MIDI_WAIT_STRATEGY_PARK ||
+        config.waitStrategy == MIDI_WAIT_STRATEGY_ADAPTIVE, MIDI_STATUS_GENERIC_INVALID_ARGUMENT,
+        "invalid wait strategy %{public}d", static_cast<int32_t>(config.waitStrategy));
+    std::lock_guard<std::mutex> lock(receiverSettings_->mutex);
+    // OH_MIDIThreadPolicy mirrors MidiSchedPolicy
+    receiverSettings_->config.policy = static_cast<MidiSchedPolicy>(config.policy);
+    receiverSettings_->config.priority = config.priority;
+    receiverSettings_->config.cpuMask = config.cpuMask;
+    receiverSettings_->config.lockMemory = config.lockMemory;
+    // OH_MIDIWaitStrategy mirrors MidiWaitStrategy
+    receiverSettings_->config.waitStrategy = static_cast<MidiWaitStrategy>(config.waitStrategy);
+    return MIDI_STATUS_OK;
+}
+
 OH_MIDIStatusCode MidiClient::CreateMidiClient(MidiClient **client, OH_MIDICallbacks callbacks, void *userData)
 {
     CHECK_AND_RETURN_RET_LOG(client != nullptr, MIDI_STATUS_UNKNOWN_ERROR, "client is nullptr");
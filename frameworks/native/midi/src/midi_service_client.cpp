@@ -110,20 +110,20 @@ OH_MIDIStatusCode MidiServiceClient::GetDevicePorts(int64_t deviceId,
 }
 
 OH_MIDIStatusCode MidiServiceClient::OpenInputPort(std::shared_ptr<MidiSharedRing> &buffer, int64_t deviceId,
-                                                   uint32_t portIndex)
+                                                   uint32_t portIndex, uint32_t bufferSize)
 {
     std::lock_guard lock(lock_);
     CHECK_AND_RETURN_RET_LOG(ipc_ != nullptr, MIDI_STATUS_GENERIC_IPC_FAILURE, "ipc_ is NULL.");
-    auto ret = ipc_->OpenInputPort(buffer, deviceId, portIndex);
+    auto ret = ipc_->OpenInputPort(buffer, deviceId, portIndex, bufferSize);
     return GetMidiStatusCode(ret);
 }
 
 OH_MIDIStatusCode MidiServiceClient::OpenOutputPort(std::shared_ptr<MidiSharedRing> &buffer, int64_t deviceId,
-                                                    uint32_t portIndex)
+                                                    uint32_t portIndex, uint32_t bufferSize, bool multiProducer)
 {
     std::lock_guard lock(lock_);
     CHECK_AND_RETURN_RET_LOG(ipc_ != nullptr, MIDI_STATUS_GENERIC_IPC_FAILURE, "ipc_ is NULL.");
-    auto ret = ipc_->OpenOutputPort(buffer, deviceId, portIndex);
+    auto ret = ipc_->OpenOutputPort(buffer, deviceId, portIndex, bufferSize, multiProducer);
     return GetMidiStatusCode(ret);
 }
 
@@ -162,5 +162,22 @@ OH_MIDIStatusCode MidiServiceClient::DestroyMidiClient()
         "DestroyMidiClient failed");
     return MIDI_STATUS_OK;
 }
+
+OH_MIDIStatusCode MidiServiceClient::GetStatistics(std::string &statistics)
+{
+    std::lock_guard lock(lock_);
+    CHECK_AND_RETURN_RET_LOG(ipc_ != nullptr, MIDI_STATUS_GENERIC_IPC_FAILURE, "ipc_ is NULL.");
+    auto ret = ipc_->GetStatistics(statistics);
+    return GetMidiStatusCode(ret);
+}
+
+OH_MIDIStatusCode MidiServiceClient::OpenOutputLane(std::shared_ptr<MidiSharedRing> &buffer, int64_t deviceId,
+                                                    uint32_t portIndex, uint32_t bufferSize)
+{
+    std::lock_guard lock(lock_);
+    CHECK_AND_RETURN_RET_LOG(ipc_ != nullptr, MIDI_STATUS_GENERIC_IPC_FAILURE, "ipc_ is NULL.");
+    auto ret = ipc_->OpenOutputLane(buffer, deviceId, portIndex, bufferSize);
+    return GetMidiStatusCode(ret);
+}
 } // namespace MIDI
 } // namespace OHOS
\ No newline at end of file
@@ -22,6 +22,7 @@ namespace OHOS {
 namespace MIDI {
 
 const uint64_t MIDI_NS_PER_SECOND = 1000000000;
+const uint64_t MIDI_NS_PER_US = 1000;
 
 void CloseFd(int fd);
 std::string GetEncryptStr(const std::string &str);
@@ -29,6 +30,7 @@ std::string BytesToString(uint32_t value);
 std::string DumpOneEvent(uint64_t ts, size_t len, const uint32_t *data);
 std::string DumpMidiEvents(const std::vector<MidiEvent>& events);
 std::string DumpMidiEvents(const std::vector<MidiEventInner>& events);
+std::string DumpMidiEvents(const std::vector<OH_MIDIEvent>& events);
 
 class ClockTime {
 public:
@@ -143,6 +143,16 @@ std::string DumpMidiEvents(const std::vector<MidiEventInner>& events)
     return out.str();
 }
 
+std::string DumpMidiEvents(const std::vector<OH_MIDIEvent>& events)
+{
+    std::ostringstream out;
+    out << "MidiEvents count=" << events.size() << ":";
+    for (size_t i = 0; i < events.size(); ++i) {
+        out << "\n  [" << i << "] " << DumpOneEvent(events[i].timestamp, events[i].length, events[i].data);
+    }
+    return out.str();
+}
+
 // ====== UniqueFd ======
 UniqueFd::~UniqueFd()
 {
@@ -41,6 +41,14 @@ OH_MIDIStatusCode OH_MIDIClientDestroy(OH_MIDIClient *client)
     return MIDI_STATUS_OK;
 }
 
+OH_MIDIStatusCode OH_MIDISetReceiverThreadConfig(OH_MIDIClient *client, const OH_MIDIThreadConfig *config)
+{
+    OHOS::MIDI::MidiClient *midiclient = (OHOS::MIDI::MidiClient *)client;
+    CHECK_AND_RETURN_RET_LOG(midiclient != nullptr, MIDI_STATUS_INVALID_CLIENT, "Invalid client");
+    CHECK_AND_RETURN_RET_LOG(config != nullptr, MIDI_STATUS_GENERIC_INVALID_ARGUMENT, "config is nullptr");
+    return midiclient->SetReceiverThreadConfig(*config);
+}
+
 OH_MIDIStatusCode OH_MIDIGetDeviceCount(OH_MIDIClient *client, size_t *count)
 {
     OHOS::MIDI::MidiClient *midiclient = (OHOS::MIDI::MidiClient *)client;
@@ -176,16 +184,30 @@ OH_MIDIStatusCode OH_MIDISend(
     return MIDI_STATUS_OK;
 }
 
+OH_MIDIStatusCode OH_MIDISendBlocking(OH_MIDIDevice *device, uint32_t portIndex, OH_MIDIEvent *events,
+    uint32_t eventCount, uint32_t *eventsWritten, int64_t timeoutNs)
+{
+    OHOS::MIDI::MidiDevice *midiDevice = (OHOS::MIDI::MidiDevice *)device;
+    CHECK_AND_RETURN_RET_LOG(midiDevice != nullptr, MIDI_STATUS_INVALID_DEVICE_HANDLE, "Invalid device");
+    OH_MIDIStatusCode ret = midiDevice->SendBlocking(portIndex, events, eventCount, eventsWritten, timeoutNs);
+    CHECK_AND_RETURN_RET_LOG(ret == MIDI_STATUS_OK, ret, "blocking send failed");
+    return MIDI_STATUS_OK;
+}
+
 OH_MIDIStatusCode OH_MIDISendSysEx(OH_MIDIDevice *device, uint32_t portIndex, uint8_t *data, uint32_t byteSize)
 {
-    (void)portIndex;
-    (void)data;
-    (void)byteSize;
+    OHOS::MIDI::MidiDevice *midiDevice = (OHOS::MIDI::MidiDevice *)device;
+    CHECK_AND_RETURN_RET_LOG(midiDevice != nullptr, MIDI_STATUS_INVALID_DEVICE_HANDLE, "Invalid device");
+    OH_MIDIStatusCode ret = midiDevice->SendSysEx(portIndex, data, byteSize);
+    CHECK_AND_RETURN_RET_LOG(ret == MIDI_STATUS_OK, ret, "send sysex failed");
     return MIDI_STATUS_OK;
 }
 
 OH_MIDIStatusCode OH_MIDIFlushOutputPort(OH_MIDIDevice *device, uint32_t portIndex)
 {
-    (void)portIndex;
+    OHOS::MIDI::MidiDevice *midiDevice = (OHOS::MIDI::MidiDevice *)device;
+    CHECK_AND_RETURN_RET_LOG(midiDevice != nullptr, MIDI_STATUS_INVALID_DEVICE_HANDLE, "Invalid device");
+    OH_MIDIStatusCode ret = midiDevice->FlushOutputPort(portIndex);
+    CHECK_AND_RETURN_RET_LOG(ret == MIDI_STATUS_OK, ret, "flush output port failed");
     return MIDI_STATUS_OK;
 }
@@ -29,6 +29,9 @@ public:
     virtual OH_MIDIStatusCode ClosePort(uint32_t portIndex);
     virtual OH_MIDIStatusCode Send(uint32_t portIndex, OH_MIDIEvent *events,
                                     uint32_t eventCount, uint32_t *eventsWritten);
+    virtual OH_MIDIStatusCode SendBlocking(uint32_t portIndex, OH_MIDIEvent *events, uint32_t eventCount,
+                                           uint32_t *eventsWritten, int64_t timeoutInNs);
+    virtual OH_MIDIStatusCode SendSysEx(uint32_t portIndex, uint8_t *data, uint32_t byteSize);
     virtual OH_MIDIStatusCode FlushOutputPort(uint32_t portIndex);
 };
 
@@ -42,6 +45,7 @@ public:
     virtual OH_MIDIStatusCode OpenBleDevice(std::string address, OH_MIDIOnDeviceOpened callback, void *userData);
     virtual OH_MIDIStatusCode GetDevicePorts(int64_t deviceId, OH_MIDIPortInformation *infos, size_t *numPorts);
     virtual OH_MIDIStatusCode DestroyMidiClient();
+    virtual OH_MIDIStatusCode SetReceiverThreadConfig(const OH_MIDIThreadConfig &config);
 };
 } // namespace MIDI
 } // namespace OHOS
@@ -68,6 +68,21 @@ OH_MIDIStatusCode OH_MIDIClientCreate(OH_MIDIClient **client, OH_MIDICallbacks c
  */
 OH_MIDIStatusCode OH_MIDIClientDestroy(OH_MIDIClient *client);
 
+/**
+ * @brief Set scheduling, affinity and memory locking of input port receiver threads
+ *
+ * Applies to input ports opened afterwards on devices of this client. Ports that are already open keep
+ * their settings.
+ *
+ * @param client Target client handle.
+ * @param config Thread settings.
+ * @return {@link #MIDI_STATUS_OK} if execution succeeds.
+ * or {@link #MIDI_STATUS_INVALID_CLIENT} if client is NULL or invalid.
+ * or {@link #MIDI_STATUS_GENERIC_INVALID_ARGUMENT} if config is NULL or its policy is unknown.
+ * @since 24
+ */
+OH_MIDIStatusCode OH_MIDISetReceiverThreadConfig(OH_MIDIClient *client, const OH_MIDIThreadConfig *config);
+
 /**
  * @brief Get the number of connected MIDI devices.
  *
@@ -234,6 +249,7 @@ OH_MIDIStatusCode OH_MIDIOpenInputPort(
  * or {@link #MIDI_STATUS_PORT_ALREADY_OPEN} if port is opened by this client.
  * or {@link #MIDI_STATUS_INVALID_PORT} if portindex is invalid or not a output port.
  * or {@link #MIDI_STATUS_PORT_ALREADY_OPEN} if port is already opened.
+ * or {@link #MIDI_STATUS_GENERIC_INVALID_ARGUMENT} if laneCount is greater than 8.
  * or {@link #MIDI_STATUS_GENERIC_IPC_FAILURE} if connection to system service fails.
  * @since 24
  */
@@ -262,6 +278,13 @@ OH_MIDIStatusCode OH_MIDIClosePort(OH_MIDIDevice *device, uint32_t portIndex);
  * - Partial Success: If the buffer becomes full midway, the function returns
  * {@link #MIDI_STATUS_WOULD_BLOCK} and sets eventsWritten to the number of events
  * successfully enqueued.
+ * - Concurrency: On a port opened with {@link OH_MIDIPortDescriptor#multiProducer} set,
+ * calls from different threads proceed in parallel without waiting for each other.
+ * The same holds for threads bound to their own lane of a port opened with
+ * {@link OH_MIDIPortDescriptor#laneCount} greater than 1.
+ * Otherwise concurrent calls take turns on the port, each waiting only for the write of the call ahead of it.
+ * While an {@link #OH_MIDISendBlocking} or {@link #OH_MIDISendSysEx} call is writing to the port,
+ * they return {@link #MIDI_STATUS_WOULD_BLOCK} with eventsWritten set to 0 instead of waiting.
  *
  * @param device Target device handle.
  * @param portIndex Target portIndex.
@@ -279,6 +302,29 @@ OH_MIDIStatusCode OH_MIDIClosePort(OH_MIDIDevice *device, uint32_t portIndex);
 OH_MIDIStatusCode OH_MIDISend(
     OH_MIDIDevice *device, uint32_t portIndex, OH_MIDIEvent *events, uint32_t eventCount, uint32_t *eventsWritten);
 
+/**
+ * @brief Send MIDI messages (Batch, Blocking with timeout)
+ *
+ * Same as {@link #OH_MIDISend}, but when the buffer is full the caller sleeps until
+ * the service has consumed events and freed space, instead of returning
+ * {@link #MIDI_STATUS_WOULD_BLOCK}. No CPU is spent while waiting.
+ *
+ * @param device Target device handle.
+ * @param portIndex Target portIndex.
+ * @param events Pointer to the array of events to send.
+ * @param eventCount Number of events in the array.
+ * @param eventsWritten Returns the number of events successfully consumed.
+ * @param timeoutNs Maximum time to wait in nanoseconds, 0 or negative waits until all events are written.
+ * @return {@link #MIDI_STATUS_OK} if all events were written.
+ * or {@link #MIDI_STATUS_INVALID_DEVICE_HANDLE} if device is invalid.
+ * or {@link #MIDI_STATUS_INVALID_PORT} if portindex is invalid, not open, or closed while waiting.
+ * or {@link #MIDI_STATUS_TIMEOUT} if the timeout elapsed first (check eventsWritten).
+ * or {@link #MIDI_STATUS_GENERIC_INVALID_ARGUMENT} if arguments are invalid.
+ * @since 24
+ */
+OH_MIDIStatusCode OH_MIDISendBlocking(OH_MIDIDevice *device, uint32_t portIndex, OH_MIDIEvent *events,
+    uint32_t eventCount, uint32_t *eventsWritten, int64_t timeoutNs);
+
 /**
  * @brief Send a large SysEx message (Byte-Stream to UMP Helper)
  *
@@ -288,19 +334,24 @@ OH_MIDIStatusCode OH_MIDISend(
  *
  * How it works:
  * 1. It automatically fragments the raw bytes into a sequence of UMP Type 3(64-bit Data Message) packets.
- * 2. It sends these packets sequentially using OH_MIDISend.
+ * 2. It writes these packets to the output buffer in large batches, sent immediately (timestamp 0).
+ *    When the buffer is full it sleeps until the service frees space, like {@link #OH_MIDISendBlocking}.
  *
  * @warning **BLOCKING CALL**: This function executes a loop and may block if the buffer fills up.
+ * Until it returns, {@link #OH_MIDISend} on the same port gets {@link #MIDI_STATUS_WOULD_BLOCK} and
+ * {@link #OH_MIDISendBlocking} waits. This does not apply to a port opened with
+ * {@link OH_MIDIPortDescriptor#multiProducer} set, where {@link #OH_MIDISend} keeps writing and its events may
+ * land between the SysEx packets, nor to threads sending on their own lane.
  *
  * @param device Target device handle.
  * @param portIndex Target port index.
- * @param data Pointer to the array of events to send.
- * @param byteSize Number of events in the array.
+ * @param data Pointer to the complete SysEx message, starting with 0xF0 and ending with 0xF7.
+ * @param byteSize Number of bytes in data, including 0xF0 and 0xF7.
  * @return {@link #MIDI_STATUS_OK} if all events were written.
  * or {@link #MIDI_STATUS_INVALID_DEVICE_HANDLE} if device is invalid.
  * or {@link #MIDI_STATUS_INVALID_PORT} if portindex is invalid, or not open.
- * or {@link #MIDI_STATUS_TIMEOUT} could not be completed within a reasonable time,
- *                                 may use OH_MIDIFlushOutputPort to reset.
+ * or {@link #MIDI_STATUS_TIMEOUT} could not be completed within a reasonable time (the service freed no space
+ *                                 for 2 seconds), may use OH_MIDIFlushOutputPort to reset.
  * or {@link #MIDI_STATUS_GENERIC_INVALID_ARGUMENT} if arguments are invalid.
  * @since 24
  */
@@ -314,13 +365,14 @@ OH_MIDIStatusCode OH_MIDISendSysEx(OH_MIDIDevice *device, uint32_t portIndex, ui
  * that haven't been processed by the service yet.
  *
  * @note This does NOT send "All Notes Off" messages. It simply clears the queue.
+ * @note The request is passed to the service through shared memory and this call does not wait for it.
+ *       Events sent after this function returns are kept.
  *
  * @param device Target device handle.
  * @param portIndex Target port index.
  * @return {@link #MIDI_STATUS_OK} if execution succeeds,
  * or {@link #MIDI_STATUS_INVALID_DEVICE_HANDLE} if device is invalid.
  * or {@link #MIDI_STATUS_INVALID_PORT} if portIndex invalid or not a output port.
- * or {@link #MIDI_STATUS_GENERIC_IPC_FAILURE} if connection to system service fails.
  * @since 24
  */
 OH_MIDIStatusCode OH_MIDIFlushOutputPort(OH_MIDIDevice *device, uint32_t portIndex);
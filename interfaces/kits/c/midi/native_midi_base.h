@@ -192,6 +192,72 @@ typedef enum {
     MIDI_PROTOCOL_2_0 = 2
 } OH_MIDIProtocol;
 
+/**
+ * @brief Scheduling policy of a MIDI receiver thread
+ * @since 24
+ */
+typedef enum {
+    /**
+     * @brief Keep the scheduling the thread inherits from the process.
+     */
+    MIDI_THREAD_POLICY_DEFAULT = 0,
+    /**
+     * @brief SCHED_FIFO. Needs CAP_SYS_NICE or a suitable RLIMIT_RTPRIO.
+     */
+    MIDI_THREAD_POLICY_FIFO = 1,
+    /**
+     * @brief SCHED_RR. Needs CAP_SYS_NICE or a suitable RLIMIT_RTPRIO.
+     */
+    MIDI_THREAD_POLICY_RR = 2
+} OH_MIDIThreadPolicy;
+
+/**
+ * @brief How a MIDI receiver thread waits for input
+ * @since 24
+ */
+typedef enum {
+    /**
+     * @brief Sleep in the kernel until woken. Cheapest on CPU.
+     */
+    MIDI_WAIT_STRATEGY_PARK = 0,
+    /**
+     * @brief Busy-wait briefly, then yield, then sleep. The busy-wait budget follows how closely events have
+     * been arriving, up to 50 microseconds. Lower latency for dense input at the cost of some CPU time.
+     */
+    MIDI_WAIT_STRATEGY_ADAPTIVE = 1
+} OH_MIDIWaitStrategy;
+
+/**
+ * @brief Scheduling, affinity and memory settings of MIDI receiver threads
+ *
+ * A real-time policy the process is not allowed to take falls back to the default policy with a raised
+ * nice value; the port still opens.
+ *
+ * @since 24
+ */
+typedef struct {
+    /**
+     * @brief Scheduling policy.
+     */
+    OH_MIDIThreadPolicy policy;
+    /**
+     * @brief Real-time priority, clamped to the range of the policy. Ignored for MIDI_THREAD_POLICY_DEFAULT.
+     */
+    int32_t priority;
+    /**
+     * @brief Bit n allows the thread on CPU n. 0 keeps the inherited affinity.
+     */
+    uint64_t cpuMask;
+    /**
+     * @brief Lock the shared event buffer of the port in memory, so the thread never faults on it.
+     */
+    bool lockMemory;
+    /**
+     * @brief How the thread waits for input.
+     */
+    OH_MIDIWaitStrategy waitStrategy;
+} OH_MIDIThreadConfig;
+
 /**
  * @brief MIDI Device Type
  * @since 24
@@ -330,6 +396,40 @@ typedef struct {
      * - **Warning**: Data precision will be lost. Advanced messages may be dropped.
      */
     OH_MIDIProtocol protocol;
+
+    /**
+     * @brief Requested size in bytes of the shared event buffer of this port.
+     *
+     * 0 selects the service default (2048 bytes). Other values are clamped by the service to
+     * [256, 32768]. Small buffers keep latency-sensitive ports lean, large buffers let bulk
+     * senders queue more events before {@link MIDI_STATUS_WOULD_BLOCK} is returned.
+     */
+    uint32_t bufferSize;
+
+    /**
+     * @brief Lets several threads send on this output port at once.
+     *
+     * When true, {@link OH_MIDISend} callers on different threads reserve space in the shared
+     * buffer independently and never wait for each other. Events of one call stay in order,
+     * events of concurrent calls may interleave. Ignored for input ports.
+     *
+     * @since 24
+     */
+    bool multiProducer;
+
+    /**
+     * @brief Number of producer lanes of this output port.
+     *
+     * 0 and 1 open a single shared buffer. Larger values, up to 8, open laneCount buffers of
+     * bufferSize bytes each. The first one is shared as usual; the first {@link OH_MIDISend} from
+     * a thread binds it to one of the others while any is free, for as long as the port stays
+     * open, and from then on that thread sends without waiting for any other. The service merges
+     * the lanes by timestamp: events of one thread stay in order, events of different threads are
+     * ordered only by their timestamps. Ignored for input ports.
+     *
+     * @since 24
+     */
+    uint32_t laneCount;
 } OH_MIDIPortDescriptor;
 
 /**
@@ -378,6 +478,20 @@ typedef void (*OH_OnMIDIReceived)(void *userData, const OH_MIDIEvent *events, si
  */
 typedef void (*OH_OnMIDIError)(void *userData, OH_MIDIStatusCode code);
 
+/**
+ * @brief Callback for input events lost because an input port was not read fast enough
+ *
+ * @note Invoked on the receiver thread of the port, in order with the received data: events passed to
+ * {@link OH_OnMIDIReceived} before this call arrived before the gap, events passed after it arrived after it.
+ *
+ * @param userData User context provided during client creation.
+ * @param deviceId ID of the device the port belongs to.
+ * @param portIndex Index of the input port.
+ * @param lostEvents Number of events dropped at this point of the stream.
+ * @since 24
+ */
+typedef void (*OH_OnMIDIInputOverflow)(void *userData, int64_t deviceId, uint32_t portIndex, uint32_t lostEvents);
+
 /**
  * @brief Callback for asynchronous BLE device connection result.
  *
@@ -417,6 +531,11 @@ typedef struct {
      * @brief Handler for critical service errors.
      */
     OH_OnMIDIError onError;
+
+    /**
+     * @brief Handler for lost input events, may be NULL.
+     */
+    OH_OnMIDIInputOverflow onInputOverflow;
 } OH_MIDICallbacks;
 
 #ifdef __cplusplus
@@ -29,6 +29,16 @@ const uint32_t IS_READY = 0;
 const uint32_t IS_NOT_READY = 1;
 const uint32_t IS_PRE_EXIT = 2;
 }  // namespace
+// spin loop hint, lets the sibling hyperthread run and saves power while busy waiting
+inline void CpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    asm volatile("yield" ::: "memory");
+#endif
+}
+
 enum FutexCode : int32_t {
     FUTEX_SUCCESS = 0,
     FUTEX_TIMEOUT,
@@ -59,6 +69,40 @@ public:
      */
     static void SetStubFunc(const FutexSysCall &sysCall, const TimeGetter &timeCall);
 };
+
+enum class MidiWaitStrategy : uint32_t {
+    PARK = 0,      // straight to FUTEX_WAIT once the predicate fails
+    ADAPTIVE = 1,  // spin with a cpu relax, then yield, then park; the spin budget follows the observed waits
+};
+
+/**
+ * Wait state of one consumer thread. While it spins or yields the futex word stays IS_READY, so producers skip
+ * the wake syscall; only the park phase publishes IS_NOT_READY. The spin budget is twice the moving average of
+ * recent wait times, clamped to [ADAPTIVE_MIN_SPIN_NS, ADAPTIVE_MAX_SPIN_NS], and drops to the minimum while
+ * events arrive further apart than the maximum. On a single cpu it only yields before parking.
+ * Not thread safe, one waiter per waiting thread.
+ */
+class MidiAdaptiveWaiter {
+public:
+    static constexpr int64_t ADAPTIVE_MIN_SPIN_NS = 1000;
+    static constexpr int64_t ADAPTIVE_MAX_SPIN_NS = 50000;
+
+    explicit MidiAdaptiveWaiter(MidiWaitStrategy strategy = MidiWaitStrategy::PARK) : strategy_(strategy) {}
+
+    void SetStrategy(MidiWaitStrategy strategy) { strategy_ = strategy; }
+    MidiWaitStrategy GetStrategy() const { return strategy_; }
+    int64_t GetSpinBudgetNs() const { return spinBudgetNs_; }
+    // same contract as FutexTool::FutexWait
+    FutexCode Wait(std::atomic<uint32_t> *futexPtr, int64_t timeout, const std::function<bool(void)> &pred);
+
+private:
+    bool SpinThenYield(int64_t begin, int64_t timeout, const std::function<bool(void)> &pred) const;
+    void RecordWait(int64_t waitedNs);
+
+    MidiWaitStrategy strategy_;
+    int64_t spinBudgetNs_ = ADAPTIVE_MIN_SPIN_NS;
+    int64_t waitAverageNs_ = 0;
+};
 }  // namespace MIDI
 }  // namespace OHOS
 #endif  // FUTEX_TOOL_H
\ No newline at end of file
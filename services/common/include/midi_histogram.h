@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MIDI_HISTOGRAM_H
+#define MIDI_HISTOGRAM_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace OHOS {
+namespace MIDI {
+
+/**
+ * Log-linear histogram of non-negative values (HDR style): every power of two is split into 8 linear
+ * sub-buckets, so any recorded value is known within 12.5% over the full uint64 range.
+ *
+ * Single writer: Record does relaxed loads and stores only, no read-modify-write. Readers on other threads
+ * see a slightly stale but never torn view.
+ */
+class MidiHistogram {
+public:
+    static constexpr uint32_t SUB_BUCKET_BITS = 3;
+    static constexpr uint32_t SUB_BUCKETS = 1u << SUB_BUCKET_BITS;
+    static constexpr uint32_t BUCKET_COUNT = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    void Record(uint64_t value)
+    {
+        Bump(buckets_[BucketIndex(value)], 1);
+        Bump(count_, 1);
+        Bump(sum_, value);
+        if (value > max_.load(std::memory_order_relaxed)) {
+            max_.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    uint64_t Count() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t Sum() const { return sum_.load(std::memory_order_relaxed); }
+    uint64_t Max() const { return max_.load(std::memory_order_relaxed); }
+    uint64_t Mean() const;
+    // upper bound of the bucket holding the given fraction (0..1) of the samples, 0 when empty
+    uint64_t Percentile(double fraction) const;
+    // "count mean p50 p90 p99 p999 max", for logs and dumps
+    std::string Summary() const;
+    // only safe while the writer is idle
+    void Reset();
+
+    static uint32_t BucketIndex(uint64_t value)
+    {
+        if (value < SUB_BUCKETS) {
+            return static_cast<uint32_t>(value);
+        }
+        const uint32_t shift = 63u - static_cast<uint32_t>(__builtin_clzll(value)) - SUB_BUCKET_BITS;
+        return (shift + 1) * SUB_BUCKETS + static_cast<uint32_t>((value >> shift) & (SUB_BUCKETS - 1));
+    }
+    static uint64_t BucketUpperBound(uint32_t index);
+
+private:
+    static void Bump(std::atomic<uint64_t> &counter, uint64_t delta)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+};
+} // namespace MIDI
+} // namespace OHOS
+#endif
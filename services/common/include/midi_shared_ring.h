@@ -29,19 +29,92 @@
 namespace OHOS {
 namespace MIDI {
 
-enum class MidiStatusCode : int32_t { OK = 0, WOULD_BLOCK, INVALID_ARGUMENT, SHM_BROKEN, INTERNAL_ERROR };
+enum class MidiStatusCode : int32_t { OK = 0, WOULD_BLOCK, INVALID_ARGUMENT, SHM_BROKEN, INTERNAL_ERROR, TIMEOUT };
 
-struct alignas(64) ControlHeader {        // 64 bytes for cache line
-    std::atomic<uint32_t> readPosition;   // read index range: (0..capacity-1)
-    std::atomic<uint32_t> writePosition;  // write index range: (0..capacity-1)
+constexpr size_t MIDI_CACHE_LINE_SIZE = 64;
+// bump whenever the shared memory layout below changes, both peers must agree on it
+constexpr uint32_t MIDI_SHM_LAYOUT_VERSION = 7;
+
+struct alignas(MIDI_CACHE_LINE_SIZE) ControlHeader {
+    // written once by the creator, read-only afterwards
+    uint32_t layoutVersion;               // MIDI_SHM_LAYOUT_VERSION
     uint32_t capacity;                    // ring data capacity
-    std::atomic<uint32_t> futexObj;       // for futex
-    uint32_t flags;                       // for expand
+    uint32_t flags;                       // MidiRingFlags, fixed at creation
+
+    // producer owned, consumer only reads it (acquire). Multi-producer rings keep a reservation tag in the
+    // high half, see MIDI_RING_POSITION_MASK
+    alignas(MIDI_CACHE_LINE_SIZE) std::atomic<uint32_t> writePosition;  // write index range: (0..capacity-1)
+
+    // consumer owned, producer only reads it (acquire)
+    alignas(MIDI_CACHE_LINE_SIZE) std::atomic<uint32_t> readPosition;   // read index range: (0..capacity-1)
+
+    // touched by both sides on wait/wake only
+    alignas(MIDI_CACHE_LINE_SIZE) std::atomic<uint32_t> futexObj;       // for futex
+    alignas(MIDI_CACHE_LINE_SIZE) std::atomic<uint32_t> spaceFutexObj;  // consumer progress, wakes blocked producer
+
+    // flush command word: producer publishes flushPosition then bumps flushRequest (release),
+    // consumer discards everything before flushPosition and echoes the request into flushAck
+    alignas(MIDI_CACHE_LINE_SIZE) std::atomic<uint32_t> flushRequest;
+    std::atomic<uint32_t> flushPosition;
+    alignas(MIDI_CACHE_LINE_SIZE) std::atomic<uint32_t> flushAck;
+
+    // producer owned: events dropped because the ring was full, cumulative
+    alignas(MIDI_CACHE_LINE_SIZE) std::atomic<uint32_t> droppedEvents;
+
+    // consumer owned: non-zero while an eventfd consumer may sleep without looking at this ring,
+    // producers skip the eventfd write while it is clear
+    alignas(MIDI_CACHE_LINE_SIZE) std::atomic<uint32_t> consumerParked;
+    // set by the creator before data flows: a futex consumer parks at most this long, 0 parks until woken
+    std::atomic<uint32_t> wakeBudgetUs;
+};
+
+/**
+ * Written by the producer in front of the first event it manages to write after dropping some. Payload is two
+ * words: MIDI_RING_OVERFLOW_MARKER (a UMP utility message with a status the spec leaves unused) and the number
+ * of events lost since the previous marker. Readers strip it from the data they hand on.
+ */
+constexpr uint32_t MIDI_RING_OVERFLOW_MARKER = 0x00F0FF00u;
+constexpr uint32_t MIDI_RING_OVERFLOW_MARKER_WORDS = 2;
+
+enum MidiRingFlags : uint32_t {
+    RING_FLAG_NONE = 0,
+    RING_FLAG_COMPACT_RECORDS = 1u << 0,  // records use the compact header below
+    RING_FLAG_MULTI_PRODUCER = 1u << 1,   // records carry SHM_EVENT_FLAG_COMMITTED
+};
+
+// record encoding inside the ring, chosen by the creator and adopted by the peer from ControlHeader.flags
+enum class MidiRingFormat : uint32_t {
+    STANDARD = 0,    // ShmMidiEventHeader + payload
+    COMPACT,         // one header word + payload, see CompactRecordBits
+    /**
+     * STANDARD records for several concurrent producers. A producer reserves its span with a CAS on
+     * writePosition and sets SHM_EVENT_FLAG_COMMITTED once the record is complete, the consumer stops at the
+     * first record that is not committed yet and zeroes what it consumed before handing the space back.
+     * The consumer side stays single threaded.
+     */
+    MULTI_PRODUCER,
+};
+
+// index bits of writePosition, the rest is the multi-producer reservation tag (always 0 for other formats)
+constexpr uint32_t MIDI_RING_POSITION_MASK = 0xFFFFu;
+
+/**
+ * Compact record header word. Payload stays 4-byte aligned so PeekBatch can still hand out views.
+ * short form: [31]=0 [30]=0 [29..0]=timestamp delta(ns) to the previous record, length derived from UMP MT
+ * long form : [31]=0 [30]=1 [23..0]=length(words), followed by the absolute timestamp (lo word, hi word)
+ * wrap      : [31]=1, rest zero
+ */
+enum CompactRecordBits : uint32_t {
+    COMPACT_WRAP_BIT = 1u << 31,
+    COMPACT_LONG_BIT = 1u << 30,
+    COMPACT_DELTA_MASK = COMPACT_LONG_BIT - 1u,
+    COMPACT_LENGTH_MASK = 0x00FFFFFFu,
 };
 
 enum ShmEventFlags : uint32_t {
     SHM_EVENT_FLAG_NONE = 0,
-    SHM_EVENT_FLAG_WRAP = 1u << 0,  // indicate wrap, length must be 0
+    SHM_EVENT_FLAG_WRAP = 1u << 0,       // indicate wrap, length must be 0
+    SHM_EVENT_FLAG_COMMITTED = 1u << 1,  // multi-producer rings: record (or wrap marker) fully written
 };
 
 struct ShmMidiEventHeader {
@@ -53,13 +126,14 @@ struct ShmMidiEventHeader {
 class MidiSharedRing : public Parcelable {
 public:
     explicit MidiSharedRing(uint32_t ringCapacityBytes);
-    explicit MidiSharedRing(uint32_t ringCapacityBytes, std::shared_ptr<UniqueFd> fd);
+    explicit MidiSharedRing(uint32_t ringCapacityBytes, std::shared_ptr<UniqueFd> fd,
+        MidiRingFormat format = MidiRingFormat::STANDARD);
 
-    // creat MidiSharedRing locally or remotely
+    // creat MidiSharedRing locally or remotely, the remote side adopts the format stored in the header
     static std::shared_ptr<MidiSharedRing> CreateFromLocal(
-        size_t ringCapacityBytes);
+        size_t ringCapacityBytes, MidiRingFormat format = MidiRingFormat::STANDARD);
     static std::shared_ptr<MidiSharedRing> CreateFromLocal(
-        size_t ringCapacityBytes, std::shared_ptr<UniqueFd> fd);
+        size_t ringCapacityBytes, std::shared_ptr<UniqueFd> fd, MidiRingFormat format = MidiRingFormat::STANDARD);
     static std::shared_ptr<MidiSharedRing> CreateFromRemote(size_t ringCapacityBytes, int dataFd);
 
     // idl
@@ -72,22 +146,65 @@ public:
     ~MidiSharedRing() = default;
 
     uint32_t GetCapacity() const;
+    MidiRingFormat GetFormat() const;
     uint32_t GetReadPosition() const;
     uint32_t GetWritePosition() const;
     uint8_t *GetDataBase() const;
     std::atomic<uint32_t> *GetFutex() const;
+    std::atomic<uint32_t> *GetSpaceFutex() const;
     int GetEventFd() const;
 
+    // consumer side, waits on the data futex with the strategy chosen by SetWaitStrategy
     FutexCode WaitFor(int64_t timeoutInNs, const std::function<bool(void)> &pred);
+    void SetWaitStrategy(MidiWaitStrategy strategy) { waiter_.SetStrategy(strategy); }
+    const MidiAdaptiveWaiter &GetWaiter() const { return waiter_; }
     void NotifyConsumer(uint32_t wakeVal = IS_READY);
+    // consumer side: wake a producer parked in WriteEventsBlocking, cheap when nobody waits
+    void NotifyProducer(uint32_t wakeVal = IS_READY);
     bool IsEmpty() const;
+    /**
+     * Producer side wake coalescing: a futex consumer is only woken once eventThreshold events went unannounced,
+     * and in exchange never parks longer than budgetUs, so an event waits at most that long. eventThreshold <= 1
+     * or budgetUs == 0 wakes on every write. Only for rings whose consumer parks on the futex.
+     */
+    void SetWakeCoalescing(uint32_t eventThreshold, uint32_t budgetUs);
+    // consumer side: timeout for a futex park, -1 when the producer does not coalesce
+    int64_t GetParkTimeoutNs() const;
+    // eventfd consumer: arms producer wakes, false when data or a flush request that can be handled is pending
+    bool PrepareToPark();
+    // eventfd consumer: about to drain, producers may stop writing the eventfd
+    void Unpark();
+    // producer side drop accounting in the shared header, the consumer reads the running total
+    void AddDroppedEvents(uint32_t count);
+    uint32_t GetDroppedEvents() const;
+    static bool IsOverflowMarker(const uint32_t *data, size_t length)
+    {
+        return length == MIDI_RING_OVERFLOW_MARKER_WORDS && data != nullptr && data[0] == MIDI_RING_OVERFLOW_MARKER;
+    }
+    // bytes between read and write position, a wrap gap counts as used
+    uint32_t GetUsedBytes() const;
+    // pins the mapping in RAM so a real-time reader or writer never takes a page fault on it
+    int32_t LockMemory();
     ControlHeader *GetControlHeader() const;
+    // thread safe among producers of a MULTI_PRODUCER ring, other formats need a single producer
     MidiStatusCode TryWriteEvents(
         const MidiEventInner *events, uint32_t eventCount, uint32_t *eventsWritten, bool notify = true);
     MidiStatusCode TryWriteEvent(const MidiEventInner &event, bool notify = true);
+    /**
+     * Blocking variant of TryWriteEvents. When the ring is full it parks on the space futex until the consumer
+     * frees room. Returns TIMEOUT with eventsWritten set if timeoutInNs elapses first, timeoutInNs <= 0 waits
+     * until everything is written or the ring is shut down.
+     */
+    MidiStatusCode WriteEventsBlocking(
+        const MidiEventInner *events, uint32_t eventCount, uint32_t *eventsWritten, int64_t timeoutInNs);
+    /**
+     * Producer side: ask the consumer to drop every record written so far. Does not wait, records written
+     * after this call are kept. The consumer acts on it in ConsumeFlushRequest().
+     */
+    void RequestFlush();
 
     struct PeekedEvent {
-        const ShmMidiEventHeader *headerPtr = nullptr;
+        const ShmMidiEventHeader *headerPtr = nullptr;  // nullptr for compact records
         const uint8_t *payloadPtr = nullptr;
 
         uint64_t timestamp = 0;
@@ -99,20 +216,48 @@ public:
     MidiStatusCode PeekNext(PeekedEvent &outEvent);
 
     void CommitRead(const PeekedEvent &event);
+    // consumer side: true when the producer asked for a flush that has not been handled yet
+    bool IsFlushRequested() const;
+    // consumer side: discard records up to the requested flush position, returns the number dropped. On a
+    // multi-producer ring the request stays pending while a record before that position is uncommitted
+    uint32_t ConsumeFlushRequest();
     void DrainToBatch(std::vector<MidiEvent> &outEvents, std::vector<std::vector<uint32_t>> &outPayloadBuffers,
         uint32_t maxEvents = 0);
 
+    /**
+     * Zero-copy batch read. Fills outEvents with views whose data points directly into the shared ring,
+     * without moving readPosition. The views stay valid until CommitBatch() is called.
+     * Returns OK if at least one event was peeked.
+     */
+    MidiStatusCode PeekBatch(std::vector<OH_MIDIEvent> &outEvents, uint32_t maxEvents = 0);
+    void CommitBatch();
+
 private:
     bool ValidateOneEvent(const MidiEventInner &event) const;
     void WakeFutex(uint32_t wakeVal = IS_READY);
+    void WakeServerByEventFd();
+    void NotifyAfterWrite(uint32_t written);
     void WriteEvent(uint32_t writeIndex, const MidiEventInner &event);
+    void PublishRecordFlags(ShmMidiEventHeader *header, uint32_t flags);
+    bool IsRecordCommitted(uint32_t readIndex) const;
+    MidiStatusCode TryWriteEventsShared(
+        const MidiEventInner *events, uint32_t eventCount, uint32_t *eventsWritten, bool notify);
+    uint32_t ReserveShared(const MidiEventInner *events, uint32_t eventCount, uint32_t &beginIndex);
+    uint32_t CountFitting(const MidiEventInner *events, uint32_t eventCount, uint32_t room, uint32_t &spanBytes) const;
+    void ReleaseReadRange(uint32_t fromIndex, uint32_t toIndex);
     MidiStatusCode ValidateWriteArgs(const MidiEventInner *events, uint32_t eventCount) const;
-    MidiStatusCode TryWriteOneEvent(
-        const MidiEventInner &event, uint32_t length, uint32_t readIndex, uint32_t &writeIndex);
-    bool UpdateWriteIndexIfNeed(uint32_t &writeIndex, uint32_t needed);
+    void WriteCompactEvent(uint32_t writeIndex, const MidiEventInner &event, bool isShort);
+    bool IsShortCompactRecord(const MidiEventInner &event) const;
+    uint32_t RecordSize(const MidiEventInner &event) const;
+    uint32_t MinRecordHeaderSize() const;
+    uint32_t MaxRecordHeaderSize() const;
+    bool ReserveContiguous(uint32_t readIndex, uint32_t &writeIndex, uint32_t needed);
+    void WriteWrapMarker(uint32_t writeIndex);
     MidiStatusCode UpdateReadIndexIfNeed(uint32_t &readIndex, uint32_t writeIndex);
-    MidiStatusCode HandleWrapIfNeeded(const ShmMidiEventHeader &hdr, uint32_t &r);
     MidiStatusCode BuildPeekedEvent(const ShmMidiEventHeader &hdr, uint32_t readIndex, PeekedEvent &outEvent);
+    MidiStatusCode BuildCompactPeekedEvent(uint32_t readIndex, uint64_t baseTimestamp, PeekedEvent &outEvent);
+    MidiStatusCode PeekAt(uint32_t &readIndex, uint32_t writeIndex, uint64_t baseTimestamp, PeekedEvent &outEvent,
+        bool publishWrap = false);
     MidiEvent CopyOut(const PeekedEvent &peekedEvent, std::vector<uint32_t> &outPayloadBuffer) const;
 
     uint8_t *base_{nullptr};
@@ -120,6 +265,16 @@ private:
     uint8_t *ringBase_{nullptr};
     uint32_t capacity_{0};
     uint32_t totalMemorySize_{0};
+    uint32_t batchEndOffset_{0};
+    uint64_t batchLastTimestamp_{0};
+    bool batchPending_{false};
+    uint32_t cachedReadPosition_{0};  // producer side copy of readPosition, refreshed only when the ring looks full
+    MidiRingFormat format_{MidiRingFormat::STANDARD};
+    uint64_t lastWriteTimestamp_{0};  // compact delta base, producer side
+    uint32_t wakeThreshold_{1};       // producer side, see SetWakeCoalescing
+    uint32_t unannouncedEvents_{0};   // producer side, written since the last wake
+    uint64_t lastReadTimestamp_{0};   // compact delta base, consumer side (last committed record)
+    MidiAdaptiveWaiter waiter_;       // consumer side
     mutable std::shared_ptr<MidiSharedMemory> dataMem_ = nullptr;
     std::shared_ptr<UniqueFd> notifyFd_;
 };
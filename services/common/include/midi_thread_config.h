@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MIDI_THREAD_CONFIG_H
+#define MIDI_THREAD_CONFIG_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+#include "futex_tool.h"
+
+namespace OHOS {
+namespace MIDI {
+namespace {
+// used instead of a real-time policy the caller is not allowed to take
+constexpr int32_t MIDI_RT_FALLBACK_NICE = -10;
+}
+
+enum class MidiSchedPolicy : uint32_t { NORMAL = 0, FIFO = 1, RR = 2 };
+
+struct MidiThreadConfig {
+    MidiSchedPolicy policy = MidiSchedPolicy::NORMAL;
+    int32_t priority = 0;     // FIFO/RR priority, clamped to the range of the policy
+    uint64_t cpuMask = 0;     // bit n allows cpu n, 0 keeps the inherited affinity
+    bool lockMemory = false;  // mlock the shared rings the thread works on
+    MidiWaitStrategy waitStrategy = MidiWaitStrategy::PARK;  // futex consumers only, the output workers use epoll
+};
+
+class MidiThreadTool {
+public:
+    /**
+     * Applies policy, priority and affinity to the calling thread and returns the policy in effect afterwards.
+     * NORMAL leaves the scheduling of the thread as inherited.
+     * A refused real-time policy (no CAP_SYS_NICE, RLIMIT_RTPRIO) falls back to NORMAL with
+     * MIDI_RT_FALLBACK_NICE, which may be refused as well; both are logged, neither is fatal.
+     */
+    static MidiSchedPolicy ApplyToCurrentThread(const MidiThreadConfig &config);
+
+    // "key = value" lines, '#' starts a comment. Empty when the file cannot be read
+    static std::map<std::string, std::string> ReadConfigFile(const std::string &path);
+    /**
+     * Reads <prefix>sched_policy (normal|fifo|rr), <prefix>sched_priority, <prefix>cpu_set ("0,2-3") and
+     * <prefix>lock_memory (true|false). Missing keys leave the field untouched, returns false on a malformed value.
+     */
+    static bool ParseThreadConfig(const std::map<std::string, std::string> &values, const std::string &prefix,
+        MidiThreadConfig &config);
+    static bool ParseCpuSet(const std::string &text, uint64_t &cpuMask);
+    // plain decimal below one billion
+    static bool ParseUint(const std::string &text, uint32_t &value);
+};
+} // namespace MIDI
+} // namespace OHOS
+#endif
@@ -19,8 +19,10 @@
 #include "futex_tool.h"
 
 #include "linux/futex.h"
+#include <algorithm>
 #include <cinttypes>
 #include <ctime>
+#include <sched.h>
 #include <sys/syscall.h>
 
 #include "midi_log.h"
@@ -31,6 +33,16 @@ namespace MIDI {
 namespace {
 const int32_t WAIT_TRY_COUNT = 50;
 const int64_t SEC_TO_NANOSEC = 1000000000;
+const int32_t ADAPTIVE_YIELD_ROUNDS = 4;
+const uint32_t SPIN_CLOCK_STRIDE = 16;  // reading the clock costs more than a relax, check it every few rounds
+const int32_t WAIT_AVERAGE_SHIFT = 3;   // each wait moves the average by 1/8 of its distance
+
+// with a single cpu the producer cannot run while we spin, only the yield phase can help
+bool CanSpin()
+{
+    static const bool canSpin = ::sysconf(_SC_NPROCESSORS_ONLN) > 1;
+    return canSpin;
+}
 
 // Default implementation calling the real syscall
 static long g_realSysCall(std::atomic<uint32_t> *futexPtr, int op, int val, const struct timespec *timeout)
@@ -107,7 +119,8 @@ FutexCode ExecFutexWaitSyscall(std::atomic<uint32_t> *futexPtr, int64_t timeout,
     auto sysErr = errno;
 
     if ((res != 0) && (sysErr == ETIMEDOUT)) {
-        MIDI_WARNING_LOG("wait:%{public}" PRId64 "ns timeout, result:%{public}ld sysErr[%{public}d]:%{public}s",
+        // routine for a consumer polling within a wake budget, the caller decides whether it matters
+        MIDI_DEBUG_LOG("wait:%{public}" PRId64 "ns timeout, result:%{public}ld sysErr[%{public}d]:%{public}s",
                          timeout, res, sysErr, strerror(sysErr));
         return FUTEX_TIMEOUT;
     }
@@ -165,7 +178,10 @@ FutexCode FutexTool::FutexWait(std::atomic<uint32_t> *futexPtr, int64_t timeout,
 FutexCode FutexTool::FutexWake(std::atomic<uint32_t> *futexPtr, uint32_t wakeVal)
 {
     CHECK_AND_RETURN_RET_LOG(futexPtr != nullptr, FUTEX_INVALID_PARAMS, "futexPtr is null");
-    uint32_t current = futexPtr->load();
+    // the caller published its data before this; the waiter publishes IS_NOT_READY before re-checking that data,
+    // so after the fence at least one side sees the other
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    uint32_t current = futexPtr->load(std::memory_order_relaxed);
     if (current != IS_READY && current != IS_NOT_READY && current != IS_PRE_EXIT) {
         MIDI_ERR_LOG("failed: invalid param:%{public}u", current);
         return FUTEX_INVALID_PARAMS;
@@ -175,6 +191,10 @@ FutexCode FutexTool::FutexWake(std::atomic<uint32_t> *futexPtr, uint32_t wakeVal
         g_sysCallFunc(futexPtr, FUTEX_WAKE, INT_MAX, NULL);
         return FUTEX_SUCCESS;
     }
+    if (current != IS_NOT_READY) {
+        // nobody parked: skip the CAS, it would take the line from the waiter's side for nothing
+        return FUTEX_SUCCESS;
+    }
     uint32_t expect = IS_NOT_READY;
     if (futexPtr->compare_exchange_strong(expect, IS_READY)) {
         long res = g_sysCallFunc(futexPtr, FUTEX_WAKE, INT_MAX, NULL);
@@ -185,5 +205,56 @@ FutexCode FutexTool::FutexWake(std::atomic<uint32_t> *futexPtr, uint32_t wakeVal
     }
     return FUTEX_SUCCESS;
 }
+
+FutexCode MidiAdaptiveWaiter::Wait(std::atomic<uint32_t> *futexPtr, int64_t timeout,
+    const std::function<bool(void)> &pred)
+{
+    if (strategy_ == MidiWaitStrategy::PARK) {
+        return FutexTool::FutexWait(futexPtr, timeout, pred);
+    }
+    CHECK_AND_RETURN_RET_LOG(pred, FUTEX_INVALID_PARAMS, "pred err");
+    const int64_t begin = g_timeFunc();
+    if (SpinThenYield(begin, timeout, pred)) {
+        RecordWait(g_timeFunc() - begin);
+        return FUTEX_SUCCESS;
+    }
+    const int64_t spent = g_timeFunc() - begin;
+    if (timeout > 0 && spent >= timeout) {
+        RecordWait(spent);
+        return FUTEX_TIMEOUT;
+    }
+    const FutexCode ret = FutexTool::FutexWait(futexPtr, timeout > 0 ? timeout - spent : timeout, pred);
+    RecordWait(g_timeFunc() - begin);
+    return ret;
+}
+
+bool MidiAdaptiveWaiter::SpinThenYield(int64_t begin, int64_t timeout, const std::function<bool(void)> &pred) const
+{
+    const int64_t spinEnd = begin + ((timeout > 0) ? std::min(spinBudgetNs_, timeout) : spinBudgetNs_);
+    for (uint32_t round = 1; CanSpin(); ++round) {
+        if (pred()) {
+            return true;
+        }
+        if (round % SPIN_CLOCK_STRIDE == 0 && g_timeFunc() >= spinEnd) {
+            break;
+        }
+        CpuRelax();
+    }
+    for (int32_t round = 0; round < ADAPTIVE_YIELD_ROUNDS; ++round) {
+        (void)sched_yield();
+        if (pred()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void MidiAdaptiveWaiter::RecordWait(int64_t waitedNs)
+{
+    waitAverageNs_ += (std::max<int64_t>(waitedNs, 0) - waitAverageNs_) / (1 << WAIT_AVERAGE_SHIFT);
+    // spinning only pays off when the next event usually shows up within the budget
+    spinBudgetNs_ = (waitAverageNs_ > ADAPTIVE_MAX_SPIN_NS) ? ADAPTIVE_MIN_SPIN_NS :
+        std::clamp<int64_t>(waitAverageNs_ * 2, ADAPTIVE_MIN_SPIN_NS, ADAPTIVE_MAX_SPIN_NS);
+}
 } // namespace MIDI
 } // namespace OHOS
\ No newline at end of file
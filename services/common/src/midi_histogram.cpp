@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "midi_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+namespace OHOS {
+namespace MIDI {
+
+uint64_t MidiHistogram::BucketUpperBound(uint32_t index)
+{
+    if (index < 2 * SUB_BUCKETS) {
+        return index;  // exact below 16
+    }
+    const uint32_t shift = index / SUB_BUCKETS - 1;
+    const uint64_t lower = static_cast<uint64_t>((index % SUB_BUCKETS) | SUB_BUCKETS) << shift;
+    return lower + ((1ull << shift) - 1);
+}
+
+uint64_t MidiHistogram::Mean() const
+{
+    const uint64_t count = Count();
+    return count == 0 ? 0 : Sum() / count;
+}
+
+uint64_t MidiHistogram::Percentile(double fraction) const
+{
+    const uint64_t count = Count();
+    if (count == 0) {
+        return 0;
+    }
+    fraction = std::clamp(fraction, 0.0, 1.0);
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(fraction * count)));
+    uint64_t seen = 0;
+    for (uint32_t index = 0; index < BUCKET_COUNT; ++index) {
+        seen += buckets_[index].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            // the bucket bound may overshoot the largest sample
+            return std::min(BucketUpperBound(index), Max());
+        }
+    }
+    return Max();
+}
+
+std::string MidiHistogram::Summary() const
+{
+    std::ostringstream out;
+    out << "count " << Count() << " mean " << Mean() << " p50 " << Percentile(0.5) << " p90 " << Percentile(0.9)
+        << " p99 " << Percentile(0.99) << " p999 " << Percentile(0.999) << " max " << Max();
+    return out.str();
+}
+
+void MidiHistogram::Reset()
+{
+    for (auto &bucket : buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    count_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
+} // namespace MIDI
+} // namespace OHOS
@@ -39,9 +39,44 @@
 namespace OHOS {
 namespace MIDI {
 namespace {
-const uint32_t MAX_MMAP_BUFFER_SIZE = 0x2000;
+const uint32_t MAX_MMAP_BUFFER_SIZE = 0x10000;
 static constexpr int INVALID_FD = -1;
 static constexpr int MINFD = 2;
+constexpr uint32_t COMPACT_HEADER_SIZE = sizeof(uint32_t);
+constexpr uint32_t COMPACT_LONG_HEADER_SIZE = COMPACT_HEADER_SIZE + sizeof(uint64_t);
+constexpr uint32_t UMP_MT_SHIFT = 28;
+constexpr uint32_t WORD_BITS = 32;
+// UMP packet size in words indexed by message type, kept local since the idl target builds this file alone
+constexpr uint8_t UMP_WORDS_BY_MT[16] = {1, 1, 1, 2, 2, 4, 1, 1, 2, 2, 2, 3, 3, 4, 4, 4};
+constexpr uint32_t RESERVE_TAG_SHIFT = 16;
+
+static_assert(MAX_MMAP_BUFFER_SIZE - 1u <= MIDI_RING_POSITION_MASK, "ring index must fit below the reserve tag");
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "record flags are accessed in place");
+
+uint32_t RingFlagsOf(MidiRingFormat format)
+{
+    switch (format) {
+        case MidiRingFormat::COMPACT:
+            return RING_FLAG_COMPACT_RECORDS;
+        case MidiRingFormat::MULTI_PRODUCER:
+            return RING_FLAG_MULTI_PRODUCER;
+        default:
+            return RING_FLAG_NONE;
+    }
+}
+
+MidiRingFormat RingFormatOf(uint32_t flags)
+{
+    if ((flags & RING_FLAG_COMPACT_RECORDS) != 0) {
+        return MidiRingFormat::COMPACT;
+    }
+    return (flags & RING_FLAG_MULTI_PRODUCER) != 0 ? MidiRingFormat::MULTI_PRODUCER : MidiRingFormat::STANDARD;
+}
+
+inline std::atomic<uint32_t> &RecordFlags(const ShmMidiEventHeader *header)
+{
+    return *reinterpret_cast<std::atomic<uint32_t> *>(const_cast<uint32_t *>(&header->flags));
+}
 } // namespace
 
 class MidiSharedMemoryImpl : public MidiSharedMemory {
@@ -224,12 +259,6 @@ MidiSharedMemory *MidiSharedMemory::Unmarshalling(Parcel &parcel)
 //==================== Ring Math ====================//
 inline uint32_t RingUsed(uint32_t r, uint32_t w, uint32_t cap) { return (w >= r) ? (w - r) : (cap - (r - w)); }
 
-inline uint32_t RingFree(uint32_t r, uint32_t w, uint32_t cap)
-{
-    const uint32_t used = RingUsed(r, w, cap);
-    return (cap - 1u) - used;
-}
-
 inline bool IsValidOffset(uint32_t off, uint32_t cap) { return off < cap; }
 
 //==================== MidiSharedRing Public ====================//
@@ -239,7 +268,8 @@ MidiSharedRing::MidiSharedRing(uint32_t ringCapacityBytes) : capacity_(ringCapac
     totalMemorySize_ = sizeof(ControlHeader) + ringCapacityBytes;
 }
 
-MidiSharedRing::MidiSharedRing(uint32_t ringCapacityBytes, std::shared_ptr<UniqueFd> fd): capacity_(ringCapacityBytes)
+MidiSharedRing::MidiSharedRing(uint32_t ringCapacityBytes, std::shared_ptr<UniqueFd> fd, MidiRingFormat format)
+    : capacity_(ringCapacityBytes), format_(format)
 {
     totalMemorySize_ = sizeof(ControlHeader) + ringCapacityBytes;
     notifyFd_ = fd;
@@ -256,9 +286,30 @@ int32_t MidiSharedRing::Init(int dataFd)
     }
     base_ = dataMem_->GetBase();
     controler_ = reinterpret_cast<ControlHeader *>(base_);
+    // zero means the peer has not stamped the layout yet
+    CHECK_AND_RETURN_RET_LOG(controler_->layoutVersion == 0 || controler_->layoutVersion == MIDI_SHM_LAYOUT_VERSION,
+        MIDI_STATUS_GENERIC_INVALID_ARGUMENT, "layout version mismatch: %{public}u", controler_->layoutVersion);
+    if (dataFd != INVALID_FD && controler_->layoutVersion == MIDI_SHM_LAYOUT_VERSION) {
+        // the creator already picked the record format
+        format_ = RingFormatOf(controler_->flags);
+    }
+    controler_->layoutVersion = MIDI_SHM_LAYOUT_VERSION;
     controler_->capacity = capacity_;
-    controler_->readPosition.store(0);
-    controler_->writePosition.store(0);
+    controler_->flags = RingFlagsOf(format_);
+    controler_->readPosition.store(0, std::memory_order_relaxed);
+    controler_->flushRequest.store(0, std::memory_order_relaxed);
+    controler_->flushPosition.store(0, std::memory_order_relaxed);
+    controler_->flushAck.store(0, std::memory_order_relaxed);
+    controler_->droppedEvents.store(0, std::memory_order_relaxed);
+    if (dataFd == INVALID_FD) {
+        // wake settings belong to the creator, the peer mapping the ring later must not reset them
+        controler_->consumerParked.store(1, std::memory_order_relaxed);
+        controler_->wakeBudgetUs.store(0, std::memory_order_relaxed);
+    }
+    controler_->writePosition.store(0, std::memory_order_release);
+    cachedReadPosition_ = 0;
+    lastWriteTimestamp_ = 0;
+    lastReadTimestamp_ = 0;
 
     ringBase_ = base_ + sizeof(ControlHeader);
 
@@ -272,19 +323,20 @@ int MidiSharedRing::GetEventFd() const
     return notifyFd_->Get();
 }
 
-std::shared_ptr<MidiSharedRing> MidiSharedRing::CreateFromLocal(size_t ringCapacityBytes)
+std::shared_ptr<MidiSharedRing> MidiSharedRing::CreateFromLocal(size_t ringCapacityBytes, MidiRingFormat format)
 {
     MIDI_DEBUG_LOG("ringCapacityBytes %{public}zu", ringCapacityBytes);
 
-    std::shared_ptr<MidiSharedRing> buffer = std::make_shared<MidiSharedRing>(ringCapacityBytes);
+    std::shared_ptr<MidiSharedRing> buffer = std::make_shared<MidiSharedRing>(ringCapacityBytes, nullptr, format);
     CHECK_AND_RETURN_RET_LOG(buffer->Init(INVALID_FD) == MIDI_STATUS_OK, nullptr, "failed to init.");
     return buffer;
 }
 
-std::shared_ptr<MidiSharedRing> MidiSharedRing::CreateFromLocal(size_t ringCapacityBytes, std::shared_ptr<UniqueFd> fd)
+std::shared_ptr<MidiSharedRing> MidiSharedRing::CreateFromLocal(
+    size_t ringCapacityBytes, std::shared_ptr<UniqueFd> fd, MidiRingFormat format)
 {
     MIDI_DEBUG_LOG("ringCapacityBytes %{public}zu", ringCapacityBytes);
-    std::shared_ptr<MidiSharedRing> buffer = std::make_shared<MidiSharedRing>(ringCapacityBytes, fd);
+    std::shared_ptr<MidiSharedRing> buffer = std::make_shared<MidiSharedRing>(ringCapacityBytes, fd, format);
     CHECK_AND_RETURN_RET_LOG(buffer->Init(INVALID_FD) == MIDI_STATUS_OK, nullptr, "failed to init.");
     return buffer;
 }
@@ -308,11 +360,12 @@ bool MidiSharedRing::Marshalling(Parcel &parcel) const
 {
     MessageParcel &messageParcel = static_cast<MessageParcel &>(parcel);
     CHECK_AND_RETURN_RET_LOG(dataMem_ != nullptr, false, "dataMem_ is nullptr.");
+    CHECK_AND_RETURN_RET(messageParcel.WriteUint32(capacity_) && messageParcel.WriteUint32(MIDI_SHM_LAYOUT_VERSION),
+        false);
     if (notifyFd_ == nullptr) {
-        return messageParcel.WriteUint32(capacity_) && messageParcel.WriteFileDescriptor(dataMem_->GetFd());
+        return messageParcel.WriteFileDescriptor(dataMem_->GetFd());
     }
-    return messageParcel.WriteUint32(capacity_) &&
-        messageParcel.WriteFileDescriptor(dataMem_->GetFd()) && messageParcel.WriteFileDescriptor(notifyFd_->Get());
+    return messageParcel.WriteFileDescriptor(dataMem_->GetFd()) && messageParcel.WriteFileDescriptor(notifyFd_->Get());
 }
 
 MidiSharedRing *MidiSharedRing::Unmarshalling(Parcel &parcel)
@@ -320,9 +373,17 @@ MidiSharedRing *MidiSharedRing::Unmarshalling(Parcel &parcel)
     MIDI_DEBUG_LOG("ReadFromParcel start.");
     MessageParcel &messageParcel = static_cast<MessageParcel &>(parcel);
     uint32_t ringSize = messageParcel.ReadUint32();
+    uint32_t layoutVersion = messageParcel.ReadUint32();
     int dataFd = messageParcel.ReadFileDescriptor();
     int eventFd = messageParcel.ReadFileDescriptor();
 
+    if (layoutVersion != MIDI_SHM_LAYOUT_VERSION) {
+        MIDI_ERR_LOG("layout version mismatch: peer %{public}u local %{public}u", layoutVersion,
+            MIDI_SHM_LAYOUT_VERSION);
+        CloseFd(dataFd);
+        CloseFd(eventFd);
+        return nullptr;
+    }
     int minfd = 2; // ignore stdout, stdin and stderr.
     CHECK_AND_RETURN_RET_LOG(dataFd > minfd, nullptr, "invalid dataFd: %{public}d", dataFd);
     
@@ -349,14 +410,19 @@ uint32_t MidiSharedRing::GetCapacity() const
     return capacity_;
 }
 
+MidiRingFormat MidiSharedRing::GetFormat() const
+{
+    return format_;
+}
+
 uint32_t MidiSharedRing::GetReadPosition() const
 {
-    return controler_->readPosition.load();
+    return controler_->readPosition.load(std::memory_order_acquire);
 }
 
 uint32_t MidiSharedRing::GetWritePosition() const
 {
-    return controler_->writePosition.load();
+    return controler_->writePosition.load(std::memory_order_acquire) & MIDI_RING_POSITION_MASK;
 }
 
 uint8_t *MidiSharedRing::GetDataBase() const
@@ -366,7 +432,79 @@ uint8_t *MidiSharedRing::GetDataBase() const
 
 bool MidiSharedRing::IsEmpty() const
 {
-    return GetReadPosition() == GetWritePosition();
+    const uint32_t readIndex = GetReadPosition();
+    if (readIndex == GetWritePosition()) {
+        return true;
+    }
+    // a reserved record nobody finished writing is nothing to wake up for
+    return format_ == MidiRingFormat::MULTI_PRODUCER && !IsRecordCommitted(readIndex);
+}
+
+void MidiSharedRing::SetWakeCoalescing(uint32_t eventThreshold, uint32_t budgetUs)
+{
+    CHECK_AND_RETURN(controler_ != nullptr);
+    const bool coalesce = eventThreshold > 1 && budgetUs != 0;
+    wakeThreshold_ = coalesce ? eventThreshold : 1;
+    unannouncedEvents_ = 0;
+    controler_->wakeBudgetUs.store(coalesce ? budgetUs : 0, std::memory_order_relaxed);
+}
+
+int64_t MidiSharedRing::GetParkTimeoutNs() const
+{
+    CHECK_AND_RETURN_RET(controler_ != nullptr, -1);
+    const uint32_t budgetUs = controler_->wakeBudgetUs.load(std::memory_order_relaxed);
+    return budgetUs == 0 ? -1 : static_cast<int64_t>(budgetUs * MIDI_NS_PER_US);
+}
+
+bool MidiSharedRing::PrepareToPark()
+{
+    CHECK_AND_RETURN_RET(controler_ != nullptr, true);
+    controler_->consumerParked.store(1, std::memory_order_relaxed);
+    // pairs with the fence in NotifyAfterWrite: either the producer sees the flag or we see its data
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!IsEmpty()) {
+        return false;
+    }
+    // a multi-producer flush stuck behind an uncommitted record is retried when that record's commit wakes us
+    return !IsFlushRequested() || (format_ == MidiRingFormat::MULTI_PRODUCER &&
+        GetReadPosition() != controler_->flushPosition.load(std::memory_order_relaxed));
+}
+
+void MidiSharedRing::Unpark()
+{
+    CHECK_AND_RETURN(controler_ != nullptr);
+    if (controler_->consumerParked.load(std::memory_order_relaxed) != 0) {
+        controler_->consumerParked.store(0, std::memory_order_relaxed);
+    }
+}
+
+void MidiSharedRing::AddDroppedEvents(uint32_t count)
+{
+    // single producer, no read-modify-write needed
+    controler_->droppedEvents.store(controler_->droppedEvents.load(std::memory_order_relaxed) + count,
+        std::memory_order_relaxed);
+}
+
+uint32_t MidiSharedRing::GetDroppedEvents() const
+{
+    return controler_->droppedEvents.load(std::memory_order_relaxed);
+}
+
+uint32_t MidiSharedRing::GetUsedBytes() const
+{
+    const uint32_t readPosition = GetReadPosition();
+    const uint32_t writePosition = GetWritePosition();
+    return writePosition >= readPosition ? writePosition - readPosition :
+        GetCapacity() - readPosition + writePosition;
+}
+
+int32_t MidiSharedRing::LockMemory()
+{
+    CHECK_AND_RETURN_RET_LOG(base_ != nullptr, MIDI_STATUS_UNKNOWN_ERROR, "ring is not mapped");
+    // RLIMIT_MEMLOCK may refuse it, the ring keeps working unlocked
+    CHECK_AND_RETURN_RET_LOG(::mlock(base_, totalMemorySize_) == 0, MIDI_STATUS_UNKNOWN_ERROR,
+        "mlock %{public}u bytes failed: %{public}s", totalMemorySize_, strerror(errno));
+    return MIDI_STATUS_OK;
 }
 
 std::atomic<uint32_t> *MidiSharedRing::GetFutex() const
@@ -377,6 +515,14 @@ std::atomic<uint32_t> *MidiSharedRing::GetFutex() const
     return &controler_->futexObj;
 }
 
+std::atomic<uint32_t> *MidiSharedRing::GetSpaceFutex() const
+{
+    if (!controler_) {
+        return nullptr;
+    }
+    return &controler_->spaceFutexObj;
+}
+
 ControlHeader *MidiSharedRing::GetControlHeader() const
 {
     return controler_;
@@ -384,7 +530,7 @@ ControlHeader *MidiSharedRing::GetControlHeader() const
 
 FutexCode MidiSharedRing::WaitFor(int64_t timeoutInNs, const std::function<bool(void)> &pred)
 {
-    return FutexTool::FutexWait(GetFutex(), timeoutInNs, [&pred]() { return pred(); });
+    return waiter_.Wait(GetFutex(), timeoutInNs, pred);
 }
 
 void MidiSharedRing::WakeFutex(uint32_t wakeVal)
@@ -399,6 +545,40 @@ void MidiSharedRing::NotifyConsumer(uint32_t wakeVal)
     WakeFutex(wakeVal);
 }
 
+void MidiSharedRing::NotifyProducer(uint32_t wakeVal)
+{
+    if (controler_) {
+        FutexTool::FutexWake(GetSpaceFutex(), wakeVal);
+    }
+}
+
+void MidiSharedRing::NotifyAfterWrite(uint32_t written)
+{
+    if (wakeThreshold_ > 1) {
+        unannouncedEvents_ += written;
+        if (unannouncedEvents_ < wakeThreshold_) {
+            // the consumer polls within the wake budget
+            return;
+        }
+        unannouncedEvents_ = 0;
+    }
+    // writePosition is published, a parked consumer re-checks it after publishing its parked state
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    NotifyConsumer();
+    if (controler_->consumerParked.load(std::memory_order_relaxed) != 0) {
+        WakeServerByEventFd();
+    }
+}
+
+void MidiSharedRing::WakeServerByEventFd()
+{
+    if (notifyFd_ && notifyFd_->Valid()) {
+        MIDI_DEBUG_LOG("notify server to consume midi events");
+        uint64_t writed = 1;
+        (void)::write(notifyFd_->Get(), &writed, sizeof(writed));
+    }
+}
+
 //==================== Write Side ====================//
 
 MidiStatusCode MidiSharedRing::TryWriteEvent(const MidiEventInner &event, bool notify)
@@ -417,24 +597,40 @@ MidiStatusCode MidiSharedRing::TryWriteEvents(
     if (status != MidiStatusCode::OK) {
         return status;
     }
+    if (format_ == MidiRingFormat::MULTI_PRODUCER) {
+        return TryWriteEventsShared(events, eventCount, eventsWritten, notify);
+    }
 
     uint32_t localWritten = 0;
-    uint32_t readIndex = controler_->readPosition.load();
-    uint32_t writeIndex = controler_->writePosition.load();
+    uint32_t readIndex = cachedReadPosition_;
+    uint32_t writeIndex = controler_->writePosition.load(std::memory_order_relaxed);
+    bool readIndexRefreshed = false;
 
-    for (uint32_t i = 0; i < eventCount; ++i) {
-        const MidiEventInner &event = events[i];
+    // serialise everything that fits into the free span(s), the consumer sees nothing until the single publish
+    while (localWritten < eventCount) {
+        const MidiEventInner &event = events[localWritten];
         if (!ValidateOneEvent(event)) {
             break;
         }
-        CHECK_AND_BREAK_LOG(ValidateOneEvent(event), "invalid envent");
-        const size_t payloadBytesSize = event.length * sizeof(uint32_t);
-        const uint32_t needed = static_cast<uint32_t>(sizeof(ShmMidiEventHeader) + payloadBytesSize);
-
-        auto ret = TryWriteOneEvent(event, needed, readIndex, writeIndex);
-        CHECK_AND_BREAK_LOG(ret == MidiStatusCode::OK, "write event fail");
+        const uint32_t needed = RecordSize(event);
+        if (!ReserveContiguous(readIndex, writeIndex, needed)) {
+            // cached index may be stale, only touch the consumer's cache line once when the ring looks full
+            if (readIndexRefreshed) {
+                break;
+            }
+            readIndex = controler_->readPosition.load(std::memory_order_acquire);
+            cachedReadPosition_ = readIndex;
+            readIndexRefreshed = true;
+            continue;
+        }
+        if (format_ == MidiRingFormat::COMPACT) {
+            WriteCompactEvent(writeIndex, event, needed == COMPACT_HEADER_SIZE + event.length * sizeof(uint32_t));
+        } else {
+            WriteEvent(writeIndex, event);
+        }
+        writeIndex += needed;
+        writeIndex = (writeIndex == capacity_) ? 0 : writeIndex;
         ++localWritten;
-        readIndex = controler_->readPosition.load();
     }
 
     if (eventsWritten) {
@@ -444,44 +640,163 @@ MidiStatusCode MidiSharedRing::TryWriteEvents(
     if (localWritten == 0) {
         return MidiStatusCode::WOULD_BLOCK;
     }
+    controler_->writePosition.store(writeIndex, std::memory_order_release);
 
     if (notify) {
-        NotifyConsumer();
-        if (notifyFd_ && notifyFd_->Valid()) {
-            MIDI_DEBUG_LOG("notify server to consume midi events");
-            uint64_t writed = 1;
-            (void)::write(notifyFd_->Get(), &writed, sizeof(writed));
-        }
+        NotifyAfterWrite(localWritten);
     }
     return (localWritten == eventCount) ? MidiStatusCode::OK : MidiStatusCode::WOULD_BLOCK;
 }
 
-//==================== Read Side (Peek + Commit) ====================//
-
-MidiStatusCode MidiSharedRing::PeekNext(PeekedEvent &outEvent)
+MidiStatusCode MidiSharedRing::TryWriteEventsShared(
+    const MidiEventInner *events, uint32_t eventCount, uint32_t *eventsWritten, bool notify)
 {
-    outEvent = PeekedEvent{};
+    uint32_t localWritten = 0;
+    while (localWritten < eventCount) {
+        uint32_t writeIndex = 0;
+        const uint32_t reserved = ReserveShared(events + localWritten, eventCount - localWritten, writeIndex);
+        if (reserved == 0) {
+            break;
+        }
+        // the span is ours alone, each record goes live on its own commit flag
+        for (uint32_t i = 0; i < reserved; ++i) {
+            const MidiEventInner &event = events[localWritten + i];
+            WriteEvent(writeIndex, event);
+            writeIndex += RecordSize(event);
+        }
+        localWritten += reserved;
+    }
 
-    CHECK_AND_RETURN_RET(capacity_ >= (sizeof(ShmMidiEventHeader) + 1u), MidiStatusCode::SHM_BROKEN);
+    if (eventsWritten) {
+        *eventsWritten = localWritten;
+    }
+    if (localWritten == 0) {
+        return MidiStatusCode::WOULD_BLOCK;
+    }
+    if (notify) {
+        NotifyAfterWrite(localWritten);
+    }
+    return (localWritten == eventCount) ? MidiStatusCode::OK : MidiStatusCode::WOULD_BLOCK;
+}
+
+uint32_t MidiSharedRing::ReserveShared(const MidiEventInner *events, uint32_t eventCount, uint32_t &beginIndex)
+{
+    uint32_t cursor = controler_->writePosition.load(std::memory_order_relaxed);
     for (;;) {
-        uint32_t readIndex = GetReadPosition();
-        uint32_t writeIndex = GetWritePosition();
+        // cursor before readPosition: a stale read index only ever understates the free space
+        const uint32_t writeIndex = cursor & MIDI_RING_POSITION_MASK;
+        const uint32_t readIndex = controler_->readPosition.load(std::memory_order_acquire);
+        uint32_t spanBytes = 0;
+        uint32_t count = 0;
+        bool wrap = false;
+        if (writeIndex < readIndex) {
+            count = CountFitting(events, eventCount, readIndex - writeIndex - 1u, spanBytes);
+        } else {
+            // keep one byte free so a full ring never looks empty
+            count = CountFitting(events, eventCount, capacity_ - writeIndex - ((readIndex == 0) ? 1u : 0u),
+                spanBytes);
+            if (count == 0 && readIndex != 0) {
+                count = CountFitting(events, eventCount, readIndex - 1u, spanBytes);
+                wrap = true;
+            }
+        }
+        if (count == 0) {
+            return 0;
+        }
+        beginIndex = wrap ? 0 : writeIndex;
+        uint32_t endIndex = beginIndex + spanBytes;
+        endIndex = (endIndex == capacity_) ? 0 : endIndex;
+        // the tag changes on every reservation, so a cursor that came round to the same index still fails the CAS
+        const uint32_t next = ((cursor >> RESERVE_TAG_SHIFT) + 1u) << RESERVE_TAG_SHIFT | endIndex;
+        if (controler_->writePosition.compare_exchange_weak(cursor, next, std::memory_order_relaxed)) {
+            if (wrap) {
+                WriteWrapMarker(writeIndex);
+            }
+            return count;
+        }
+    }
+}
 
-        auto ret = UpdateReadIndexIfNeed(readIndex, writeIndex);
-        if (ret != MidiStatusCode::OK) {
-            return ret;
+uint32_t MidiSharedRing::CountFitting(
+    const MidiEventInner *events, uint32_t eventCount, uint32_t room, uint32_t &spanBytes) const
+{
+    spanBytes = 0;
+    uint32_t count = 0;
+    while (count < eventCount && ValidateOneEvent(events[count])) {
+        const uint32_t needed = RecordSize(events[count]);
+        if (needed > room - spanBytes) {
+            break;
         }
+        spanBytes += needed;
+        ++count;
+    }
+    return count;
+}
 
-        const ShmMidiEventHeader *header = reinterpret_cast<const ShmMidiEventHeader *>(ringBase_ + readIndex);
-        ret = HandleWrapIfNeeded(*header, readIndex);
-        if (ret == MidiStatusCode::OK) {
-            continue;
+MidiStatusCode MidiSharedRing::WriteEventsBlocking(
+    const MidiEventInner *events, uint32_t eventCount, uint32_t *eventsWritten, int64_t timeoutInNs)
+{
+    uint32_t total = 0;
+    MidiStatusCode status = MidiStatusCode::OK;
+    const int64_t deadline = (timeoutInNs > 0) ? ClockTime::GetCurNano() + timeoutInNs : 0;
+    while (total < eventCount) {
+        // snapshot before trying, any consumer progress after this point ends the wait below
+        const uint32_t readIndex = GetReadPosition();
+        uint32_t written = 0;
+        status = TryWriteEvents(events + total, eventCount - total, &written);
+        total += written;
+        if (status != MidiStatusCode::WOULD_BLOCK || total == eventCount) {
+            break;
         }
-        if (ret == MidiStatusCode::SHM_BROKEN) {
-            return ret;
+        // an invalid event never fits, do not wait for it
+        if (!ValidateOneEvent(events[total])) {
+            status = MidiStatusCode::INVALID_ARGUMENT;
+            break;
         }
-        return BuildPeekedEvent(*header, readIndex, outEvent);
+        int64_t remaining = 0;
+        if (deadline != 0) {
+            remaining = deadline - ClockTime::GetCurNano();
+            if (remaining <= 0) {
+                status = MidiStatusCode::TIMEOUT;
+                break;
+            }
+        }
+        FutexCode ret = FutexTool::FutexWait(GetSpaceFutex(), remaining,
+            [this, readIndex]() { return GetReadPosition() != readIndex; });
+        if (ret == FUTEX_TIMEOUT) {
+            status = MidiStatusCode::TIMEOUT;
+            break;
+        }
+        if (ret != FUTEX_SUCCESS) {
+            status = MidiStatusCode::INTERNAL_ERROR;
+            break;
+        }
+    }
+    if (eventsWritten) {
+        *eventsWritten = total;
     }
+    return status;
+}
+
+void MidiSharedRing::RequestFlush()
+{
+    CHECK_AND_RETURN(controler_ != nullptr);
+    // the last published record boundary is the flush point, callers serialise RequestFlush among themselves
+    controler_->flushPosition.store(GetWritePosition(), std::memory_order_relaxed);
+    controler_->flushRequest.fetch_add(1, std::memory_order_release);
+    NotifyConsumer();
+    WakeServerByEventFd();
+}
+
+//==================== Read Side (Peek + Commit) ====================//
+
+MidiStatusCode MidiSharedRing::PeekNext(PeekedEvent &outEvent)
+{
+    outEvent = PeekedEvent{};
+
+    CHECK_AND_RETURN_RET(capacity_ >= (MaxRecordHeaderSize() + 1u), MidiStatusCode::SHM_BROKEN);
+    uint32_t readIndex = GetReadPosition();
+    return PeekAt(readIndex, GetWritePosition(), lastReadTimestamp_, outEvent, true);
 }
 
 void MidiSharedRing::CommitRead(const PeekedEvent &ev)
@@ -490,7 +805,35 @@ void MidiSharedRing::CommitRead(const PeekedEvent &ev)
     if (end >= capacity_) {
         end = 0;
     }
-    controler_->readPosition.store(end);
+    lastReadTimestamp_ = ev.timestamp;
+    ReleaseReadRange(GetReadPosition(), end);
+}
+
+bool MidiSharedRing::IsFlushRequested() const
+{
+    CHECK_AND_RETURN_RET(controler_ != nullptr, false);
+    return controler_->flushRequest.load(std::memory_order_acquire) !=
+        controler_->flushAck.load(std::memory_order_relaxed);
+}
+
+uint32_t MidiSharedRing::ConsumeFlushRequest()
+{
+    CHECK_AND_RETURN_RET(controler_ != nullptr, 0);
+    const uint32_t request = controler_->flushRequest.load(std::memory_order_acquire);
+    const uint32_t target = controler_->flushPosition.load(std::memory_order_relaxed);
+    // walk instead of jumping so wrap markers and the compact timestamp base stay in step with the producer
+    uint32_t dropped = 0;
+    PeekedEvent peekedEvent;
+    while (GetReadPosition() != target && PeekNext(peekedEvent) == MidiStatusCode::OK) {
+        CommitRead(peekedEvent);
+        ++dropped;
+    }
+    // another producer may still be copying a record it reserved before the flush, ack once that one is gone too
+    if (format_ == MidiRingFormat::MULTI_PRODUCER && GetReadPosition() != target) {
+        return dropped;
+    }
+    controler_->flushAck.store(request, std::memory_order_release);
+    return dropped;
 }
 
 void MidiSharedRing::DrainToBatch(
@@ -518,6 +861,60 @@ void MidiSharedRing::DrainToBatch(
     }
 }
 
+MidiStatusCode MidiSharedRing::PeekBatch(std::vector<OH_MIDIEvent> &outEvents, uint32_t maxEvents)
+{
+    outEvents.clear();
+    batchPending_ = false;
+    CHECK_AND_RETURN_RET(capacity_ >= (MaxRecordHeaderSize() + 1u), MidiStatusCode::SHM_BROKEN);
+
+    // walk with a local read index, readPosition is only published by CommitBatch
+    uint32_t readIndex = GetReadPosition();
+    const uint32_t writeIndex = GetWritePosition();
+    uint64_t baseTimestamp = lastReadTimestamp_;
+    MidiStatusCode status = MidiStatusCode::OK;
+    while (maxEvents == 0 || outEvents.size() < maxEvents) {
+        PeekedEvent peekedEvent;
+        status = PeekAt(readIndex, writeIndex, baseTimestamp, peekedEvent);
+        if (status != MidiStatusCode::OK) {
+            break;
+        }
+        OH_MIDIEvent view{};
+        view.timestamp = peekedEvent.timestamp;
+        view.length = peekedEvent.length;
+        view.data = reinterpret_cast<uint32_t *>(const_cast<uint8_t *>(peekedEvent.payloadPtr));
+        outEvents.push_back(view);
+        readIndex = peekedEvent.endOffset;
+        baseTimestamp = peekedEvent.timestamp;
+    }
+
+    CHECK_AND_RETURN_RET(!outEvents.empty(), status);
+    batchEndOffset_ = readIndex;
+    batchLastTimestamp_ = baseTimestamp;
+    batchPending_ = true;
+    return MidiStatusCode::OK;
+}
+
+void MidiSharedRing::CommitBatch()
+{
+    CHECK_AND_RETURN(batchPending_);
+    lastReadTimestamp_ = batchLastTimestamp_;
+    ReleaseReadRange(GetReadPosition(), batchEndOffset_);
+    batchPending_ = false;
+}
+
+void MidiSharedRing::ReleaseReadRange(uint32_t fromIndex, uint32_t toIndex)
+{
+    if (format_ == MidiRingFormat::MULTI_PRODUCER && fromIndex != toIndex) {
+        // a later record header may land anywhere in this range, it must not find a stale committed flag there
+        if (toIndex < fromIndex) {
+            (void)memset_s(ringBase_ + fromIndex, capacity_ - fromIndex, 0, capacity_ - fromIndex);
+            fromIndex = 0;
+        }
+        (void)memset_s(ringBase_ + fromIndex, toIndex - fromIndex, 0, toIndex - fromIndex);
+    }
+    controler_->readPosition.store(toIndex, std::memory_order_release);
+}
+
 //==================== Private Helpers (All <= 50 lines) ====================//
 
 MidiStatusCode MidiSharedRing::ValidateWriteArgs(const MidiEventInner *events, uint32_t eventCount) const
@@ -528,7 +925,7 @@ MidiStatusCode MidiSharedRing::ValidateWriteArgs(const MidiEventInner *events, u
     if (!events) {
         return MidiStatusCode::INVALID_ARGUMENT;
     }
-    if (capacity_ < (sizeof(ShmMidiEventHeader) + 1u)) {
+    if (capacity_ < (MaxRecordHeaderSize() + 1u)) {
         return MidiStatusCode::SHM_BROKEN;
     }
     return MidiStatusCode::OK;
@@ -542,46 +939,81 @@ bool MidiSharedRing::ValidateOneEvent(const MidiEventInner &event) const
         return false;
     }
     const size_t payloadBytes = event.length * sizeof(uint32_t);
-    const size_t maxLeftBytes = static_cast<size_t>(capacity_) - 1u - sizeof(ShmMidiEventHeader);
+    const size_t maxLeftBytes = static_cast<size_t>(capacity_) - 1u - MaxRecordHeaderSize();
     CHECK_AND_RETURN_RET_LOG(payloadBytes <= maxLeftBytes, false, "event length overflow");
     return true;
 }
 
-MidiStatusCode MidiSharedRing::TryWriteOneEvent(
-    const MidiEventInner &event, uint32_t totalBytes, uint32_t readIndex, uint32_t &writeIndex)
+bool MidiSharedRing::IsRecordCommitted(uint32_t readIndex) const
 {
-    const uint32_t freeSize = RingFree(readIndex, writeIndex, capacity_);
-    CHECK_AND_RETURN_RET(freeSize >= totalBytes, MidiStatusCode::WOULD_BLOCK);
+    if (capacity_ - readIndex < sizeof(ShmMidiEventHeader)) {
+        // tail too short for a header, the record starts at 0
+        readIndex = 0;
+    }
+    const auto *header = reinterpret_cast<const ShmMidiEventHeader *>(ringBase_ + readIndex);
+    return (RecordFlags(header).load(std::memory_order_acquire) & SHM_EVENT_FLAG_COMMITTED) != 0;
+}
 
-    UpdateWriteIndexIfNeed(writeIndex, totalBytes);
-    const uint32_t writeSize = (writeIndex < readIndex) ? (readIndex - writeIndex - 1u) : (capacity_ - writeIndex);
-    CHECK_AND_RETURN_RET(writeSize >= totalBytes, MidiStatusCode::WOULD_BLOCK);
+uint32_t MidiSharedRing::MinRecordHeaderSize() const
+{
+    return (format_ == MidiRingFormat::COMPACT) ? COMPACT_HEADER_SIZE : sizeof(ShmMidiEventHeader);
+}
 
-    WriteEvent(writeIndex, event);
+uint32_t MidiSharedRing::MaxRecordHeaderSize() const
+{
+    return (format_ == MidiRingFormat::COMPACT) ? COMPACT_LONG_HEADER_SIZE : sizeof(ShmMidiEventHeader);
+}
 
-    writeIndex += totalBytes;
-    writeIndex = writeIndex == capacity_ ? 0 : writeIndex;
-    controler_->writePosition.store(writeIndex);
-    return MidiStatusCode::OK;
+bool MidiSharedRing::IsShortCompactRecord(const MidiEventInner &event) const
+{
+    if (event.length == 0 || event.timestamp < lastWriteTimestamp_ ||
+        (event.timestamp - lastWriteTimestamp_) > COMPACT_DELTA_MASK) {
+        return false;
+    }
+    // the reader derives the length from the message type, only packets that agree with it can drop it
+    return UMP_WORDS_BY_MT[event.data[0] >> UMP_MT_SHIFT] == event.length;
 }
 
-bool MidiSharedRing::UpdateWriteIndexIfNeed(uint32_t &writeIndex, uint32_t totalBytes)
+uint32_t MidiSharedRing::RecordSize(const MidiEventInner &event) const
 {
-    const uint32_t tail = capacity_ - writeIndex;
-    if (tail >= totalBytes) {
+    const uint32_t payloadBytes = static_cast<uint32_t>(event.length * sizeof(uint32_t));
+    if (format_ != MidiRingFormat::COMPACT) {
+        return sizeof(ShmMidiEventHeader) + payloadBytes;
+    }
+    return (IsShortCompactRecord(event) ? COMPACT_HEADER_SIZE : COMPACT_LONG_HEADER_SIZE) + payloadBytes;
+}
+
+bool MidiSharedRing::ReserveContiguous(uint32_t readIndex, uint32_t &writeIndex, uint32_t needed)
+{
+    if (writeIndex < readIndex) {
+        return (readIndex - writeIndex - 1u) >= needed;
+    }
+    // keep one byte free so a full ring never looks empty
+    const uint32_t tail = capacity_ - writeIndex - ((readIndex == 0) ? 1u : 0u);
+    if (tail >= needed) {
+        return true;
+    }
+    // the wrap is the only split point, and only taken when the record fits in front of the reader
+    if (readIndex == 0 || (readIndex - 1u) < needed) {
         return false;
     }
+    WriteWrapMarker(writeIndex);
+    writeIndex = 0;
+    return true;
+}
 
-    // if tailBytes not enough, wrap and update writeIndex
-    if (tail >= sizeof(ShmMidiEventHeader)) {
+void MidiSharedRing::WriteWrapMarker(uint32_t writeIndex)
+{
+    const uint32_t tail = capacity_ - writeIndex;
+    if (format_ == MidiRingFormat::COMPACT && tail >= COMPACT_HEADER_SIZE) {
+        *reinterpret_cast<uint32_t *>(ringBase_ + writeIndex) = COMPACT_WRAP_BIT;
+    } else if (format_ != MidiRingFormat::COMPACT && tail >= sizeof(ShmMidiEventHeader)) {
         auto *header = reinterpret_cast<ShmMidiEventHeader *>(ringBase_ + writeIndex);
         header->timestamp = 0;
         header->length = 0;
-        header->flags = SHM_EVENT_FLAG_WRAP;
+        PublishRecordFlags(header, SHM_EVENT_FLAG_WRAP);
     }
-    writeIndex = 0;
-    controler_->writePosition.store(writeIndex);
-    return true;
+    // a shorter tail carries no marker, the reader skips it by size
 }
 
 void MidiSharedRing::WriteEvent(uint32_t writeIndex, const MidiEventInner &event)
@@ -590,12 +1022,41 @@ void MidiSharedRing::WriteEvent(uint32_t writeIndex, const MidiEventInner &event
     auto *header = reinterpret_cast<ShmMidiEventHeader *>(dst);
     header->timestamp = event.timestamp;
     header->length = static_cast<uint32_t>(event.length);
-    header->flags = SHM_EVENT_FLAG_NONE;
 
     uint8_t *payload = dst + sizeof(ShmMidiEventHeader);
+    const size_t payloadBytes = event.length * sizeof(uint32_t);
+    JUDGE_AND_ERR_LOG(payloadBytes == 0, "copy length is zero!");
+    if (payloadBytes > 0) {
+        memcpy_s(payload, payloadBytes, reinterpret_cast<const void *>(event.data), payloadBytes);
+    }
+    // last, a multi-producer consumer reads the record as soon as it sees the flags
+    PublishRecordFlags(header, SHM_EVENT_FLAG_NONE);
+}
+
+void MidiSharedRing::PublishRecordFlags(ShmMidiEventHeader *header, uint32_t flags)
+{
+    if (format_ != MidiRingFormat::MULTI_PRODUCER) {
+        header->flags = flags;
+        return;
+    }
+    RecordFlags(header).store(flags | SHM_EVENT_FLAG_COMMITTED, std::memory_order_release);
+}
+
+void MidiSharedRing::WriteCompactEvent(uint32_t writeIndex, const MidiEventInner &event, bool isShort)
+{
+    auto *dst = reinterpret_cast<uint32_t *>(ringBase_ + writeIndex);
+    if (isShort) {
+        *dst++ = static_cast<uint32_t>(event.timestamp - lastWriteTimestamp_);
+    } else {
+        *dst++ = COMPACT_LONG_BIT | static_cast<uint32_t>(event.length);
+        *dst++ = static_cast<uint32_t>(event.timestamp);
+        *dst++ = static_cast<uint32_t>(event.timestamp >> WORD_BITS);
+    }
+    lastWriteTimestamp_ = event.timestamp;
+
     const size_t payloadBytes = event.length * sizeof(uint32_t);
     CHECK_AND_RETURN_LOG(payloadBytes > 0, "copy length is zero!");
-    memcpy_s(payload, payloadBytes, reinterpret_cast<const void *>(event.data), payloadBytes);
+    memcpy_s(dst, payloadBytes, reinterpret_cast<const void *>(event.data), payloadBytes);
 }
 
 MidiStatusCode MidiSharedRing::UpdateReadIndexIfNeed(uint32_t &readIndex, uint32_t writeIndex)
@@ -609,26 +1070,13 @@ MidiStatusCode MidiSharedRing::UpdateReadIndexIfNeed(uint32_t &readIndex, uint32
     CHECK_AND_RETURN_RET_LOG(readIndex != writeIndex, MidiStatusCode::WOULD_BLOCK, "no event in ring buffer");
 
     const uint32_t tail = capacity_ - readIndex;
-    if (tail < sizeof(ShmMidiEventHeader)) {
+    if (tail < MinRecordHeaderSize()) {
         readIndex = 0;
         CHECK_AND_RETURN_RET_LOG(readIndex != writeIndex, MidiStatusCode::WOULD_BLOCK, "no event in ring buffer");
     }
     return MidiStatusCode::OK;
 }
 
-MidiStatusCode MidiSharedRing::HandleWrapIfNeeded(const ShmMidiEventHeader &header, uint32_t &readIndex)
-{
-    if ((header.flags & SHM_EVENT_FLAG_WRAP) == 0) {
-        return MidiStatusCode::WOULD_BLOCK; // no wrap
-    }
-    if (header.length != 0) {
-        return MidiStatusCode::SHM_BROKEN;
-    }
-    controler_->readPosition.store(0);
-    readIndex = 0;
-    return MidiStatusCode::OK; // wrap, continue
-}
-
 MidiStatusCode MidiSharedRing::BuildPeekedEvent(
     const ShmMidiEventHeader &header, uint32_t readIndex, PeekedEvent &outEvent)
 {
@@ -654,6 +1102,73 @@ MidiStatusCode MidiSharedRing::BuildPeekedEvent(
     return MidiStatusCode::OK;
 }
 
+MidiStatusCode MidiSharedRing::BuildCompactPeekedEvent(
+    uint32_t readIndex, uint64_t baseTimestamp, PeekedEvent &outEvent)
+{
+    const uint32_t *words = reinterpret_cast<const uint32_t *>(ringBase_ + readIndex);
+    const uint32_t tail = capacity_ - readIndex;
+    const uint32_t headerWord = words[0];
+    uint32_t headerBytes = COMPACT_HEADER_SIZE;
+    uint32_t length = 0;
+    uint64_t timestamp = 0;
+    if ((headerWord & COMPACT_LONG_BIT) != 0) {
+        headerBytes = COMPACT_LONG_HEADER_SIZE;
+        CHECK_AND_RETURN_RET(tail >= headerBytes, MidiStatusCode::SHM_BROKEN);
+        length = headerWord & COMPACT_LENGTH_MASK;
+        timestamp = static_cast<uint64_t>(words[1]) | (static_cast<uint64_t>(words[2]) << WORD_BITS);
+    } else {
+        CHECK_AND_RETURN_RET(tail >= headerBytes + sizeof(uint32_t), MidiStatusCode::SHM_BROKEN);
+        length = UMP_WORDS_BY_MT[words[1] >> UMP_MT_SHIFT];
+        timestamp = baseTimestamp + (headerWord & COMPACT_DELTA_MASK);
+    }
+    const uint64_t needed = headerBytes + static_cast<uint64_t>(length) * sizeof(uint32_t);
+    if (needed > (capacity_ - 1u) || needed > tail) {
+        return MidiStatusCode::SHM_BROKEN;
+    }
+
+    outEvent.headerPtr = nullptr;
+    outEvent.payloadPtr = ringBase_ + readIndex + headerBytes;
+    outEvent.timestamp = timestamp;
+    outEvent.length = length;
+    outEvent.beginOffset = readIndex;
+    uint32_t end = readIndex + static_cast<uint32_t>(needed);
+    outEvent.endOffset = (end == capacity_) ? 0 : end;
+    return MidiStatusCode::OK;
+}
+
+MidiStatusCode MidiSharedRing::PeekAt(uint32_t &readIndex, uint32_t writeIndex, uint64_t baseTimestamp,
+    PeekedEvent &outEvent, bool publishWrap)
+{
+    // events never straddle the wrap, a wrap marker moves the index back to 0
+    for (;;) {
+        auto ret = UpdateReadIndexIfNeed(readIndex, writeIndex);
+        if (ret != MidiStatusCode::OK) {
+            return ret;
+        }
+        if (format_ == MidiRingFormat::COMPACT) {
+            const uint32_t headerWord = *reinterpret_cast<const uint32_t *>(ringBase_ + readIndex);
+            if ((headerWord & COMPACT_WRAP_BIT) == 0) {
+                return BuildCompactPeekedEvent(readIndex, baseTimestamp, outEvent);
+            }
+            CHECK_AND_RETURN_RET(headerWord == COMPACT_WRAP_BIT, MidiStatusCode::SHM_BROKEN);
+        } else {
+            if (format_ == MidiRingFormat::MULTI_PRODUCER && !IsRecordCommitted(readIndex)) {
+                // reserved by a producer that is still writing it, everything behind waits too
+                return MidiStatusCode::WOULD_BLOCK;
+            }
+            const ShmMidiEventHeader *header = reinterpret_cast<const ShmMidiEventHeader *>(ringBase_ + readIndex);
+            if ((header->flags & SHM_EVENT_FLAG_WRAP) == 0) {
+                return BuildPeekedEvent(*header, readIndex, outEvent);
+            }
+            CHECK_AND_RETURN_RET(header->length == 0, MidiStatusCode::SHM_BROKEN);
+        }
+        if (publishWrap) {
+            ReleaseReadRange(readIndex, 0);
+        }
+        readIndex = 0;
+    }
+}
+
 MidiEvent MidiSharedRing::CopyOut(const PeekedEvent &peekedEvent, std::vector<uint32_t> &outPayloadBuffer) const
 {
     MidiEvent event{};
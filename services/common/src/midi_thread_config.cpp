@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef LOG_TAG
+#define LOG_TAG "MidiThreadTool"
+#endif
+
+#include "midi_thread_config.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "midi_log.h"
+
+namespace OHOS {
+namespace MIDI {
+namespace {
+constexpr uint32_t MAX_CPU_INDEX = 63;  // cpuMask is one 64 bit word
+
+std::string Trim(const std::string &text)
+{
+    const auto begin = text.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    const auto end = text.find_last_not_of(" \t\r\n");
+    return text.substr(begin, end - begin + 1);
+}
+
+int ToLinuxPolicy(MidiSchedPolicy policy)
+{
+    return policy == MidiSchedPolicy::RR ? SCHED_RR : SCHED_FIFO;
+}
+
+void SetNice(int32_t nice)
+{
+    const auto tid = static_cast<id_t>(::syscall(SYS_gettid));
+    if (::setpriority(PRIO_PROCESS, tid, nice) != 0) {
+        MIDI_WARNING_LOG("setpriority %{public}d failed: %{public}s", nice, strerror(errno));
+    }
+}
+
+void ApplyAffinity(uint64_t cpuMask)
+{
+    if (cpuMask == 0) {
+        return;
+    }
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    for (uint32_t cpu = 0; cpu <= MAX_CPU_INDEX; ++cpu) {
+        if ((cpuMask >> cpu) & 1u) {
+            CPU_SET(cpu, &cpuSet);
+        }
+    }
+    const int ret = ::pthread_setaffinity_np(::pthread_self(), sizeof(cpuSet), &cpuSet);
+    if (ret != 0) {
+        MIDI_WARNING_LOG("set affinity 0x%{public}llx failed: %{public}s",
+            static_cast<unsigned long long>(cpuMask), strerror(ret));
+    }
+}
+} // namespace
+
+MidiSchedPolicy MidiThreadTool::ApplyToCurrentThread(const MidiThreadConfig &config)
+{
+    ApplyAffinity(config.cpuMask);
+    if (config.policy == MidiSchedPolicy::NORMAL) {
+        return MidiSchedPolicy::NORMAL;  // keep whatever the thread inherited
+    }
+
+    const int linuxPolicy = ToLinuxPolicy(config.policy);
+    sched_param param{};
+    param.sched_priority = std::clamp(config.priority, ::sched_get_priority_min(linuxPolicy),
+        ::sched_get_priority_max(linuxPolicy));
+    const int ret = ::pthread_setschedparam(::pthread_self(), linuxPolicy, &param);
+    if (ret == 0) {
+        MIDI_INFO_LOG("policy %{public}u priority %{public}d applied", static_cast<uint32_t>(config.policy),
+            param.sched_priority);
+        return config.policy;
+    }
+    MIDI_WARNING_LOG("policy %{public}u priority %{public}d refused: %{public}s, fall back to nice %{public}d",
+        static_cast<uint32_t>(config.policy), param.sched_priority, strerror(ret), MIDI_RT_FALLBACK_NICE);
+    SetNice(MIDI_RT_FALLBACK_NICE);
+    return MidiSchedPolicy::NORMAL;
+}
+
+std::map<std::string, std::string> MidiThreadTool::ReadConfigFile(const std::string &path)
+{
+    std::map<std::string, std::string> values;
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        MIDI_INFO_LOG("no config at %{public}s", path.c_str());
+        return values;
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        line = Trim(line.substr(0, line.find('#')));
+        const auto separator = line.find('=');
+        if (line.empty() || separator == std::string::npos) {
+            continue;
+        }
+        values[Trim(line.substr(0, separator))] = Trim(line.substr(separator + 1));
+    }
+    return values;
+}
+
+bool MidiThreadTool::ParseUint(const std::string &text, uint32_t &value)
+{
+    if (text.empty() || text.size() > 9 || !std::all_of(text.begin(), text.end(), ::isdigit)) { // 9: fits uint32
+        return false;
+    }
+    value = static_cast<uint32_t>(std::stoul(text));
+    return true;
+}
+
+bool MidiThreadTool::ParseCpuSet(const std::string &text, uint64_t &cpuMask)
+{
+    uint64_t mask = 0;
+    size_t begin = 0;
+    while (begin <= text.size()) {
+        size_t end = text.find(',', begin);
+        if (end == std::string::npos) {
+            end = text.size();
+        }
+        const std::string item = Trim(text.substr(begin, end - begin));
+        const auto dash = item.find('-');
+        uint32_t first = 0;
+        uint32_t last = 0;
+        bool ok = (dash == std::string::npos) ? (ParseUint(item, first) && ParseUint(item, last)) :
+            (ParseUint(Trim(item.substr(0, dash)), first) && ParseUint(Trim(item.substr(dash + 1)), last));
+        CHECK_AND_RETURN_RET_LOG(ok && first <= last && last <= MAX_CPU_INDEX, false,
+            "invalid cpu set %{public}s", text.c_str());
+        for (uint32_t cpu = first; cpu <= last; ++cpu) {
+            mask |= 1ull << cpu;
+        }
+        begin = end + 1;
+    }
+    cpuMask = mask;
+    return true;
+}
+
+bool MidiThreadTool::ParseThreadConfig(const std::map<std::string, std::string> &values, const std::string &prefix,
+    MidiThreadConfig &config)
+{
+    MidiThreadConfig parsed = config;
+    auto it = values.find(prefix + "sched_policy");
+    if (it != values.end()) {
+        static const std::map<std::string, MidiSchedPolicy> policies = {
+            {"normal", MidiSchedPolicy::NORMAL}, {"fifo", MidiSchedPolicy::FIFO}, {"rr", MidiSchedPolicy::RR}};
+        auto policy = policies.find(it->second);
+        CHECK_AND_RETURN_RET_LOG(policy != policies.end(), false, "invalid policy %{public}s", it->second.c_str());
+        parsed.policy = policy->second;
+    }
+    it = values.find(prefix + "sched_priority");
+    if (it != values.end()) {
+        uint32_t priority = 0;
+        CHECK_AND_RETURN_RET_LOG(ParseUint(it->second, priority), false, "invalid priority %{public}s",
+            it->second.c_str());
+        parsed.priority = static_cast<int32_t>(priority);
+    }
+    it = values.find(prefix + "cpu_set");
+    if (it != values.end() && !it->second.empty()) {
+        CHECK_AND_RETURN_RET(ParseCpuSet(it->second, parsed.cpuMask), false);
+    }
+    it = values.find(prefix + "lock_memory");
+    if (it != values.end()) {
+        CHECK_AND_RETURN_RET_LOG(it->second == "true" || it->second == "false", false,
+            "invalid lock_memory %{public}s", it->second.c_str());
+        parsed.lockMemory = (it->second == "true");
+    }
+    config = parsed;
+    return true;
+}
+} // namespace MIDI
+} // namespace OHOS
@@ -18,64 +18,88 @@
 
 #include <vector>
 #include <chrono>
-#include <queue>
 
 #include "midi_shared_ring.h"
+#include "midi_statistics.h"
+#include "midi_timer_wheel.h"
 namespace OHOS {
 namespace MIDI {
 
 namespace {
     const uint32_t DEFAULT_RING_BUFFER_SIZE = 2048;
+    // server side policy for client requested ring sizes, in bytes
+    const uint32_t MIN_RING_BUFFER_SIZE = 256;
+    const uint32_t MAX_RING_BUFFER_SIZE = 32768;
+    // scheduled events kept per client, slots are only allocated as the lookahead grows
+    const size_t DEFAULT_MAX_PENDING = 65536;
 }
 
 
 class ClientConnectionInServer {
 public:
+    // view of a scheduled event, data stays valid until the next EnqueueNonRealtime or ClearPending
     struct PendingEvent {
         std::chrono::steady_clock::time_point due;
-        std::vector<uint32_t> data;
         uint64_t timestamp = 0;
-    };
-    struct PendingGreater {
-        bool operator()(const PendingEvent& a, const PendingEvent& b) const
-        {
-            return a.due > b.due;
-        }
+        uint32_t length = 0;
+        const uint32_t *data = nullptr;
     };
 
 public:
-    ClientConnectionInServer(uint32_t clientId, int64_t handle, uint32_t portIndex)
-        : clientId_(clientId), deviceHandle_(handle), portIndex_(portIndex) {}
+    ClientConnectionInServer(uint32_t clientId, int64_t handle, uint32_t portIndex, uint32_t lane = 0)
+        : clientId_(clientId), deviceHandle_(handle), portIndex_(portIndex), lane_(lane) {}
     ~ClientConnectionInServer() = default;
 
-    int32_t CreateRingBuffer(int fd = -1);
+    int32_t CreateRingBuffer(int fd = -1, uint32_t requestedSize = 0, MidiRingFormat format = MidiRingFormat::STANDARD);
+    static uint32_t ResolveRingBufferSize(uint32_t requestedSize);
 
     int64_t GetDeviceHandle() const { return deviceHandle_; }
     uint32_t GetClientId() const { return clientId_; }
     int64_t GetPortIndex() const { return portIndex_; }
+    // 0 for the ring opened with the port, 1.. for extra output lanes of the same client
+    uint32_t GetLane() const { return lane_; }
 
     std::shared_ptr<MidiSharedRing> GetRingBuffer();
 
+    // a full ring drops the event and fails the call; the next event that fits is preceded by an overflow
+    // marker carrying the number of events lost, so the client learns about the gap without any IPC
     int32_t TrySendToClient(const MidiEventInner& event);
+    // writes the longest prefix of events that fits with a single publish and wake, drops the rest the same way;
+    // returns how many events were written
+    uint32_t TrySendBatchToClient(const MidiEventInner *events, uint32_t eventCount);
+
+    MidiClientCounters &GetCounters() { return counters_; }
+    const MidiClientCounters &GetCounters() const { return counters_; }
 
-    void SetMaxPending(size_t maxPending) { maxPending_ = maxPending; }
-    bool IsPendingFull() const { return pending_.size() >= maxPending_; }
-    bool HasPending() const { return !pending_.empty(); }
-    bool EnqueueNonRealtime(std::vector<uint32_t>&& payloadWords,
-                            std::chrono::steady_clock::time_point dueTime,
-                            uint64_t timestamp);
-    const PendingEvent* PeekPendingTop() const;
-    bool PopPendingTop(PendingEvent& out);
+    void SetMaxPending(size_t maxPending) { pending_.SetMaxSlots(maxPending); }
+    bool IsPendingFull() const { return pending_.Full(); }
+    bool HasPending() const { return !pending_.Empty(); }
+    size_t PendingCount() const { return pending_.Size(); }
+    bool EnqueueNonRealtime(const uint32_t *payloadWords, uint32_t payloadWordCount,
+                            std::chrono::steady_clock::time_point dueTime, uint64_t timestamp);
+    // earliest scheduled event, nullptr when none
+    const PendingEvent *PeekPendingTop();
+    bool PopPendingTop(PendingEvent &out);
+    // drops every scheduled event of this client, returns how many were dropped
+    size_t ClearPending();
+
+    // input lost upstream of this client, reported through the same overflow marker as a full client ring
+    void RecordUpstreamDrops(uint32_t count);
 
 private:
+    void RecordDrops(uint32_t count);
+
     uint32_t clientId_ = 0;
     int64_t deviceHandle_ = -1;
     uint32_t portIndex_ = -1;
+    uint32_t lane_ = 0;
 
     std::shared_ptr<MidiSharedRing> sharedRingBuffer_ = nullptr;
 
-    size_t maxPending_ = 1024;
-    std::priority_queue<PendingEvent, std::vector<PendingEvent>, PendingGreater> pending_;
+    MidiTimerWheel pending_{DEFAULT_MAX_PENDING};
+    PendingEvent top_;
+    MidiClientCounters counters_;
+    uint32_t unreportedDrops_ = 0;  // dropped since the last overflow marker
 };
 } // namespace MIDI
 } // namespace OHOS
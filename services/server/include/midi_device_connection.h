@@ -16,12 +16,16 @@
 #ifndef MIDI_DEVICE_CONNECTION_H
 #define MIDI_DEVICE_CONNECTION_H
 
+#include <atomic>
+#include <chrono>
+#include <map>
 #include <vector>
 #include <memory>
-#include <thread>
 
 #include "midi_device_driver.h"
 #include "midi_client_connection.h"
+#include "midi_histogram.h"
+#include "midi_statistics.h"
 
 namespace OHOS {
 namespace MIDI {
@@ -29,6 +33,9 @@ namespace {
 static constexpr size_t MAX_PENDING_EVENTS = 4096;
 }
 
+// reads an eventfd/timerfd until it would block
+void DrainCounterFd(int fd);
+
 enum class MidiPortDirection : uint32_t { INPUT = 0, OUTPUT = 1 };
 
 struct DeviceConnectionInfo {
@@ -38,6 +45,14 @@ struct DeviceConnectionInfo {
     uint32_t portIndex;
 };
 
+// hot path histograms of one port, each has a single writer: the thread driving the port
+struct MidiPortHistograms {
+    MidiHistogram lateness;       // output: ns a scheduled event reached the driver after its timestamp
+    MidiHistogram sendDuration;   // output: ns spent in one driver send
+    MidiHistogram deliveryDelay;  // input: ns from the driver timestamp to the write into the client rings
+    MidiHistogram batchSize;      // events per driver send (output) or per driver callback (input)
+};
+
 class DeviceConnectionBase {
 public:
     explicit DeviceConnectionBase(DeviceConnectionInfo info);
@@ -49,18 +64,44 @@ public:
     const DeviceConnectionInfo &GetInfo() const { return info_; }
 
     virtual int32_t AddClientConnection(uint32_t clientId, int64_t deviceHandle,
-                                        std::shared_ptr<MidiSharedRing> &buffer);
+                                        std::shared_ptr<MidiSharedRing> &buffer, uint32_t bufferSize = 0,
+                                        MidiRingFormat format = MidiRingFormat::STANDARD);
     virtual void RemoveClientConnection(uint32_t clientId);
     virtual bool IsEmptyClientConections();
     virtual bool HasClientConnection(uint32_t clientId) const;
+    // one per lane, an output client may hold several rings on the same port
+    size_t CountClientConnections(uint32_t clientId) const;
+
+    const MidiPortHistograms &GetHistograms() const { return histograms_; }
+    const MidiPortCounters &GetCounters() const { return counters_; }
+    // appends one line per non-empty histogram
+    void DumpHistograms(std::string &dump) const;
+    // port counters, one line per client, then the histograms
+    void Dump(std::string &dump) const;
+    // only the lines of clientId, nothing about the port or other clients
+    void DumpClient(uint32_t clientId, std::string &dump) const;
 
 protected:
-    std::vector<std::shared_ptr<ClientConnectionInServer>> SnapshotClients() const;
+    static void DumpClientLine(const ClientConnectionInServer &client, std::string &dump);
+    // called on a new client's ring before it is published to the data path
+    virtual void ConfigureClientRing(MidiSharedRing &ring) { (void)ring; }
+
+    // published client lists are immutable, a change builds a new list and swaps it in under clientsMutex_
+    using ClientList = std::vector<std::shared_ptr<ClientConnectionInServer>>;
+
+    std::shared_ptr<const ClientList> SnapshotClients() const;
+    // hot path read: only goes back to clients_ when clientsVersion_ moved, otherwise no lock and no allocation
+    void RefreshClients(std::shared_ptr<const ClientList> &cache, uint64_t &cacheVersion) const;
+    // caller holds clientsMutex_
+    void PublishClients(std::shared_ptr<const ClientList> clients);
 
 protected:
     DeviceConnectionInfo info_;
-    mutable std::mutex clientsMutex_;
-    std::vector<std::shared_ptr<ClientConnectionInServer>> clients_;
+    mutable std::mutex clientsMutex_;  // serialises writers of clients_ and the rare reader refresh
+    std::shared_ptr<const ClientList> clients_ = std::make_shared<const ClientList>();
+    std::atomic<uint64_t> clientsVersion_{0};  // bumped under clientsMutex_ whenever clients_ changes
+    MidiPortHistograms histograms_;
+    MidiPortCounters counters_;
 };
 
 class DeviceConnectionForInput final : public DeviceConnectionBase {
@@ -70,8 +111,27 @@ public:
 
     void HandleDeviceUmpInput(std::vector<MidiEventInner> &events);
 
+    /**
+     * Keys: input_wake_threshold and input_wake_budget_us, see MidiSharedRing::SetWakeCoalescing. Applies to
+     * client rings created afterwards, a 0 for either wakes the client on every driver callback.
+     */
+    static void LoadWakeConfig(const std::map<std::string, std::string> &values);
+    static void SetWakeCoalescing(uint32_t eventThreshold, uint32_t budgetUs);
+
+protected:
+    void ConfigureClientRing(MidiSharedRing &ring) override;
+
 private:
-    void BroadcastToClients(const MidiEventInner &ev);
+    // removes overflow markers an HDI input ring left in the batch and passes the gap on to every client
+    void TakeDriverOverflowMarkers(std::vector<MidiEventInner> &events);
+    void BroadcastToClients(const std::vector<MidiEventInner> &events, uint64_t batchBytes);
+
+    // driver callback side copy of clients_, the driver delivers one port's input on one thread
+    std::shared_ptr<const ClientList> inputClients_;
+    uint64_t inputClientsVersion_ = 0;
+
+    static inline std::atomic<uint32_t> wakeThreshold_{0};
+    static inline std::atomic<uint32_t> wakeBudgetUs_{0};
 };
 
 class DeviceConnectionForOutput final : public DeviceConnectionBase {
@@ -79,25 +139,34 @@ public:
     explicit DeviceConnectionForOutput(DeviceConnectionInfo info);
     ~DeviceConnectionForOutput() override;
 
-    // to manage the thread
+    // attach to / detach from a MidiOutputWorkerPool worker, Stop returns once the worker no longer runs this port
     int32_t Start();
     int32_t Stop();
 
+    // called by the owning worker when the notify eventfd or the timer fires
+    void RunOnce();
+    // earliest scheduled due over all clients, false when nothing is scheduled
+    bool GetNextDueTime(std::chrono::steady_clock::time_point &due) const;
+    // called by the owning worker before it sleeps: arms the client eventfd wakes, false when a ring has data that
+    // can be drained now; a client whose timer wheel is full waits for the timer instead
+    bool PrepareToPark();
+
     int GetNotifyEventFdForClients() const;
     int32_t AddClientConnection(uint32_t clientId, int64_t deviceHandle,
-                                        std::shared_ptr<MidiSharedRing> &buffer) override;
+                                        std::shared_ptr<MidiSharedRing> &buffer, uint32_t bufferSize = 0,
+                                        MidiRingFormat format = MidiRingFormat::STANDARD) override;
 
     // todo: maybe not needed
     void SetPerClientMaxPendingEvents(size_t maxPendingEvents);
+    // flushes what is cached, then resizes the payload arena
     void SetMaxSendCacheBytes(size_t maxSendCacheBytes);
     
 private:
-    // worker loop
-    void ThreadMain();
     void HandleWakeupOnce();
 
     void DrainAllClientsRings();
     void DrainSingleClientRing(ClientConnectionInServer &clientConnection);
+    void HandleClientFlush(ClientConnectionInServer &clientConnection, MidiSharedRing &clientRing);
     bool ConsumeRealtimeEvent(MidiSharedRing &clientRing, const MidiSharedRing::PeekedEvent &ringEvent);
     bool ConsumeNonRealtimeEvent(ClientConnectionInServer &clientConnection, MidiSharedRing &clientRing,
                                  const MidiSharedRing::PeekedEvent &ringEvent);
@@ -108,12 +177,14 @@ private:
     // Step3：flush cache -> driver
     void FlushSendCacheToDriver();
 
-    // Step4：timerfd set earliest due
-    void UpdateNextTimer();
+    // Step4：publish the earliest due for the worker timer
+    void UpdateNextDue();
 
-    std::shared_ptr<ClientConnectionInServer>
-    FindClientWithEarliestDue(const std::vector<std::shared_ptr<ClientConnectionInServer>> &clientsSnapshot,
-                              std::chrono::steady_clock::time_point &outEarliestDueTime);
+    // worker side copy of clients_
+    void RefreshClientsSnapshot();
+    // port level min-heap over each client's earliest scheduled event
+    void RebuildDueHeap();
+    void PushClientHead(ClientConnectionInServer *clientConnection);
 
     // send cache helper
     bool TryAppendToSendCache(uint64_t timestamp,
@@ -121,32 +192,37 @@ private:
                               size_t payloadWordCount);
     void SendToDriver(MidiEventInner event);
 
-    // fd/epoll helper
-    int32_t InitEpollAndFds();
     void DrainEventFd();
-    void DrainTimerFd();
-    void WakeWorkerByEventFd();
 
     struct SendItem {
         std::vector<uint8_t> data;
     };
 
+    struct ClientHead {
+        std::chrono::steady_clock::time_point due;
+        ClientConnectionInServer *client;  // owned by clientsSnapshot_
+    };
+    struct ClientHeadLater {
+        bool operator()(const ClientHead &a, const ClientHead &b) const { return a.due > b.due; }
+    };
+
     std::atomic<bool> running_{false};
-    std::thread worker_;
 
-    UniqueFd notifyEventFd_; // eventfd: clients -> server notify
-    UniqueFd epollFd_;       // epoll: wait eventfd + timerfd
-    UniqueFd timerFd_;       // timerfd: pending earliest due
+    UniqueFd notifyEventFd_; // eventfd: clients -> server notify, polled by the owning worker
+    bool hasNextDue_ = false;
+    std::chrono::steady_clock::time_point nextDue_{};
 
     size_t maxSendCacheBytes_ = 64 * 1024;
-    size_t currentSendCacheBytes_ = 0;
-    std::vector<MidiEventInner> sendCache_;
-    std::vector<std::vector<uint32_t>> sendCachePayloadBuffers_; // for payload
+    size_t currentSendCacheBytes_ = 0;  // also the bump offset into sendCacheWords_, reset by each flush
+    std::vector<MidiEventInner> sendCache_;  // data points into sendCacheWords_
+    // payload arena of the send cache, sized once to maxSendCacheBytes_ so appends never reallocate
+    std::vector<uint32_t> sendCacheWords_;
 
     size_t perClientMaxPendingEvents_ = 1024;
 
-    static constexpr uint64_t kEpollTagNotifyEventFd = 1;
-    static constexpr uint64_t kEpollTagTimerFd = 2;
+    std::shared_ptr<const ClientList> clientsSnapshot_;
+    uint64_t clientsSnapshotVersion_ = 0;
+    std::vector<ClientHead> dueHeap_;
 };
 } // namespace MIDI
 } // namespace OHOS
@@ -16,9 +16,14 @@
 #ifndef MIDI_DEVICE_USB_H
 #define MIDI_DEVICE_USB_H
 
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
 #include <vector>
 #include "midi_info.h"
 #include "midi_device_driver.h"
+#include "midi_hdi_input_ring.h"
 #include "v1_0/imidi_interface.h"
 
 namespace OHOS {
@@ -57,8 +62,18 @@ public:
 
     int32_t HanleUmpInput(int64_t deviceId, uint32_t portIndex, std::vector<MidiEventInner> &list) override;
 
+    // an HDI that can write input into shared memory; input ports opened afterwards skip the per-burst callback.
+    // nullptr, the default, keeps IMidiCallback delivery
+    void SetSharedInput(std::shared_ptr<MidiHdiSharedInput> sharedInput);
+
 private:
+    int32_t OpenInputRing(int64_t deviceId, uint32_t portIndex, UmpInputCallback cb);
+
     sptr<HDI::Midi::V1_0::IMidiInterface> midiHdi_ = nullptr;
+    std::shared_ptr<MidiHdiSharedInput> sharedInput_ = nullptr;
+    std::mutex inputRingsMutex_;
+    // input ports opened in ring mode, keyed by device id and port index
+    std::map<std::pair<int64_t, uint32_t>, std::unique_ptr<MidiHdiInputRingReader>> inputRings_;
 };
 } // namespace MIDI
 } // namespace OHOS
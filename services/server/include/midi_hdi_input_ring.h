@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MIDI_HDI_INPUT_RING_H
+#define MIDI_HDI_INPUT_RING_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "midi_device_driver.h"
+#include "midi_shared_ring.h"
+#include "midi_thread_config.h"
+
+namespace OHOS {
+namespace MIDI {
+
+/**
+ * Optional HDI capability: input of a port is written into a MidiSharedRing created by the HDI instead of being
+ * delivered through IMidiCallback once per burst. The ring is a single producer ring written by the HDI only;
+ * writes wake the consumer through the ring futex, so the steady state needs no IPC at all. Input lost on a full
+ * ring is reported with an overflow marker ahead of the next write, the way the service reports it to clients.
+ */
+class MidiHdiSharedInput {
+public:
+    virtual ~MidiHdiSharedInput() = default;
+    // opens the port in ring mode, the HDI keeps writing the returned ring until CloseInputRing
+    virtual int32_t OpenInputRing(int64_t deviceId, uint32_t portId, std::shared_ptr<MidiSharedRing> &ring) = 0;
+    virtual int32_t CloseInputRing(int64_t deviceId, uint32_t portId) = 0;
+};
+
+// service side consumer of one HDI input ring: parks on the ring futex and hands every batch to the port callback
+class MidiHdiInputRingReader {
+public:
+    MidiHdiInputRingReader(std::shared_ptr<MidiSharedRing> ring, UmpInputCallback callback,
+        const MidiThreadConfig &threadConfig = {});
+    ~MidiHdiInputRingReader();
+    MidiHdiInputRingReader(const MidiHdiInputRingReader &) = delete;
+    MidiHdiInputRingReader &operator=(const MidiHdiInputRingReader &) = delete;
+
+    int32_t Start();
+    // returns once the reader thread exited, events still in the ring are dropped with it
+    void Stop();
+
+private:
+    void ReaderLoop();
+    bool HasDataOrExit();
+    void DrainOnce();
+
+    std::shared_ptr<MidiSharedRing> ring_;
+    UmpInputCallback callback_;
+    MidiThreadConfig threadConfig_;
+    std::atomic<bool> running_{false};
+    std::thread readerThread_;
+    std::vector<OH_MIDIEvent> views_;       // into ring_, valid until CommitBatch
+    std::vector<MidiEventInner> events_;    // same views handed to callback_, reused by every batch
+};
+} // namespace MIDI
+} // namespace OHOS
+#endif
@@ -29,11 +29,16 @@ public:
     int32_t OpenDevice(int64_t deviceId) override;
     int32_t OpenBleDevice(const std::string &address, const sptr<IRemoteObject> &object) override;
     int32_t CloseDevice(int64_t deviceId) override;
-    int32_t OpenInputPort(std::shared_ptr<MidiSharedRing> &buffer, int64_t deviceId, uint32_t portIndex) override;
-    int32_t OpenOutputPort(std::shared_ptr<MidiSharedRing> &buffer, int64_t deviceId, uint32_t portIndex) override;
+    int32_t OpenInputPort(std::shared_ptr<MidiSharedRing> &buffer, int64_t deviceId, uint32_t portIndex,
+        uint32_t bufferSize) override;
+    int32_t OpenOutputPort(std::shared_ptr<MidiSharedRing> &buffer, int64_t deviceId, uint32_t portIndex,
+        uint32_t bufferSize, bool multiProducer) override;
     int32_t CloseInputPort(int64_t deviceId, uint32_t portIndex) override;
     int32_t CloseOutputPort(int64_t deviceId, uint32_t portIndex) override;
     int32_t DestroyMidiClient() override;
+    int32_t GetStatistics(std::string &statistics) override;
+    int32_t OpenOutputLane(std::shared_ptr<MidiSharedRing> &buffer, int64_t deviceId, uint32_t portIndex,
+        uint32_t bufferSize) override;
     void NotifyDeviceChange(DeviceChangeType change, std::map<int32_t, std::string> deviceInfo);
     void NotifyError(int32_t code);
 
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MIDI_OUTPUT_WORKER_POOL_H
+#define MIDI_OUTPUT_WORKER_POOL_H
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "midi_thread_config.h"
+#include "midi_utils.h"
+
+namespace OHOS {
+namespace MIDI {
+namespace {
+constexpr uint32_t DEFAULT_OUTPUT_WORKER_COUNT = 2;
+constexpr uint32_t MAX_OUTPUT_WORKER_COUNT = 16;
+constexpr int64_t DEFAULT_DEADLINE_LEAD_NS = 200000;  // covers timerfd wakeup and epoll dispatch
+constexpr int64_t MAX_DEADLINE_LEAD_NS = 5000000;
+constexpr uint64_t DEFAULT_TIMER_SLACK_NS = 1000;
+}
+
+// how a worker closes the gap between its early timer wakeup and the exact due time
+enum class MidiDeadlineMode : uint32_t {
+    NONE = 0,   // timer armed at the due time itself, no lead
+    SLEEP = 1,  // clock_nanosleep to the due time
+    SPIN = 2,   // busy wait to the due time, lowest lateness, burns up to leadNs of cpu per wakeup
+};
+
+struct MidiDeadlineConfig {
+    MidiDeadlineMode mode = MidiDeadlineMode::SLEEP;
+    int64_t leadNs = DEFAULT_DEADLINE_LEAD_NS;
+    uint64_t timerSlackNs = DEFAULT_TIMER_SLACK_NS;  // PR_SET_TIMERSLACK of the worker, 0 keeps the default
+};
+
+class DeviceConnectionForOutput;
+
+struct MidiOutputWorkerStats {
+    uint32_t workerIndex = 0;
+    uint32_t portCount = 0;
+    uint64_t wakeups = 0;   // epoll returns
+    uint64_t portRuns = 0;  // DeviceConnectionForOutput::RunOnce calls
+    uint64_t busyNs = 0;    // time spent outside epoll_wait
+};
+
+// one scheduler thread: a single epoll over the notify eventfds of its ports plus one shared timerfd
+class MidiOutputWorker {
+public:
+    MidiOutputWorker(uint32_t index, const MidiThreadConfig &threadConfig, const MidiDeadlineConfig &deadlineConfig);
+    ~MidiOutputWorker();
+    MidiOutputWorker(const MidiOutputWorker &) = delete;
+    MidiOutputWorker &operator=(const MidiOutputWorker &) = delete;
+
+    int32_t Start();
+    void Stop();
+    int32_t Attach(DeviceConnectionForOutput *port);
+    // returns once the port is no longer running on this worker
+    void Detach(DeviceConnectionForOutput *port);
+    uint32_t GetPortCount() const { return portCount_.load(std::memory_order_relaxed); }
+    MidiOutputWorkerStats GetStats() const;
+
+private:
+    struct PortEntry {
+        DeviceConnectionForOutput *port;
+        bool ready;
+    };
+
+    void ThreadMain();
+    // arms the client wakes of every port, false when some port must run before the worker may sleep
+    bool PrepareToPark();
+    void MarkReady(uint64_t tag, bool &timerFired);
+    void RunReadyPorts(bool timerFired);
+    void RearmTimer();
+    void WaitForArmedDeadline();
+    void Wake();
+
+    uint32_t index_;
+    MidiThreadConfig threadConfig_;
+    MidiDeadlineConfig deadlineConfig_;
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+    UniqueFd epollFd_;
+    UniqueFd timerFd_;  // earliest due over all ports of this worker
+    UniqueFd wakeFd_;   // stop requests
+
+    std::mutex portsMutex_;  // held while ports run, so Detach waits for the current run
+    std::vector<PortEntry> ports_;
+    bool hasArmedDue_ = false;
+    int64_t armedDueNs_ = 0;  // CLOCK_MONOTONIC due the timer was armed for, guarded by portsMutex_
+
+    std::atomic<uint32_t> portCount_{0};
+    std::atomic<uint64_t> wakeups_{0};
+    std::atomic<uint64_t> portRuns_{0};
+    std::atomic<uint64_t> busyNs_{0};
+
+    static constexpr uint64_t kEpollTagWakeFd = 1;
+    static constexpr uint64_t kEpollTagTimerFd = 2;
+};
+
+/**
+ * Output ports share a small set of MidiOutputWorker threads instead of one thread each. A port is pinned to
+ * the least loaded worker when it starts and stays there, which keeps its events in order. Workers are created
+ * on demand up to the configured count and live for the rest of the process.
+ */
+class MidiOutputWorkerPool {
+public:
+    static MidiOutputWorkerPool &GetInstance();
+
+    /**
+     * Keys: output_worker_count, the output_* thread keys of MidiThreadTool::ParseThreadConfig,
+     * output_deadline_mode (none|sleep|spin), output_deadline_lead_us and output_timer_slack_ns.
+     */
+    void LoadConfig(const std::map<std::string, std::string> &values);
+    // the setters apply to workers created afterwards, existing workers keep their ports and settings
+    void SetWorkerCount(uint32_t workerCount);
+    uint32_t GetWorkerCount() const;
+    void SetThreadConfig(const MidiThreadConfig &threadConfig);
+    MidiThreadConfig GetThreadConfig() const;
+    void SetDeadlineConfig(const MidiDeadlineConfig &deadlineConfig);
+    MidiDeadlineConfig GetDeadlineConfig() const;
+    int32_t Attach(DeviceConnectionForOutput *port);
+    void Detach(DeviceConnectionForOutput *port);
+    std::vector<MidiOutputWorkerStats> GetStats() const;
+
+private:
+    MidiOutputWorkerPool() = default;
+    MidiOutputWorker *PickWorker();
+    void LoadDeadlineConfig(const std::map<std::string, std::string> &values);
+
+    mutable std::mutex mutex_;
+    uint32_t workerCount_ = DEFAULT_OUTPUT_WORKER_COUNT;
+    MidiThreadConfig threadConfig_;
+    MidiDeadlineConfig deadlineConfig_;
+    std::vector<std::unique_ptr<MidiOutputWorker>> workers_;
+    std::vector<std::pair<DeviceConnectionForOutput *, MidiOutputWorker *>> assignments_;
+};
+} // namespace MIDI
+} // namespace OHOS
+#endif
@@ -33,6 +33,7 @@ public:
     explicit MidiServer(int32_t systemAbilityId, bool runOnCreate = true);
     virtual ~MidiServer() = default;
     void OnDump() override;
+    int32_t Dump(int32_t fd, const std::vector<std::u16string> &args) override;
     void OnStart() override;
     int32_t CreateMidiInServer(const sptr<IRemoteObject> &object, sptr<IRemoteObject> &client,
                                  uint32_t &clientId) override;
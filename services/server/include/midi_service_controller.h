@@ -63,15 +63,22 @@ public:
     int32_t OpenDevice(uint32_t clientId, int64_t deviceId);
     int32_t OpenBleDevice(uint32_t clientId, const std::string &address, const sptr<IRemoteObject> &callbackObj);
     int32_t CloseDevice(uint32_t clientId, int64_t deviceId);
-    int32_t OpenInputPort(
-        uint32_t clientId, std::shared_ptr<MidiSharedRing> &buffer, int64_t deviceId, uint32_t portIndex);
-    int32_t OpenOutputPort(
-        uint32_t clientId, std::shared_ptr<MidiSharedRing> &buffer, int64_t deviceId, uint32_t portIndex);
+    int32_t OpenInputPort(uint32_t clientId, std::shared_ptr<MidiSharedRing> &buffer, int64_t deviceId,
+        uint32_t portIndex, uint32_t bufferSize = 0);
+    int32_t OpenOutputPort(uint32_t clientId, std::shared_ptr<MidiSharedRing> &buffer, int64_t deviceId,
+        uint32_t portIndex, uint32_t bufferSize = 0, bool multiProducer = false);
+    // another single producer ring of a client that already opened the output port, merged by timestamp
+    int32_t OpenOutputLane(uint32_t clientId, std::shared_ptr<MidiSharedRing> &buffer, int64_t deviceId,
+        uint32_t portIndex, uint32_t bufferSize = 0);
     int32_t CloseInputPort(uint32_t clientId, int64_t deviceId, uint32_t portIndex);
     int32_t CloseOutputPort(uint32_t clientId, int64_t deviceId, uint32_t portIndex);
     int32_t DestroyMidiClient(uint32_t clientId);
     void NotifyDeviceChange(DeviceChangeType change, DeviceInformation device);
     void NotifyError(int32_t code);
+    // per device/port/client counters, hot path histograms and output worker counters, for hidumper
+    void Dump(std::string &dump);
+    // the counters of clientId's own connections only, for IIpcMidiInServer::GetStatistics
+    void DumpClient(uint32_t clientId, std::string &dump);
 
 private:
     void ClosePortforDevice(
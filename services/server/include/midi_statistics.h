@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MIDI_STATISTICS_H
+#define MIDI_STATISTICS_H
+
+#include <atomic>
+#include <cstdint>
+
+#include "midi_shared_ring.h"
+
+namespace OHOS {
+namespace MIDI {
+
+// one counter per cache line, so counters bumped by different threads never share a line
+struct alignas(MIDI_CACHE_LINE_SIZE) MidiPaddedCounter {
+    std::atomic<uint64_t> value{0};
+
+    void Add(uint64_t delta) { value.fetch_add(delta, std::memory_order_relaxed); }
+    void UpdateMax(uint64_t candidate)
+    {
+        uint64_t current = value.load(std::memory_order_relaxed);
+        while (candidate > current && !value.compare_exchange_weak(current, candidate, std::memory_order_relaxed)) {
+        }
+    }
+    uint64_t Load() const { return value.load(std::memory_order_relaxed); }
+};
+
+// one client on one port
+struct MidiClientCounters {
+    MidiPaddedCounter events;            // input: written to the client ring, output: drained from it
+    MidiPaddedCounter bytes;
+    MidiPaddedCounter wouldBlockDrops;   // input: lost because the client ring was full
+    MidiPaddedCounter ringHighWater;     // most ring bytes in use seen
+    MidiPaddedCounter pendingHighWater;  // output: most scheduled events queued at once
+};
+
+struct MidiPortCounters {
+    MidiPaddedCounter eventsIn;      // from the driver (input) or the client rings (output)
+    MidiPaddedCounter eventsOut;     // into client rings (input) or to the driver (output)
+    MidiPaddedCounter bytesIn;
+    MidiPaddedCounter bytesOut;
+    MidiPaddedCounter driverErrors;  // output: failed driver sends
+    MidiPaddedCounter driverDrops;   // input: lost by the HDI before reaching the service, from its overflow markers
+};
+} // namespace MIDI
+} // namespace OHOS
+#endif
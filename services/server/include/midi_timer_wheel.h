@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MIDI_TIMER_WHEEL_H
+#define MIDI_TIMER_WHEEL_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace OHOS {
+namespace MIDI {
+
+/**
+ * Hierarchical timing wheel for scheduled output events.
+ *
+ * Four levels of 64 buckets over a 65.536us tick cover ~18 minutes, later events park in the last level and
+ * are re-filed when it cascades. Every event lives in a fixed-size slot taken from a slab that grows page by
+ * page and is never returned, so steady-state scheduling does not allocate. Insert is O(1) for events that
+ * arrive in due order (the common sequencer case), expiry is O(1) per event plus one cascade per level wrap.
+ * Events stay ordered by due time, ties keep scheduling order even when one of them was cascaded from a higher
+ * level and the other filed straight into its bucket.
+ */
+class MidiTimerWheel {
+public:
+    static constexpr uint32_t INLINE_WORDS = 4;  // one UMP packet, longer payloads spill to a per-slot vector
+    static constexpr uint32_t INVALID_SLOT = UINT32_MAX;
+
+    struct Slot {
+        uint64_t dueNs = 0;
+        uint64_t seq = 0;  // scheduling order, breaks dueNs ties
+        uint64_t timestamp = 0;
+        uint32_t length = 0;
+        uint32_t prev = INVALID_SLOT;
+        uint32_t next = INVALID_SLOT;
+        std::array<uint32_t, INLINE_WORDS> words{};
+        std::vector<uint32_t> spill;  // capacity is kept when the slot is recycled
+
+        const uint32_t *Data() const { return length <= INLINE_WORDS ? words.data() : spill.data(); }
+    };
+
+    explicit MidiTimerWheel(size_t maxSlots);
+    ~MidiTimerWheel() = default;
+    MidiTimerWheel(const MidiTimerWheel &) = delete;
+    MidiTimerWheel &operator=(const MidiTimerWheel &) = delete;
+
+    // false when maxSlots events are already scheduled
+    bool Schedule(uint64_t dueNs, uint64_t timestamp, const uint32_t *words, uint32_t length);
+    // earliest event, nullptr when empty. May move the wheel cursor forward, which never reorders events
+    const Slot *Front();
+    // releases the slot returned by Front(); its data stays readable until the next Schedule
+    void PopFront();
+    void Clear();
+
+    size_t Size() const { return size_; }
+    bool Empty() const { return size_ == 0; }
+    bool Full() const { return size_ >= maxSlots_; }
+    void SetMaxSlots(size_t maxSlots) { maxSlots_ = maxSlots; }
+
+private:
+    static constexpr uint32_t TICK_SHIFT = 16;  // 65.536us per tick
+    static constexpr uint32_t LEVEL_BITS = 6;
+    static constexpr uint32_t SLOTS_PER_LEVEL = 1u << LEVEL_BITS;
+    static constexpr uint32_t LEVELS = 4;
+    static constexpr uint32_t SLAB_PAGE_SLOTS = 256;
+
+    struct Bucket {
+        uint32_t head = INVALID_SLOT;
+        uint32_t tail = INVALID_SLOT;
+    };
+
+    Slot &At(uint32_t index) { return pages_[index / SLAB_PAGE_SLOTS][index % SLAB_PAGE_SLOTS]; }
+    uint32_t AllocSlot();
+    void FreeSlot(uint32_t index);
+    void File(uint32_t index);
+    void InsertSorted(Bucket &bucket, uint32_t index);
+    uint32_t Unlink(Bucket &bucket);
+    bool NextBusyTick(uint64_t &outTick) const;
+    void RunTick(uint64_t tick);
+    void Cascade(uint32_t level, uint32_t slot);
+
+    size_t maxSlots_;
+    size_t size_ = 0;
+    uint64_t currentTick_ = 0;  // every tick <= currentTick_ has been moved to ready_
+    uint64_t nextSeq_ = 0;
+    std::vector<std::unique_ptr<Slot[]>> pages_;
+    uint32_t allocated_ = 0;
+    uint32_t freeHead_ = INVALID_SLOT;
+    Bucket ready_;  // due by tick, sorted by dueNs
+    std::array<std::array<Bucket, SLOTS_PER_LEVEL>, LEVELS> buckets_{};
+    std::array<uint64_t, LEVELS> occupied_{};  // bit per non-empty bucket
+};
+} // namespace MIDI
+} // namespace OHOS
+#endif
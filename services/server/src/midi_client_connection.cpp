@@ -16,6 +16,7 @@
 #define LOG_TAG "ClientConnectionInServer"
 #endif
 
+#include <algorithm>
 #include <memory>
 
 #include "native_midi_base.h"
@@ -31,10 +32,22 @@ std::shared_ptr<MidiSharedRing> ClientConnectionInServer::GetRingBuffer()
     return sharedRingBuffer_;
 }
 
-int32_t ClientConnectionInServer::CreateRingBuffer(int fd)
+uint32_t ClientConnectionInServer::ResolveRingBufferSize(uint32_t requestedSize)
+{
+    if (requestedSize == 0) {
+        return DEFAULT_RING_BUFFER_SIZE;
+    }
+    uint32_t size = std::clamp(requestedSize, MIN_RING_BUFFER_SIZE, MAX_RING_BUFFER_SIZE);
+    // keep every record 4-byte aligned
+    size &= ~static_cast<uint32_t>(sizeof(uint32_t) - 1);
+    JUDGE_AND_INFO_LOG(size != requestedSize, "ring size %{public}u adjusted to %{public}u", requestedSize, size);
+    return size;
+}
+
+int32_t ClientConnectionInServer::CreateRingBuffer(int fd, uint32_t requestedSize, MidiRingFormat format)
 {
     auto fdObject = std::make_shared<UniqueFd>(fd);
-    sharedRingBuffer_ = MidiSharedRing::CreateFromLocal(DEFAULT_RING_BUFFER_SIZE, fdObject);
+    sharedRingBuffer_ = MidiSharedRing::CreateFromLocal(ResolveRingBufferSize(requestedSize), fdObject, format);
     CHECK_AND_RETURN_RET_LOG(sharedRingBuffer_ != nullptr, MIDI_STATUS_UNKNOWN_ERROR, "create fail");
 
     memset_s(sharedRingBuffer_->GetDataBase(), sharedRingBuffer_->GetCapacity(), 0,
@@ -45,38 +58,88 @@ int32_t ClientConnectionInServer::CreateRingBuffer(int fd)
 
 int32_t ClientConnectionInServer::TrySendToClient(const MidiEventInner& event)
 {
-    CHECK_AND_RETURN_RET(sharedRingBuffer_->TryWriteEvent(event) == MidiStatusCode::OK,
-        MIDI_STATUS_UNKNOWN_ERROR, "try send event fail");
+    CHECK_AND_RETURN_RET(TrySendBatchToClient(&event, 1) == 1, MIDI_STATUS_UNKNOWN_ERROR);
     return MIDI_STATUS_OK;
 }
 
-bool ClientConnectionInServer::EnqueueNonRealtime(std::vector<uint32_t>&& payloadWords,
+uint32_t ClientConnectionInServer::TrySendBatchToClient(const MidiEventInner *events, uint32_t eventCount)
+{
+    CHECK_AND_RETURN_RET(events != nullptr && eventCount != 0, 0);
+    if (unreportedDrops_ != 0) {
+        const uint32_t markerWords[MIDI_RING_OVERFLOW_MARKER_WORDS] = {MIDI_RING_OVERFLOW_MARKER, unreportedDrops_};
+        const MidiEventInner marker{events[0].timestamp, MIDI_RING_OVERFLOW_MARKER_WORDS, markerWords};
+        if (sharedRingBuffer_->TryWriteEvent(marker, false) != MidiStatusCode::OK) {
+            RecordDrops(eventCount);
+            return 0;
+        }
+        MIDI_INFO_LOG("client[%{public}u] recovered, %{public}u events lost", clientId_, unreportedDrops_);
+        unreportedDrops_ = 0;
+    }
+    uint32_t written = 0;
+    const MidiStatusCode status = sharedRingBuffer_->TryWriteEvents(events, eventCount, &written);
+    CHECK_AND_RETURN_RET_LOG(status == MidiStatusCode::OK || status == MidiStatusCode::WOULD_BLOCK, 0,
+        "try send events fail, status %{public}d", static_cast<int32_t>(status));
+    if (written < eventCount) {
+        RecordDrops(eventCount - written);
+    }
+    CHECK_AND_RETURN_RET(written != 0, 0);
+    uint64_t bytes = 0;
+    for (uint32_t i = 0; i < written; ++i) {
+        bytes += events[i].length * sizeof(uint32_t);
+    }
+    counters_.events.Add(written);
+    counters_.bytes.Add(bytes);
+    counters_.ringHighWater.UpdateMax(sharedRingBuffer_->GetUsedBytes());
+    return written;
+}
+
+void ClientConnectionInServer::RecordDrops(uint32_t count)
+{
+    JUDGE_AND_WARNING_LOG(unreportedDrops_ == 0, "client[%{public}u] ring full, dropping input", clientId_);
+    unreportedDrops_ += count;
+    counters_.wouldBlockDrops.Add(count);
+    sharedRingBuffer_->AddDroppedEvents(count);
+}
+
+void ClientConnectionInServer::RecordUpstreamDrops(uint32_t count)
+{
+    unreportedDrops_ += count;
+    sharedRingBuffer_->AddDroppedEvents(count);
+}
+
+bool ClientConnectionInServer::EnqueueNonRealtime(const uint32_t *payloadWords, uint32_t payloadWordCount,
                                                   std::chrono::steady_clock::time_point dueTime,
                                                   uint64_t timestamp)
 {
-    if (IsPendingFull()) {
-        return false;
-    }
-    PendingEvent event;
-    event.due = dueTime;
-    event.timestamp = timestamp;
-    event.data = std::move(payloadWords);
-    pending_.push(std::move(event));
-    return true;
+    const auto dueNs = std::chrono::duration_cast<std::chrono::nanoseconds>(dueTime.time_since_epoch()).count();
+    return pending_.Schedule(static_cast<uint64_t>(dueNs), timestamp, payloadWords, payloadWordCount);
 }
 
-const ClientConnectionInServer::PendingEvent* ClientConnectionInServer::PeekPendingTop() const
+const ClientConnectionInServer::PendingEvent* ClientConnectionInServer::PeekPendingTop()
 {
-    if (pending_.empty()) return nullptr;
-    return &pending_.top();
+    const MidiTimerWheel::Slot *slot = pending_.Front();
+    if (slot == nullptr) return nullptr;
+    top_.due = std::chrono::steady_clock::time_point(std::chrono::nanoseconds(slot->dueNs));
+    top_.timestamp = slot->timestamp;
+    top_.length = slot->length;
+    top_.data = slot->Data();
+    return &top_;
 }
 
 bool ClientConnectionInServer::PopPendingTop(PendingEvent& out)
 {
-    if (pending_.empty()) return false;
-    out = std::move(const_cast<PendingEvent&>(pending_.top()));
-    pending_.pop();
+    const PendingEvent *top = PeekPendingTop();
+    if (top == nullptr) return false;
+    out = *top;
+    pending_.PopFront();
     return true;
 }
+
+size_t ClientConnectionInServer::ClearPending()
+{
+    const size_t dropped = pending_.Size();
+    pending_.Clear();
+    return dropped;
+}
 } // namespace MIDI
 } // namespace OHOS
\ No newline at end of file
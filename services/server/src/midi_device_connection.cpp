@@ -18,18 +18,19 @@
 
 #include <algorithm>
 #include <cerrno>
+#include <cinttypes>
 #include <cstring>
 
 #include <fcntl.h>
-#include <sys/epoll.h>
 #include <sys/eventfd.h>
-#include <sys/timerfd.h>
 #include <securec.h>
 #include <unistd.h>
 
 #include "native_midi_base.h"
 #include "midi_log.h"
 #include "midi_device_connection.h"
+#include "midi_output_worker_pool.h"
+#include "midi_thread_config.h"
 
 namespace OHOS {
 namespace MIDI {
@@ -66,73 +67,238 @@ DeviceConnectionBase::DeviceConnectionBase(DeviceConnectionInfo info) : info_(in
 {}
 
 int32_t DeviceConnectionBase::AddClientConnection(
-    uint32_t clientId, int64_t deviceHandle, std::shared_ptr<MidiSharedRing> &buffer)
+    uint32_t clientId, int64_t deviceHandle, std::shared_ptr<MidiSharedRing> &buffer, uint32_t bufferSize,
+    MidiRingFormat format)
 {
     std::lock_guard<std::mutex> lock(clientsMutex_);
     auto clientConnection = std::make_shared<ClientConnectionInServer>(clientId, deviceHandle, GetInfo().portIndex);
     CHECK_AND_RETURN_RET_LOG(clientConnection != nullptr, MIDI_STATUS_UNKNOWN_ERROR, "creat client connection fail");
-    CHECK_AND_RETURN_RET_LOG(clientConnection->CreateRingBuffer() == MIDI_STATUS_OK,
+    CHECK_AND_RETURN_RET_LOG(clientConnection->CreateRingBuffer(-1, bufferSize, format) == MIDI_STATUS_OK,
         MIDI_STATUS_UNKNOWN_ERROR,
         "init client connection fail");
     buffer = clientConnection->GetRingBuffer();
-    clients_.push_back(std::move(clientConnection));
+    ConfigureClientRing(*buffer);
+    auto clients = std::make_shared<ClientList>(*clients_);
+    clients->push_back(std::move(clientConnection));
+    PublishClients(std::move(clients));
     return MIDI_STATUS_OK;
 }
 
 void DeviceConnectionBase::RemoveClientConnection(uint32_t clientId)
 {
     std::lock_guard<std::mutex> lock(clientsMutex_);
-    clients_.erase(
-        std::remove_if(clients_.begin(),
-            clients_.end(),
+    auto clients = std::make_shared<ClientList>(*clients_);
+    clients->erase(
+        std::remove_if(clients->begin(),
+            clients->end(),
             [&](const std::shared_ptr<ClientConnectionInServer> &c) { return c && c->GetClientId() == clientId; }),
-        clients_.end());
+        clients->end());
+    // readers still holding the old list keep the removed connection and its ring alive until they refresh
+    PublishClients(std::move(clients));
 }
 
 bool DeviceConnectionBase::HasClientConnection(uint32_t clientId) const
 {
-    std::lock_guard<std::mutex> lock(clientsMutex_);
-    return std::any_of(clients_.begin(), clients_.end(),
+    auto clients = SnapshotClients();
+    return std::any_of(clients->begin(), clients->end(),
         [&](const std::shared_ptr<ClientConnectionInServer> &c) {
             return c && c->GetClientId() == clientId;
         });
 }
 
+size_t DeviceConnectionBase::CountClientConnections(uint32_t clientId) const
+{
+    auto clients = SnapshotClients();
+    return static_cast<size_t>(std::count_if(clients->begin(), clients->end(),
+        [&](const std::shared_ptr<ClientConnectionInServer> &c) {
+            return c && c->GetClientId() == clientId;
+        }));
+}
+
 bool DeviceConnectionBase::IsEmptyClientConections()
 {
-    std::lock_guard<std::mutex> lock(clientsMutex_);
-    return clients_.empty();
+    return SnapshotClients()->empty();
+}
+
+void DeviceConnectionBase::DumpHistograms(std::string &dump) const
+{
+    const std::pair<const char *, const MidiHistogram *> rows[] = {
+        {"lateness_ns", &histograms_.lateness},
+        {"send_duration_ns", &histograms_.sendDuration},
+        {"delivery_delay_ns", &histograms_.deliveryDelay},
+        {"batch_size", &histograms_.batchSize},
+    };
+    for (const auto &[name, histogram] : rows) {
+        if (histogram->Count() == 0) {
+            continue;
+        }
+        dump += "    ";
+        dump += name;
+        dump += ": ";
+        dump += histogram->Summary();
+        dump += "\n";
+    }
+}
+
+void DeviceConnectionBase::Dump(std::string &dump) const
+{
+    dump += "    events_in " + std::to_string(counters_.eventsIn.Load()) + " events_out " +
+        std::to_string(counters_.eventsOut.Load()) + " bytes_in " + std::to_string(counters_.bytesIn.Load()) +
+        " bytes_out " + std::to_string(counters_.bytesOut.Load()) + " driver_errors " +
+        std::to_string(counters_.driverErrors.Load()) + " driver_drops " +
+        std::to_string(counters_.driverDrops.Load()) + "\n";
+    for (const auto &client : *SnapshotClients()) {
+        CHECK_AND_CONTINUE(client != nullptr);
+        DumpClientLine(*client, dump);
+    }
+    DumpHistograms(dump);
+}
+
+void DeviceConnectionBase::DumpClient(uint32_t clientId, std::string &dump) const
+{
+    for (const auto &client : *SnapshotClients()) {
+        CHECK_AND_CONTINUE(client != nullptr && client->GetClientId() == clientId);
+        DumpClientLine(*client, dump);
+    }
 }
 
-std::vector<std::shared_ptr<ClientConnectionInServer>> DeviceConnectionBase::SnapshotClients() const
+void DeviceConnectionBase::DumpClientLine(const ClientConnectionInServer &client, std::string &dump)
+{
+    const MidiClientCounters &clientCounters = client.GetCounters();
+    dump += "    client " + std::to_string(client.GetClientId());
+    if (client.GetLane() != 0) {
+        dump += " lane " + std::to_string(client.GetLane());
+    }
+    dump += ": events " +
+        std::to_string(clientCounters.events.Load()) + " bytes " + std::to_string(clientCounters.bytes.Load()) +
+        " would_block_drops " + std::to_string(clientCounters.wouldBlockDrops.Load()) + " ring_high_water " +
+        std::to_string(clientCounters.ringHighWater.Load()) + " pending " + std::to_string(client.PendingCount()) +
+        " pending_high_water " + std::to_string(clientCounters.pendingHighWater.Load()) + "\n";
+}
+
+std::shared_ptr<const DeviceConnectionBase::ClientList> DeviceConnectionBase::SnapshotClients() const
 {
     std::lock_guard<std::mutex> lock(clientsMutex_);
     return clients_;
 }
 
+void DeviceConnectionBase::RefreshClients(std::shared_ptr<const ClientList> &cache, uint64_t &cacheVersion) const
+{
+    if (cache != nullptr && clientsVersion_.load(std::memory_order_acquire) == cacheVersion) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(clientsMutex_);
+    cache = clients_;
+    cacheVersion = clientsVersion_.load(std::memory_order_relaxed);
+}
+
+void DeviceConnectionBase::PublishClients(std::shared_ptr<const ClientList> clients)
+{
+    clients_ = std::move(clients);
+    clientsVersion_.fetch_add(1, std::memory_order_release);
+}
+
 // ====== DeviceConnectionForInput ======
 DeviceConnectionForInput::DeviceConnectionForInput(DeviceConnectionInfo info) : DeviceConnectionBase(info)
 {}
 
+void DeviceConnectionForInput::LoadWakeConfig(const std::map<std::string, std::string> &values)
+{
+    uint32_t eventThreshold = wakeThreshold_.load(std::memory_order_relaxed);
+    uint32_t budgetUs = wakeBudgetUs_.load(std::memory_order_relaxed);
+    auto it = values.find("input_wake_threshold");
+    if (it != values.end()) {
+        CHECK_AND_RETURN_LOG(MidiThreadTool::ParseUint(it->second, eventThreshold), "invalid input_wake_threshold");
+    }
+    it = values.find("input_wake_budget_us");
+    if (it != values.end()) {
+        CHECK_AND_RETURN_LOG(MidiThreadTool::ParseUint(it->second, budgetUs), "invalid input_wake_budget_us");
+    }
+    SetWakeCoalescing(eventThreshold, budgetUs);
+    MIDI_INFO_LOG("input wake: threshold %{public}u budget %{public}uus", eventThreshold, budgetUs);
+}
+
+void DeviceConnectionForInput::SetWakeCoalescing(uint32_t eventThreshold, uint32_t budgetUs)
+{
+    wakeThreshold_.store(eventThreshold, std::memory_order_relaxed);
+    wakeBudgetUs_.store(budgetUs, std::memory_order_relaxed);
+}
+
+void DeviceConnectionForInput::ConfigureClientRing(MidiSharedRing &ring)
+{
+    ring.SetWakeCoalescing(wakeThreshold_.load(std::memory_order_relaxed),
+        wakeBudgetUs_.load(std::memory_order_relaxed));
+}
+
 void DeviceConnectionForInput::HandleDeviceUmpInput(std::vector<MidiEventInner> &events)
 {
-    for (auto &event : events) {
-        BroadcastToClients(event);
+    CHECK_AND_RETURN(!events.empty());
+    TakeDriverOverflowMarkers(events);
+    CHECK_AND_RETURN(!events.empty());
+    histograms_.batchSize.Record(events.size());
+    counters_.eventsIn.Add(events.size());
+    uint64_t batchBytes = 0;
+    for (const auto &event : events) {
+        batchBytes += event.length * sizeof(uint32_t);
+    }
+    counters_.bytesIn.Add(batchBytes);
+    BroadcastToClients(events, batchBytes);
+    // one clock read per callback, events of a batch share the write time closely enough
+    const int64_t now = ClockTime::GetCurNano();
+    for (const auto &event : events) {
+        if (event.timestamp != 0 && now >= static_cast<int64_t>(event.timestamp)) {
+            histograms_.deliveryDelay.Record(static_cast<uint64_t>(now) - event.timestamp);
+        }
+    }
+}
+
+void DeviceConnectionForInput::TakeDriverOverflowMarkers(std::vector<MidiEventInner> &events)
+{
+    uint32_t lost = 0;
+    auto isMarker = [&lost](const MidiEventInner &event) {
+        if (!MidiSharedRing::IsOverflowMarker(event.data, event.length)) {
+            return false;
+        }
+        lost += event.data[1];
+        return true;
+    };
+    events.erase(std::remove_if(events.begin(), events.end(), isMarker), events.end());
+    CHECK_AND_RETURN(lost != 0);
+    MIDI_WARNING_LOG("device %{public}" PRId64 " port %{public}u: driver lost %{public}u input events",
+        info_.deviceId, info_.portIndex, lost);
+    counters_.driverDrops.Add(lost);
+    // every client missed them, each gets a marker ahead of its next delivered events
+    RefreshClients(inputClients_, inputClientsVersion_);
+    for (const auto &client : *inputClients_) {
+        CHECK_AND_CONTINUE(client != nullptr);
+        client->RecordUpstreamDrops(lost);
     }
 }
 
-void DeviceConnectionForInput::BroadcastToClients(const MidiEventInner &ev)
+void DeviceConnectionForInput::BroadcastToClients(const std::vector<MidiEventInner> &events, uint64_t batchBytes)
 {
-    auto clients = SnapshotClients();
-    for (auto &c : clients) {
-        if (!c)
+    // one client list per driver callback, and per client one publish and one wake for the whole batch
+    RefreshClients(inputClients_, inputClientsVersion_);
+    const uint32_t eventCount = static_cast<uint32_t>(events.size());
+    for (const auto &client : *inputClients_) {
+        CHECK_AND_CONTINUE(client != nullptr);
+        const uint32_t written = client->TrySendBatchToClient(events.data(), eventCount);
+        counters_.eventsOut.Add(written);
+        if (written == eventCount) {
+            counters_.bytesOut.Add(batchBytes);
             continue;
-        c->TrySendToClient(ev);  // debug: check return value
+        }
+        uint64_t bytes = 0;
+        for (uint32_t i = 0; i < written; ++i) {
+            bytes += events[i].length * sizeof(uint32_t);
+        }
+        counters_.bytesOut.Add(bytes);
     }
 }
 
 // ====== DeviceConnectionForOutput ======
-DeviceConnectionForOutput::DeviceConnectionForOutput(DeviceConnectionInfo info) : DeviceConnectionBase(info)
+DeviceConnectionForOutput::DeviceConnectionForOutput(DeviceConnectionInfo info)
+    : DeviceConnectionBase(info), sendCacheWords_(maxSendCacheBytes_ / sizeof(uint32_t))
 {}
 
 DeviceConnectionForOutput::~DeviceConnectionForOutput()
@@ -143,17 +309,30 @@ DeviceConnectionForOutput::~DeviceConnectionForOutput()
 
 
 int32_t DeviceConnectionForOutput::AddClientConnection(
-    uint32_t clientId, int64_t deviceHandle, std::shared_ptr<MidiSharedRing> &buffer)
+    uint32_t clientId, int64_t deviceHandle, std::shared_ptr<MidiSharedRing> &buffer, uint32_t bufferSize,
+    MidiRingFormat format)
 {
+    // not under clientsMutex_: pool lock -> worker ports lock -> clientsMutex_ is the established order
+    const bool lockMemory = MidiOutputWorkerPool::GetInstance().GetThreadConfig().lockMemory;
     std::lock_guard<std::mutex> lock(clientsMutex_);
     int fd = dup(notifyEventFd_.Get());
-    auto clientConnection = std::make_shared<ClientConnectionInServer>(clientId, deviceHandle, GetInfo().portIndex);
+    // a client already connected here opens another lane, numbered in connection order
+    const auto lane = static_cast<uint32_t>(std::count_if(clients_->begin(), clients_->end(),
+        [&](const std::shared_ptr<ClientConnectionInServer> &c) { return c && c->GetClientId() == clientId; }));
+    auto clientConnection =
+        std::make_shared<ClientConnectionInServer>(clientId, deviceHandle, GetInfo().portIndex, lane);
     CHECK_AND_RETURN_RET_LOG(clientConnection != nullptr, MIDI_STATUS_UNKNOWN_ERROR, "creat client connection fail");
-    CHECK_AND_RETURN_RET_LOG(clientConnection->CreateRingBuffer(fd) == MIDI_STATUS_OK,
+    CHECK_AND_RETURN_RET_LOG(clientConnection->CreateRingBuffer(fd, bufferSize, format) == MIDI_STATUS_OK,
         MIDI_STATUS_UNKNOWN_ERROR,
         "init client connection fail");
     buffer = clientConnection->GetRingBuffer();
-    clients_.push_back(std::move(clientConnection));
+    if (lockMemory) {
+        // the worker reads this ring on every wakeup, keep it resident
+        (void)buffer->LockMemory();
+    }
+    auto clients = std::make_shared<ClientList>(*clients_);
+    clients->push_back(std::move(clientConnection));
+    PublishClients(std::move(clients));
     return MIDI_STATUS_OK;
 }
 
@@ -164,13 +343,18 @@ int32_t DeviceConnectionForOutput::Start()
         return MIDI_STATUS_OK;
     }
 
-    int32_t rc = InitEpollAndFds();
+    int eventFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (eventFd < 0) {
+        running_.store(false);
+        return MIDI_STATUS_UNKNOWN_ERROR;
+    }
+    notifyEventFd_.Reset(eventFd);
+
+    int32_t rc = MidiOutputWorkerPool::GetInstance().Attach(this);
     if (rc != MIDI_STATUS_OK) {
         running_.store(false);
         return rc;
     }
-
-    worker_ = std::thread(&DeviceConnectionForOutput::ThreadMain, this);
     return MIDI_STATUS_OK;
 }
 
@@ -181,11 +365,9 @@ int32_t DeviceConnectionForOutput::Stop()
         return MIDI_STATUS_OK;
     }
 
-    WakeWorkerByEventFd();
-
-    if (worker_.joinable()) {
-        worker_.join();
-    }
+    MidiOutputWorkerPool::GetInstance().Detach(this);
+    MIDI_INFO_LOG("device %{public}" PRId64 " port %{public}u lateness ns: %{public}s", info_.deviceId,
+        info_.portIndex, histograms_.lateness.Summary().c_str());
     return MIDI_STATUS_OK;
 }
 
@@ -201,54 +383,10 @@ void DeviceConnectionForOutput::SetPerClientMaxPendingEvents(size_t maxPendingEv
 
 void DeviceConnectionForOutput::SetMaxSendCacheBytes(size_t maxSendCacheBytes)
 {
+    // cached events point into the arena
+    FlushSendCacheToDriver();
     maxSendCacheBytes_ = maxSendCacheBytes;
-}
-
-int32_t DeviceConnectionForOutput::InitEpollAndFds()
-{
-    int eventFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
-    if (eventFd < 0) {
-        return MIDI_STATUS_UNKNOWN_ERROR;
-    }
-    notifyEventFd_.Reset(eventFd);
-
-    int tfd = ::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
-    if (tfd < 0) {
-        return MIDI_STATUS_UNKNOWN_ERROR;
-    }
-    timerFd_.Reset(tfd);
-
-    int epfd = ::epoll_create1(EPOLL_CLOEXEC);
-    if (epfd < 0) {
-        return MIDI_STATUS_UNKNOWN_ERROR;
-    }
-    epollFd_.Reset(epfd);
-
-    epoll_event evNotify{};
-    evNotify.events = EPOLLIN;
-    evNotify.data.u64 = kEpollTagNotifyEventFd;
-    if (::epoll_ctl(epollFd_.Get(), EPOLL_CTL_ADD, notifyEventFd_.Get(), &evNotify) != 0) {
-        return MIDI_STATUS_UNKNOWN_ERROR;
-    }
-
-    epoll_event evTimer{};
-    evTimer.events = EPOLLIN;
-    evTimer.data.u64 = kEpollTagTimerFd;
-    if (::epoll_ctl(epollFd_.Get(), EPOLL_CTL_ADD, timerFd_.Get(), &evTimer) !=
-        0) {  // todo: timer epoll maybe no need, one fd enough?
-        return MIDI_STATUS_UNKNOWN_ERROR;
-    }
-
-    return MIDI_STATUS_OK;
-}
-
-void DeviceConnectionForOutput::WakeWorkerByEventFd()
-{
-    if (!notifyEventFd_.Valid()) {
-        return;
-    }
-    const uint64_t one = 1;
-    (void)::write(notifyEventFd_.Get(), &one, sizeof(one));
+    sendCacheWords_.assign(maxSendCacheBytes_ / sizeof(uint32_t), 0);
 }
 
 void DeviceConnectionForOutput::DrainEventFd()
@@ -256,45 +394,56 @@ void DeviceConnectionForOutput::DrainEventFd()
     DrainCounterFd(notifyEventFd_.Get());
 }
 
-void DeviceConnectionForOutput::DrainTimerFd()
+void DeviceConnectionForOutput::RunOnce()
 {
-    DrainCounterFd(timerFd_.Get());
+    DrainEventFd();
+    HandleWakeupOnce();
 }
 
-void DeviceConnectionForOutput::ThreadMain()
+bool DeviceConnectionForOutput::GetNextDueTime(std::chrono::steady_clock::time_point &due) const
 {
-    UpdateNextTimer();
-
-    while (running_.load()) {
-        epoll_event events[8]{};
-        const int readyCount = ::epoll_wait(epollFd_.Get(), events, 8, -1);
-        if (readyCount < 0) {
-            if (errno == EINTR) {
-                continue;
-            }
-            break;
-        }
-
-        DrainEventFd();
-        DrainTimerFd();
-
-        HandleWakeupOnce();
+    if (hasNextDue_) {
+        due = nextDue_;
     }
+    return hasNextDue_;
 }
 
 void DeviceConnectionForOutput::HandleWakeupOnce()
 {
+    RefreshClientsSnapshot();
     DrainAllClientsRings(); // read event from shared_rings
     CollectDueEventsFromClientHeaps(); // collect due events
     FlushSendCacheToDriver(); // send to driver
-    UpdateNextTimer(); // update timer
+    UpdateNextDue(); // the worker re-arms its timer from this
 }
 
 // ---------------- Step1: drain ring ----------------
+void DeviceConnectionForOutput::RefreshClientsSnapshot()
+{
+    RefreshClients(clientsSnapshot_, clientsSnapshotVersion_);
+}
+
+bool DeviceConnectionForOutput::PrepareToPark()
+{
+    RefreshClientsSnapshot();
+    bool canPark = true;
+    for (const auto &clientConnection : *clientsSnapshot_) {
+        CHECK_AND_CONTINUE(clientConnection != nullptr);
+        std::shared_ptr<MidiSharedRing> ring = clientConnection->GetRingBuffer();
+        if (ring == nullptr || ring->PrepareToPark()) {
+            continue;
+        }
+        // a full timer wheel leaves records in the ring on purpose, the armed timer drains them once slots free up
+        if (!clientConnection->IsPendingFull() || ring->IsFlushRequested()) {
+            canPark = false;
+        }
+    }
+    return canPark;
+}
+
 void DeviceConnectionForOutput::DrainAllClientsRings()
 {
-    const auto clientsSnapshot = SnapshotClients();
-    for (const auto &clientConnection : clientsSnapshot) {
+    for (const auto &clientConnection : *clientsSnapshot_) {
         if (!clientConnection) {
             continue;
         }
@@ -309,25 +458,68 @@ void DeviceConnectionForOutput::DrainSingleClientRing(ClientConnectionInServer &
         return;
     }
     MidiSharedRing &clientRing = *ringShared;
+    // we are looking at the ring now, PrepareToPark re-arms it before the worker sleeps
+    clientRing.Unpark();
+    const uint32_t readIndexBefore = clientRing.GetReadPosition();
+    MidiClientCounters &clientCounters = clientConnection.GetCounters();
+    clientCounters.ringHighWater.UpdateMax(clientRing.GetUsedBytes());
+    uint64_t drainedEvents = 0;
+    uint64_t drainedBytes = 0;
+    if (clientRing.IsFlushRequested()) {
+        HandleClientFlush(clientConnection, clientRing);
+    }
     MidiSharedRing::PeekedEvent ringEvent{};
     MidiStatusCode status = MidiStatusCode::OK;
     while ((status = clientRing.PeekNext(ringEvent)) == MidiStatusCode::OK) {
         if (status != MidiStatusCode::OK) {
             break;
         }
+        // a record visible here may have been written after a flush request, handle the flush first
+        if (clientRing.IsFlushRequested()) {
+            HandleClientFlush(clientConnection, clientRing);
+            if (clientRing.IsFlushRequested()) {
+                break;  // waits for an uncommitted record before the flush point, its commit wakes us again
+            }
+            continue;
+        }
         if (ringEvent.timestamp == 0) {  // todo: use func and judge if timestamp + 1 < now
             if (!ConsumeRealtimeEvent(clientRing, ringEvent)) {
                 break;
             }
+            ++drainedEvents;
+            drainedBytes += ringEvent.length * sizeof(uint32_t);
             continue;
         }
         if (!ConsumeNonRealtimeEvent(clientConnection, clientRing, ringEvent)) {
             // 堆满/入堆失败：不 CommitRead，保留共享内存，停止读取该 client
             break;
         }
+        ++drainedEvents;
+        drainedBytes += ringEvent.length * sizeof(uint32_t);
+    }
+    if (drainedEvents != 0) {
+        clientCounters.events.Add(drainedEvents);
+        clientCounters.bytes.Add(drainedBytes);
+        clientCounters.pendingHighWater.UpdateMax(clientConnection.PendingCount());
+        counters_.eventsIn.Add(drainedEvents);
+        counters_.bytesIn.Add(drainedBytes);
+    }
+    if (clientRing.GetReadPosition() != readIndexBefore) {
+        // space was freed, release a sender blocked in WriteEventsBlocking
+        clientRing.NotifyProducer();
     }
 }
 
+void DeviceConnectionForOutput::HandleClientFlush(ClientConnectionInServer &clientConnection,
+                                                  MidiSharedRing &clientRing)
+{
+    // everything already in the heap was read before the flush point
+    const size_t droppedPending = clientConnection.ClearPending();
+    const uint32_t droppedRing = clientRing.ConsumeFlushRequest();
+    MIDI_INFO_LOG("client[%{public}u] flush: dropped %{public}zu pending, %{public}u queued",
+        clientConnection.GetClientId(), droppedPending, droppedRing);
+}
+
 bool DeviceConnectionForOutput::ConsumeRealtimeEvent(MidiSharedRing& clientRing,
                                                      const MidiSharedRing::PeekedEvent& ringEvent)
 {
@@ -365,20 +557,9 @@ bool DeviceConnectionForOutput::ConsumeNonRealtimeEvent(ClientConnectionInServer
 
     const auto dueTime = std::chrono::steady_clock::time_point(std::chrono::nanoseconds(ringEvent.timestamp));
 
-    const size_t payloadWordCount = static_cast<size_t>(ringEvent.length);
-    const size_t payloadBytes = payloadWordCount * sizeof(uint32_t);
-
-    std::vector<uint32_t> payloadWords;
-    payloadWords.resize(payloadWordCount);
-
-    if (payloadBytes > 0) {
-        (void)memcpy_s(payloadWords.data(),
-                       payloadBytes,
-                       ringEvent.payloadPtr,
-                       payloadBytes);
-    }
-
-    const bool enqueued = clientConnection.EnqueueNonRealtime(std::move(payloadWords), dueTime, ringEvent.timestamp);
+    // the wheel copies the payload into a slab slot, no per-event allocation
+    const bool enqueued = clientConnection.EnqueueNonRealtime(
+        reinterpret_cast<const uint32_t *>(ringEvent.payloadPtr), ringEvent.length, dueTime, ringEvent.timestamp);
     if (!enqueued) {
         return false;
     }
@@ -388,35 +569,61 @@ bool DeviceConnectionForOutput::ConsumeNonRealtimeEvent(ClientConnectionInServer
 }
 
 // ---------------- Step2: collect due from per-client heaps ----------------
+void DeviceConnectionForOutput::PushClientHead(ClientConnectionInServer *clientConnection)
+{
+    const auto *top = clientConnection->PeekPendingTop();
+    if (top == nullptr) {
+        return;
+    }
+    dueHeap_.push_back(ClientHead{top->due, clientConnection});
+    std::push_heap(dueHeap_.begin(), dueHeap_.end(), ClientHeadLater());
+}
+
+void DeviceConnectionForOutput::RebuildDueHeap()
+{
+    // heads only change in the drain step, one O(clients) rebuild per wakeup keeps the merge below O(log clients)
+    dueHeap_.clear();
+    for (const auto &clientConnection : *clientsSnapshot_) {
+        if (!clientConnection) {
+            continue;
+        }
+        const auto *top = clientConnection->PeekPendingTop();
+        if (top != nullptr) {
+            dueHeap_.push_back(ClientHead{top->due, clientConnection.get()});
+        }
+    }
+    std::make_heap(dueHeap_.begin(), dueHeap_.end(), ClientHeadLater());
+}
+
 void DeviceConnectionForOutput::CollectDueEventsFromClientHeaps()
 {
-    const auto clientsSnapshot = SnapshotClients();  // todo: make clientsSnapshot be clientsSnapshot_
+    RebuildDueHeap();
     auto now = std::chrono::steady_clock::now();
-    std::chrono::steady_clock::time_point earliestDueTime {};
 
-    while (auto earliestClient = FindClientWithEarliestDue(clientsSnapshot, earliestDueTime)) {
-        if (earliestDueTime > now) {
-            break;
-        }
+    while (!dueHeap_.empty() && dueHeap_.front().due <= now) {
+        std::pop_heap(dueHeap_.begin(), dueHeap_.end(), ClientHeadLater());
+        ClientConnectionInServer *earliestClient = dueHeap_.back().client;
+        dueHeap_.pop_back();
 
         ClientConnectionInServer::PendingEvent dueEvent;
         if (!earliestClient->PopPendingTop(dueEvent)) {
-            break;
+            continue;
         }
-
-        MidiEventInner dueMidiEvent;
-        dueMidiEvent.timestamp = dueEvent.timestamp;
-        dueMidiEvent.length = dueEvent.data.size();
-        dueMidiEvent.data = dueEvent.data.data();
-
-        // try enqueue send cache
-        auto res = TryAppendToSendCache(dueEvent.timestamp, dueEvent.data.data(), dueEvent.data.size());
-        CHECK_AND_RETURN(res != true);
-        FlushSendCacheToDriver();
-
-        if (!TryAppendToSendCache(dueEvent.timestamp, dueEvent.data.data(), dueEvent.data.size())) {
-            SendToDriver(dueMidiEvent);
+        histograms_.lateness.Record(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(now - dueEvent.due).count()));
+
+        // dueEvent.data points into the wheel slab, consume it before anything is enqueued again
+        if (!TryAppendToSendCache(dueEvent.timestamp, dueEvent.data, dueEvent.length)) {
+            FlushSendCacheToDriver();
+            if (!TryAppendToSendCache(dueEvent.timestamp, dueEvent.data, dueEvent.length)) {
+                MidiEventInner dueMidiEvent;
+                dueMidiEvent.timestamp = dueEvent.timestamp;
+                dueMidiEvent.length = dueEvent.length;
+                dueMidiEvent.data = dueEvent.data;
+                SendToDriver(dueMidiEvent);
+            }
         }
+        PushClientHead(earliestClient);
 
         now = std::chrono::steady_clock::now();
     }
@@ -443,56 +650,39 @@ bool DeviceConnectionForOutput::TryAppendToSendCache(uint64_t timestamp,
         return false;
     }
 
-    std::vector<uint32_t> payloadBuffer;
-    payloadBuffer.resize(payloadWordCount);
-    auto ret = memcpy_s(payloadBuffer.data(), payloadBytes, payloadWords, payloadBytes);
+    // bump allocate from the arena, payload sizes are whole words so the offset stays word aligned
+    uint32_t *cachedWords = sendCacheWords_.data() + currentSendCacheBytes_ / sizeof(uint32_t);
+    auto ret = memcpy_s(cachedWords, sendCacheWords_.size() * sizeof(uint32_t) - currentSendCacheBytes_,
+        payloadWords, payloadBytes);
     CHECK_AND_RETURN_RET_LOG(ret == 0, false, "copy error");
     MidiEventInner cachedEvent {};
     cachedEvent.timestamp = timestamp;
     cachedEvent.length = payloadWordCount;
-    cachedEvent.data = payloadBuffer.data();
+    cachedEvent.data = cachedWords;
 
-    sendCachePayloadBuffers_.push_back(std::move(payloadBuffer));
     sendCache_.push_back(cachedEvent);
 
     currentSendCacheBytes_ += payloadBytes;
     return true;
 }
 
-std::shared_ptr<ClientConnectionInServer> DeviceConnectionForOutput::FindClientWithEarliestDue(
-    const std::vector<std::shared_ptr<ClientConnectionInServer>> &clientsSnapshot,
-    std::chrono::steady_clock::time_point &outEarliestDueTime)
-{
-    std::shared_ptr<ClientConnectionInServer> bestClient = nullptr;
-    bool hasCandidate = false;
-
-    for (const auto &clientConnection : clientsSnapshot) {
-        if (!clientConnection) {
-            continue;
-        }
-        const auto *top = clientConnection->PeekPendingTop();
-        if (!top) {
-            continue;
-        }
-
-        if (!hasCandidate || top->due < outEarliestDueTime) {
-            hasCandidate = true;
-            outEarliestDueTime = top->due;
-            bestClient = clientConnection;
-        }
-    }
-    return bestClient;
-}
-
 void DeviceConnectionForOutput::FlushSendCacheToDriver()
 {
     if (sendCache_.empty()) {
         return;
     }
     CHECK_AND_RETURN_LOG(info_.driver != nullptr, "driver is null!");
-    info_.driver->HanleUmpInput(info_.deviceId, info_.portIndex, sendCache_);
+    histograms_.batchSize.Record(sendCache_.size());
+    const int64_t begin = ClockTime::GetCurNano();
+    const int32_t ret = info_.driver->HanleUmpInput(info_.deviceId, info_.portIndex, sendCache_);
+    histograms_.sendDuration.Record(static_cast<uint64_t>(ClockTime::GetCurNano() - begin));
+    if (ret == MIDI_STATUS_OK) {
+        counters_.eventsOut.Add(sendCache_.size());
+        counters_.bytesOut.Add(currentSendCacheBytes_);
+    } else {
+        counters_.driverErrors.Add(1);
+    }
     sendCache_.clear();
-    sendCachePayloadBuffers_.clear();
     currentSendCacheBytes_ = 0;
 }
 
@@ -501,40 +691,12 @@ void DeviceConnectionForOutput::SendToDriver(MidiEventInner event)
     (void)event;
 }
 
-// ---------------- Step4: timerfd ----------------
-void DeviceConnectionForOutput::UpdateNextTimer()
+// ---------------- Step4: next due ----------------
+void DeviceConnectionForOutput::UpdateNextDue()
 {
-    const auto clientsSnapshot = SnapshotClients();
-
-    bool hasDue = false;
-    std::chrono::steady_clock::time_point earliestDueTime{};
-
-    for (const auto &clientConnection : clientsSnapshot) {
-        if (!clientConnection) {
-            continue;
-        }
-        const auto *top = clientConnection->PeekPendingTop();
-        if (!top) {
-            continue;
-        }
-        if (!hasDue || top->due < earliestDueTime) {
-            hasDue = true;
-            earliestDueTime = top->due;
-        }
-    }
-
-    itimerspec newValue{};  // defaul all zero, hasDue == false to disarm
-    if (hasDue) {
-        auto now = std::chrono::steady_clock::now();
-        if (earliestDueTime < now) {
-            earliestDueTime = now;
-        }
-        const auto deltaNs = std::chrono::duration_cast<std::chrono::nanoseconds>(earliestDueTime - now).count();
-        newValue.it_value.tv_sec = static_cast<time_t>(deltaNs / MIDI_NS_PER_SECOND);
-        newValue.it_value.tv_nsec = static_cast<long>(deltaNs % MIDI_NS_PER_SECOND);
-    }
-
-    (void)::timerfd_settime(timerFd_.Get(), 0, &newValue, nullptr);
+    // dueHeap_ holds every client's head after CollectDueEventsFromClientHeaps
+    hasNextDue_ = !dueHeap_.empty();
+    nextDue_ = hasNextDue_ ? dueHeap_.front().due : std::chrono::steady_clock::time_point{};
 }
 }  // namespace MIDI
 }  // namespace OHOS
\ No newline at end of file
@@ -16,6 +16,8 @@
 #define LOG_TAG "UsbDeviceDriver"
 #endif
 
+#include <cinttypes>
+
 #include "midi_log.h"
 #include "midi_utils.h"
 #include "midi_device_usb.h"
@@ -24,6 +26,36 @@ using namespace OHOS::HDI::Midi::V1_0;
 
 namespace OHOS {
 namespace MIDI {
+namespace {
+// HDI messages of one output thread, reused by every flush: the vector and each message's payload keep their
+// capacity, and payloads of messages a smaller batch does not need wait in spareData_ for the next larger one
+class UsbMessagePool {
+public:
+    const std::vector<MidiMessage> &Fill(const std::vector<MidiEventInner> &events)
+    {
+        while (messages_.size() > events.size()) {
+            spareData_.push_back(std::move(messages_.back().data));
+            messages_.pop_back();
+        }
+        while (messages_.size() < events.size()) {
+            messages_.emplace_back();
+            if (!spareData_.empty()) {
+                messages_.back().data = std::move(spareData_.back());
+                spareData_.pop_back();
+            }
+        }
+        for (size_t i = 0; i < events.size(); ++i) {
+            messages_[i].timestamp = static_cast<int64_t>(events[i].timestamp);
+            messages_[i].data.assign(events[i].data, events[i].data + events[i].length);
+        }
+        return messages_;
+    }
+
+private:
+    std::vector<MidiMessage> messages_;
+    std::vector<std::vector<uint32_t>> spareData_;
+};
+}  // namespace
 
 UsbMidiTransportDeviceDriver::UsbMidiTransportDeviceDriver() { midiHdi_ = IMidiInterface::Get(true); }
 static std::vector<PortInformation> ConvertToDeviceInformation(const MidiDeviceInfo device)
@@ -76,17 +108,65 @@ int32_t UsbMidiTransportDeviceDriver::CloseDevice(int64_t deviceId)
     return midiHdi_->CloseDevice(deviceId);
 }
 
+void UsbMidiTransportDeviceDriver::SetSharedInput(std::shared_ptr<MidiHdiSharedInput> sharedInput)
+{
+    std::lock_guard<std::mutex> lock(inputRingsMutex_);
+    sharedInput_ = std::move(sharedInput);
+}
+
 int32_t UsbMidiTransportDeviceDriver::OpenInputPort(int64_t deviceId, uint32_t portIndex, UmpInputCallback cb)
 {
     CHECK_AND_RETURN_RET_LOG(midiHdi_ != nullptr, MIDI_STATUS_UNKNOWN_ERROR, "midiHdi_ is nullptr");
+    if (OpenInputRing(deviceId, portIndex, cb) == MIDI_STATUS_OK) {
+        return MIDI_STATUS_OK;
+    }
     auto usbCallback = sptr<UsbDriverCallback>::MakeSptr(cb);
     return midiHdi_->OpenInputPort(deviceId, portIndex, usbCallback);
 }
 
+int32_t UsbMidiTransportDeviceDriver::OpenInputRing(int64_t deviceId, uint32_t portIndex, UmpInputCallback cb)
+{
+    std::lock_guard<std::mutex> lock(inputRingsMutex_);
+    if (sharedInput_ == nullptr) {
+        return MIDI_STATUS_UNKNOWN_ERROR;
+    }
+    std::shared_ptr<MidiSharedRing> ring = nullptr;
+    int32_t ret = sharedInput_->OpenInputRing(deviceId, portIndex, ring);
+    // an HDI that cannot serve this port in ring mode still gets the callback path
+    CHECK_AND_RETURN_RET_LOG(ret == MIDI_STATUS_OK && ring != nullptr, MIDI_STATUS_UNKNOWN_ERROR,
+        "open input ring fail: %{public}d, use callback", ret);
+    auto reader = std::make_unique<MidiHdiInputRingReader>(std::move(ring), std::move(cb));
+    ret = reader->Start();
+    if (ret != MIDI_STATUS_OK) {
+        (void)sharedInput_->CloseInputRing(deviceId, portIndex);
+        return ret;
+    }
+    inputRings_[{deviceId, portIndex}] = std::move(reader);
+    MIDI_INFO_LOG("device %{public}" PRId64 " port %{public}u input via shared ring", deviceId, portIndex);
+    return MIDI_STATUS_OK;
+}
+
 int32_t UsbMidiTransportDeviceDriver::CloseInputPort(int64_t deviceId, uint32_t portIndex)
 {
     CHECK_AND_RETURN_RET_LOG(midiHdi_ != nullptr, MIDI_STATUS_UNKNOWN_ERROR, "midiHdi_ is nullptr");
-    return midiHdi_->CloseInputPort(deviceId, portIndex);
+    std::unique_ptr<MidiHdiInputRingReader> reader = nullptr;
+    std::shared_ptr<MidiHdiSharedInput> sharedInput = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(inputRingsMutex_);
+        sharedInput = sharedInput_;
+        auto it = inputRings_.find({deviceId, portIndex});
+        if (it != inputRings_.end()) {
+            reader = std::move(it->second);
+            inputRings_.erase(it);
+        }
+    }
+    if (reader == nullptr || sharedInput == nullptr) {
+        return midiHdi_->CloseInputPort(deviceId, portIndex);
+    }
+    // the HDI stops writing before the reader lets go of the ring
+    const int32_t ret = sharedInput->CloseInputRing(deviceId, portIndex);
+    reader->Stop();
+    return ret;
 }
 
 int32_t UsbMidiTransportDeviceDriver::OpenOutputPort(int64_t deviceId, uint32_t portIndex)
@@ -106,18 +186,9 @@ int32_t UsbMidiTransportDeviceDriver::HanleUmpInput(int64_t deviceId, uint32_t p
     std::vector<MidiEventInner> &list)
 {
     CHECK_AND_RETURN_RET_LOG(midiHdi_ != nullptr, MIDI_STATUS_UNKNOWN_ERROR, "midiHdi_ is nullptr");
-    std::vector<OHOS::HDI::Midi::V1_0::MidiMessage> messages;
-    for (auto &event: list) {
-        OHOS::HDI::Midi::V1_0::MidiMessage msg;
-        msg.timestamp = static_cast<int64_t>(event.timestamp);
-        for (size_t i = 0; i < event.length; ++i) {
-            msg.data.push_back(event.data[i]);
-        }
-        messages.emplace_back(msg);
-    }
-    
-    int32_t ret = midiHdi_->SendMidiMessages(deviceId, portIndex, messages);
-    return ret;
+    // called by the output workers, one pool per worker thread needs no lock
+    thread_local UsbMessagePool pool;
+    return midiHdi_->SendMidiMessages(deviceId, portIndex, pool.Fill(list));
 }
 
 int32_t UsbDriverCallback::OnMidiDataReceived(const std::vector<OHOS::HDI::Midi::V1_0::MidiMessage> &messages)
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef LOG_TAG
+#define LOG_TAG "MidiHdiInputRing"
+#endif
+
+#include "midi_hdi_input_ring.h"
+
+#include "futex_tool.h"
+#include "midi_log.h"
+#include "native_midi_base.h"
+
+namespace OHOS {
+namespace MIDI {
+MidiHdiInputRingReader::MidiHdiInputRingReader(std::shared_ptr<MidiSharedRing> ring, UmpInputCallback callback,
+    const MidiThreadConfig &threadConfig)
+    : ring_(std::move(ring)), callback_(std::move(callback)), threadConfig_(threadConfig)
+{}
+
+MidiHdiInputRingReader::~MidiHdiInputRingReader()
+{
+    Stop();
+}
+
+int32_t MidiHdiInputRingReader::Start()
+{
+    CHECK_AND_RETURN_RET_LOG(ring_ != nullptr && callback_ != nullptr, MIDI_STATUS_UNKNOWN_ERROR,
+        "ring or callback is nullptr");
+    bool expected = false;
+    if (!running_.compare_exchange_strong(expected, true)) {
+        return MIDI_STATUS_OK;
+    }
+    readerThread_ = std::thread(&MidiHdiInputRingReader::ReaderLoop, this);
+    return MIDI_STATUS_OK;
+}
+
+void MidiHdiInputRingReader::Stop()
+{
+    bool expected = true;
+    if (running_.compare_exchange_strong(expected, false)) {
+        (void)FutexTool::FutexWake(ring_->GetFutex(), IS_PRE_EXIT);
+    }
+    if (readerThread_.joinable()) {
+        readerThread_.join();
+    }
+}
+
+void MidiHdiInputRingReader::ReaderLoop()
+{
+    (void)MidiThreadTool::ApplyToCurrentThread(threadConfig_);
+    if (threadConfig_.lockMemory) {
+        (void)ring_->LockMemory();
+    }
+    ring_->SetWaitStrategy(threadConfig_.waitStrategy);
+    const int64_t parkTimeoutNs = ring_->GetParkTimeoutNs();
+    while (running_.load()) {
+        (void)ring_->WaitFor(parkTimeoutNs, [this]() { return HasDataOrExit(); });
+        if (!running_.load()) {
+            break;
+        }
+        DrainOnce();
+    }
+}
+
+bool MidiHdiInputRingReader::HasDataOrExit()
+{
+    return !running_.load() || !ring_->IsEmpty();
+}
+
+void MidiHdiInputRingReader::DrainOnce()
+{
+    if (ring_->PeekBatch(views_) != MidiStatusCode::OK) {
+        return;
+    }
+    events_.clear();
+    // overflow markers of the HDI go along, DeviceConnectionForInput turns them into client side markers
+    for (const auto &view : views_) {
+        events_.push_back(MidiEventInner{view.timestamp, view.length, view.data});
+    }
+    callback_(events_);
+    // the callback copied what it kept into the client rings, the HDI may reuse the space now
+    ring_->CommitBatch();
+}
+} // namespace MIDI
+} // namespace OHOS
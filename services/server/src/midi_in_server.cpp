@@ -57,17 +57,29 @@ int32_t MidiInServer::OpenBleDevice(const std::string &address, const sptr<IRemo
     return MidiServiceController::GetInstance()->OpenBleDevice(clientId_, address, object);
 }
 
-int32_t MidiInServer::OpenInputPort(std::shared_ptr<MidiSharedRing> &buffer, int64_t deviceId, uint32_t portIndex)
+int32_t MidiInServer::OpenInputPort(std::shared_ptr<MidiSharedRing> &buffer, int64_t deviceId, uint32_t portIndex,
+    uint32_t bufferSize)
 {
-    MIDI_INFO_LOG("deviceId[%{public}" PRId64 "]---->portIndex[%{public}u]", deviceId, portIndex);
-    return MidiServiceController::GetInstance()->OpenInputPort(clientId_, buffer, deviceId, portIndex);
+    MIDI_INFO_LOG("deviceId[%{public}" PRId64 "]---->portIndex[%{public}u] bufferSize[%{public}u]",
+        deviceId, portIndex, bufferSize);
+    return MidiServiceController::GetInstance()->OpenInputPort(clientId_, buffer, deviceId, portIndex, bufferSize);
 }
 
 int32_t MidiInServer::OpenOutputPort(std::shared_ptr<MidiSharedRing> &buffer, int64_t deviceId,
-    uint32_t portIndex)
+    uint32_t portIndex, uint32_t bufferSize, bool multiProducer)
 {
-    MIDI_INFO_LOG("deviceId[%{public}" PRId64 "]---->portIndex[%{public}u]", deviceId, portIndex);
-    return MidiServiceController::GetInstance()->OpenOutputPort(clientId_, buffer, deviceId, portIndex);
+    MIDI_INFO_LOG("deviceId[%{public}" PRId64 "]---->portIndex[%{public}u] bufferSize[%{public}u] "
+        "multiProducer[%{public}d]", deviceId, portIndex, bufferSize, multiProducer);
+    return MidiServiceController::GetInstance()->OpenOutputPort(clientId_, buffer, deviceId, portIndex, bufferSize,
+        multiProducer);
+}
+
+int32_t MidiInServer::OpenOutputLane(std::shared_ptr<MidiSharedRing> &buffer, int64_t deviceId,
+    uint32_t portIndex, uint32_t bufferSize)
+{
+    MIDI_INFO_LOG("deviceId[%{public}" PRId64 "]---->portIndex[%{public}u] bufferSize[%{public}u] lane",
+        deviceId, portIndex, bufferSize);
+    return MidiServiceController::GetInstance()->OpenOutputLane(clientId_, buffer, deviceId, portIndex, bufferSize);
 }
 
 int32_t MidiInServer::CloseInputPort(int64_t deviceId, uint32_t portIndex)
@@ -92,6 +104,14 @@ int32_t MidiInServer::DestroyMidiClient()
     return MidiServiceController::GetInstance()->DestroyMidiClient(clientId_);
 }
 
+int32_t MidiInServer::GetStatistics(std::string &statistics)
+{
+    statistics.clear();
+    // unprivileged callers only see their own connections, the full dump stays behind hidumper
+    MidiServiceController::GetInstance()->DumpClient(clientId_, statistics);
+    return MIDI_STATUS_OK;
+}
+
 void MidiInServer::NotifyDeviceChange(DeviceChangeType change, std::map<int32_t, std::string> deviceInfo)
 {
     CHECK_AND_RETURN(callback_ != nullptr);
@@ -0,0 +1,429 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef LOG_TAG
+#define LOG_TAG "MidiOutputWorkerPool"
+#endif
+
+#include "midi_output_worker_pool.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cinttypes>
+#include <ctime>
+
+#include <sys/epoll.h>
+#include <sys/prctl.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include "futex_tool.h"
+#include "native_midi_base.h"
+#include "midi_log.h"
+#include "midi_device_connection.h"
+
+namespace OHOS {
+namespace MIDI {
+namespace {
+constexpr int MAX_EPOLL_EVENTS = 16;
+constexpr int64_t NS_PER_US = 1000;
+}
+
+// ====== MidiOutputWorker ======
+MidiOutputWorker::MidiOutputWorker(uint32_t index, const MidiThreadConfig &threadConfig,
+    const MidiDeadlineConfig &deadlineConfig)
+    : index_(index), threadConfig_(threadConfig), deadlineConfig_(deadlineConfig)
+{}
+
+MidiOutputWorker::~MidiOutputWorker()
+{
+    Stop();
+}
+
+int32_t MidiOutputWorker::Start()
+{
+    bool expected = false;
+    CHECK_AND_RETURN_RET(running_.compare_exchange_strong(expected, true), MIDI_STATUS_OK);
+
+    wakeFd_.Reset(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC));
+    timerFd_.Reset(::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC));
+    epollFd_.Reset(::epoll_create1(EPOLL_CLOEXEC));
+    bool ok = wakeFd_.Valid() && timerFd_.Valid() && epollFd_.Valid();
+    epoll_event evWake{};
+    evWake.events = EPOLLIN;
+    evWake.data.u64 = kEpollTagWakeFd;
+    epoll_event evTimer{};
+    evTimer.events = EPOLLIN;
+    evTimer.data.u64 = kEpollTagTimerFd;
+    ok = ok && ::epoll_ctl(epollFd_.Get(), EPOLL_CTL_ADD, wakeFd_.Get(), &evWake) == 0 &&
+        ::epoll_ctl(epollFd_.Get(), EPOLL_CTL_ADD, timerFd_.Get(), &evTimer) == 0;
+    if (!ok) {
+        MIDI_ERR_LOG("worker %{public}u init fds failed: %{public}s", index_, strerror(errno));
+        running_.store(false);
+        return MIDI_STATUS_UNKNOWN_ERROR;
+    }
+    thread_ = std::thread(&MidiOutputWorker::ThreadMain, this);
+    return MIDI_STATUS_OK;
+}
+
+void MidiOutputWorker::Stop()
+{
+    bool expected = true;
+    CHECK_AND_RETURN(running_.compare_exchange_strong(expected, false));
+    Wake();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+int32_t MidiOutputWorker::Attach(DeviceConnectionForOutput *port)
+{
+    CHECK_AND_RETURN_RET(port != nullptr, MIDI_STATUS_GENERIC_INVALID_ARGUMENT);
+    std::lock_guard<std::mutex> lock(portsMutex_);
+    epoll_event evPort{};
+    evPort.events = EPOLLIN;
+    evPort.data.u64 = reinterpret_cast<uintptr_t>(port);
+    CHECK_AND_RETURN_RET_LOG(::epoll_ctl(epollFd_.Get(), EPOLL_CTL_ADD, port->GetNotifyEventFdForClients(),
+        &evPort) == 0, MIDI_STATUS_UNKNOWN_ERROR, "add port fd failed: %{public}s", strerror(errno));
+    // run it once: rings left unparked by a previous attach would not write the eventfd
+    ports_.push_back(PortEntry{port, true});
+    portCount_.store(static_cast<uint32_t>(ports_.size()), std::memory_order_relaxed);
+    Wake();
+    return MIDI_STATUS_OK;
+}
+
+void MidiOutputWorker::Detach(DeviceConnectionForOutput *port)
+{
+    std::lock_guard<std::mutex> lock(portsMutex_);
+    auto it = std::find_if(ports_.begin(), ports_.end(), [port](const PortEntry &e) { return e.port == port; });
+    CHECK_AND_RETURN(it != ports_.end());
+    (void)::epoll_ctl(epollFd_.Get(), EPOLL_CTL_DEL, port->GetNotifyEventFdForClients(), nullptr);
+    ports_.erase(it);
+    portCount_.store(static_cast<uint32_t>(ports_.size()), std::memory_order_relaxed);
+    RearmTimer();
+}
+
+MidiOutputWorkerStats MidiOutputWorker::GetStats() const
+{
+    MidiOutputWorkerStats stats;
+    stats.workerIndex = index_;
+    stats.portCount = portCount_.load(std::memory_order_relaxed);
+    stats.wakeups = wakeups_.load(std::memory_order_relaxed);
+    stats.portRuns = portRuns_.load(std::memory_order_relaxed);
+    stats.busyNs = busyNs_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void MidiOutputWorker::Wake()
+{
+    const uint64_t one = 1;
+    if (wakeFd_.Valid()) {
+        (void)::write(wakeFd_.Get(), &one, sizeof(one));
+    }
+}
+
+void MidiOutputWorker::ThreadMain()
+{
+    (void)MidiThreadTool::ApplyToCurrentThread(threadConfig_);
+    if (deadlineConfig_.timerSlackNs > 0 &&
+        ::prctl(PR_SET_TIMERSLACK, static_cast<unsigned long>(deadlineConfig_.timerSlackNs)) != 0) {
+        MIDI_WARNING_LOG("worker %{public}u set timer slack failed: %{public}s", index_, strerror(errno));
+    }
+    while (running_.load()) {
+        const int timeoutMs = PrepareToPark() ? -1 : 0;
+        epoll_event events[MAX_EPOLL_EVENTS]{};
+        const int readyCount = ::epoll_wait(epollFd_.Get(), events, MAX_EPOLL_EVENTS, timeoutMs);
+        if (readyCount < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            MIDI_ERR_LOG("worker %{public}u epoll_wait failed: %{public}s", index_, strerror(errno));
+            break;
+        }
+        const int64_t begin = ClockTime::GetCurNano();
+        wakeups_.fetch_add(1, std::memory_order_relaxed);
+        bool timerFired = std::any_of(events, events + readyCount,
+            [](const epoll_event &event) { return event.data.u64 == kEpollTagTimerFd; });
+        if (timerFired) {
+            // outside portsMutex_, so a port open or close never waits out the lead time
+            WaitForArmedDeadline();
+        }
+        {
+            std::lock_guard<std::mutex> lock(portsMutex_);
+            for (int i = 0; i < readyCount; ++i) {
+                MarkReady(events[i].data.u64, timerFired);
+            }
+            RunReadyPorts(timerFired);
+            RearmTimer();
+        }
+        busyNs_.fetch_add(static_cast<uint64_t>(ClockTime::GetCurNano() - begin), std::memory_order_relaxed);
+    }
+}
+
+bool MidiOutputWorker::PrepareToPark()
+{
+    // clients only write a port's eventfd while its rings are armed, a port whose rings already hold data runs again
+    std::lock_guard<std::mutex> lock(portsMutex_);
+    bool canPark = true;
+    for (auto &entry : ports_) {
+        if (!entry.port->PrepareToPark()) {
+            entry.ready = true;
+            canPark = false;
+        }
+    }
+    return canPark;
+}
+
+void MidiOutputWorker::MarkReady(uint64_t tag, bool &timerFired)
+{
+    if (tag == kEpollTagWakeFd) {
+        DrainCounterFd(wakeFd_.Get());
+        return;
+    }
+    if (tag == kEpollTagTimerFd) {
+        DrainCounterFd(timerFd_.Get());
+        timerFired = true;
+        return;
+    }
+    // the port may have been detached after epoll_wait returned, only trust what is still attached
+    for (auto &entry : ports_) {
+        if (reinterpret_cast<uintptr_t>(entry.port) == tag) {
+            entry.ready = true;
+            return;
+        }
+    }
+}
+
+void MidiOutputWorker::RunReadyPorts(bool timerFired)
+{
+    const auto now = std::chrono::steady_clock::now();
+    for (auto &entry : ports_) {
+        std::chrono::steady_clock::time_point due{};
+        if (timerFired && entry.port->GetNextDueTime(due) && due <= now) {
+            entry.ready = true;
+        }
+        if (!entry.ready) {
+            continue;
+        }
+        entry.ready = false;
+        entry.port->RunOnce();
+        portRuns_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void MidiOutputWorker::WaitForArmedDeadline()
+{
+    // the timer fired leadNs early, close the gap here; other ports of this worker wait at most leadNs
+    CHECK_AND_RETURN(deadlineConfig_.mode != MidiDeadlineMode::NONE);
+    int64_t dueNs = 0;
+    {
+        std::lock_guard<std::mutex> lock(portsMutex_);
+        CHECK_AND_RETURN(hasArmedDue_);
+        dueNs = armedDueNs_;
+    }
+    if (deadlineConfig_.mode == MidiDeadlineMode::SPIN) {
+        while (ClockTime::GetCurNano() < dueNs) {
+            CpuRelax();
+        }
+        return;
+    }
+    timespec deadline{};
+    deadline.tv_sec = static_cast<time_t>(dueNs / MIDI_NS_PER_SECOND);
+    deadline.tv_nsec = static_cast<long>(dueNs % MIDI_NS_PER_SECOND);
+    while (::clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr) == EINTR) {
+    }
+}
+
+void MidiOutputWorker::RearmTimer()
+{
+    bool hasDue = false;
+    std::chrono::steady_clock::time_point earliestDueTime{};
+    for (const auto &entry : ports_) {
+        std::chrono::steady_clock::time_point due{};
+        if (entry.port->GetNextDueTime(due) && (!hasDue || due < earliestDueTime)) {
+            hasDue = true;
+            earliestDueTime = due;
+        }
+    }
+
+    hasArmedDue_ = hasDue;
+    itimerspec newValue{};  // all zero disarms
+    if (hasDue) {
+        // steady_clock is CLOCK_MONOTONIC, the clock of timerFd_
+        armedDueNs_ = std::chrono::duration_cast<std::chrono::nanoseconds>(earliestDueTime.time_since_epoch()).count();
+        const int64_t leadNs = deadlineConfig_.mode == MidiDeadlineMode::NONE ? 0 : deadlineConfig_.leadNs;
+        // an absolute expiry in the past fires at once, but zero would disarm
+        const int64_t wakeNs = std::max<int64_t>(1, armedDueNs_ - leadNs);
+        newValue.it_value.tv_sec = static_cast<time_t>(wakeNs / MIDI_NS_PER_SECOND);
+        newValue.it_value.tv_nsec = static_cast<long>(wakeNs % MIDI_NS_PER_SECOND);
+    }
+    (void)::timerfd_settime(timerFd_.Get(), TFD_TIMER_ABSTIME, &newValue, nullptr);
+}
+
+// ====== MidiOutputWorkerPool ======
+MidiOutputWorkerPool &MidiOutputWorkerPool::GetInstance()
+{
+    static MidiOutputWorkerPool instance;
+    return instance;
+}
+
+void MidiOutputWorkerPool::SetWorkerCount(uint32_t workerCount)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    workerCount_ = std::clamp<uint32_t>(workerCount, 1, MAX_OUTPUT_WORKER_COUNT);
+    MIDI_INFO_LOG("output worker count %{public}u", workerCount_);
+}
+
+uint32_t MidiOutputWorkerPool::GetWorkerCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return workerCount_;
+}
+
+void MidiOutputWorkerPool::SetThreadConfig(const MidiThreadConfig &threadConfig)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    threadConfig_ = threadConfig;
+}
+
+MidiThreadConfig MidiOutputWorkerPool::GetThreadConfig() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return threadConfig_;
+}
+
+void MidiOutputWorkerPool::SetDeadlineConfig(const MidiDeadlineConfig &deadlineConfig)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    deadlineConfig_ = deadlineConfig;
+    deadlineConfig_.leadNs = std::clamp<int64_t>(deadlineConfig.leadNs, 0, MAX_DEADLINE_LEAD_NS);
+}
+
+MidiDeadlineConfig MidiOutputWorkerPool::GetDeadlineConfig() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return deadlineConfig_;
+}
+
+void MidiOutputWorkerPool::LoadDeadlineConfig(const std::map<std::string, std::string> &values)
+{
+    MidiDeadlineConfig deadlineConfig = GetDeadlineConfig();
+    auto it = values.find("output_deadline_mode");
+    if (it != values.end()) {
+        static const std::map<std::string, MidiDeadlineMode> modes = {
+            {"none", MidiDeadlineMode::NONE}, {"sleep", MidiDeadlineMode::SLEEP}, {"spin", MidiDeadlineMode::SPIN}};
+        auto mode = modes.find(it->second);
+        if (mode != modes.end()) {
+            deadlineConfig.mode = mode->second;
+        } else {
+            MIDI_ERR_LOG("invalid output_deadline_mode %{public}s", it->second.c_str());
+        }
+    }
+    uint32_t value = 0;
+    it = values.find("output_deadline_lead_us");
+    if (it != values.end()) {
+        if (MidiThreadTool::ParseUint(it->second, value)) {
+            deadlineConfig.leadNs = std::min<int64_t>(value, MAX_DEADLINE_LEAD_NS / NS_PER_US) * NS_PER_US;
+        } else {
+            MIDI_ERR_LOG("invalid output_deadline_lead_us %{public}s", it->second.c_str());
+        }
+    }
+    it = values.find("output_timer_slack_ns");
+    if (it != values.end()) {
+        if (MidiThreadTool::ParseUint(it->second, value)) {
+            deadlineConfig.timerSlackNs = value;
+        } else {
+            MIDI_ERR_LOG("invalid output_timer_slack_ns %{public}s", it->second.c_str());
+        }
+    }
+    SetDeadlineConfig(deadlineConfig);
+    MIDI_INFO_LOG("output deadline: mode %{public}u lead %{public}" PRId64 "ns slack %{public}" PRIu64 "ns",
+        static_cast<uint32_t>(deadlineConfig.mode), deadlineConfig.leadNs, deadlineConfig.timerSlackNs);
+}
+
+void MidiOutputWorkerPool::LoadConfig(const std::map<std::string, std::string> &values)
+{
+    CHECK_AND_RETURN(!values.empty());
+    auto it = values.find("output_worker_count");
+    uint32_t workerCount = 0;
+    if (it != values.end()) {
+        if (MidiThreadTool::ParseUint(it->second, workerCount) && workerCount > 0) {
+            SetWorkerCount(std::min<uint32_t>(workerCount, MAX_OUTPUT_WORKER_COUNT));
+        } else {
+            MIDI_ERR_LOG("invalid output_worker_count %{public}s", it->second.c_str());
+        }
+    }
+    LoadDeadlineConfig(values);
+    MidiThreadConfig threadConfig = GetThreadConfig();
+    CHECK_AND_RETURN_LOG(MidiThreadTool::ParseThreadConfig(values, "output_", threadConfig),
+        "keep default output thread config");
+    SetThreadConfig(threadConfig);
+    MIDI_INFO_LOG("output threads: policy %{public}u priority %{public}d cpus 0x%{public}llx lock %{public}d",
+        static_cast<uint32_t>(threadConfig.policy), threadConfig.priority,
+        static_cast<unsigned long long>(threadConfig.cpuMask), threadConfig.lockMemory);
+}
+
+MidiOutputWorker *MidiOutputWorkerPool::PickWorker()
+{
+    MidiOutputWorker *best = nullptr;
+    for (uint32_t i = 0; i < std::min<size_t>(workers_.size(), workerCount_); ++i) {
+        if (best == nullptr || workers_[i]->GetPortCount() < best->GetPortCount()) {
+            best = workers_[i].get();
+        }
+    }
+    if (best != nullptr && (best->GetPortCount() == 0 || workers_.size() >= workerCount_)) {
+        return best;
+    }
+    // every worker is busy and there is room for another thread
+    auto worker = std::make_unique<MidiOutputWorker>(static_cast<uint32_t>(workers_.size()), threadConfig_,
+        deadlineConfig_);
+    CHECK_AND_RETURN_RET(worker->Start() == MIDI_STATUS_OK, best);
+    workers_.push_back(std::move(worker));
+    return workers_.back().get();
+}
+
+int32_t MidiOutputWorkerPool::Attach(DeviceConnectionForOutput *port)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    MidiOutputWorker *worker = PickWorker();
+    CHECK_AND_RETURN_RET_LOG(worker != nullptr, MIDI_STATUS_UNKNOWN_ERROR, "no output worker");
+    int32_t ret = worker->Attach(port);
+    CHECK_AND_RETURN_RET(ret == MIDI_STATUS_OK, ret);
+    assignments_.emplace_back(port, worker);
+    return MIDI_STATUS_OK;
+}
+
+void MidiOutputWorkerPool::Detach(DeviceConnectionForOutput *port)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = std::find_if(assignments_.begin(), assignments_.end(),
+        [port](const auto &assignment) { return assignment.first == port; });
+    CHECK_AND_RETURN(it != assignments_.end());
+    it->second->Detach(port);
+    assignments_.erase(it);
+}
+
+std::vector<MidiOutputWorkerStats> MidiOutputWorkerPool::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<MidiOutputWorkerStats> stats;
+    stats.reserve(workers_.size());
+    for (const auto &worker : workers_) {
+        stats.push_back(worker->GetStats());
+    }
+    return stats;
+}
+} // namespace MIDI
+} // namespace OHOS
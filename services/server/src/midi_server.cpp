@@ -17,6 +17,9 @@
 #endif
 
 #include "midi_server.h"
+
+#include <unistd.h>
+
 #include "iservice_registry.h"
 #include "system_ability_definition.h"
 #include "midi_log.h"
@@ -35,6 +38,17 @@ void MidiServer::OnStart()
 
 void MidiServer::OnDump() {}
 
+int32_t MidiServer::Dump(int32_t fd, const std::vector<std::u16string> &args)
+{
+    (void)args;
+    CHECK_AND_RETURN_RET_LOG(controller_, MIDI_STATUS_UNKNOWN_ERROR, "controller_ is nullptr");
+    std::string dump;
+    controller_->Dump(dump);
+    CHECK_AND_RETURN_RET_LOG(write(fd, dump.c_str(), dump.size()) == static_cast<ssize_t>(dump.size()),
+        MIDI_STATUS_UNKNOWN_ERROR, "write dump failed");
+    return MIDI_STATUS_OK;
+}
+
 int32_t MidiServer::CreateMidiInServer(const sptr<IRemoteObject> &object, sptr<IRemoteObject> &client,
     uint32_t &clientId)
 {
@@ -26,12 +26,15 @@
 #include "midi_utils.h"
 #include "imidi_device_open_callback.h"
 #include "midi_listener_callback.h"
+#include "midi_output_worker_pool.h"
 #include <chrono>
 
 namespace OHOS {
 namespace MIDI {
 std::atomic<uint32_t> MidiServiceController::currentClientId_ = 0;
 static constexpr uint32_t MAX_CLIENTID = 0xFFFFFFFF;
+static constexpr size_t MAX_OUTPUT_LANES = 8;  // rings per client and output port, the first one included
+static constexpr const char *MIDI_SERVER_THREAD_CONFIG_PATH = "/system/etc/midi/midi_server_thread.conf";
 static  std::map<int32_t, std::string> ConvertDeviceInfo(const DeviceInformation &device)
 {
     std::map<int32_t, std::string> deviceInfo;
@@ -76,6 +79,9 @@ std::shared_ptr<MidiServiceController> MidiServiceController::GetInstance()
 
 void MidiServiceController::Init()
 {
+    const auto threadConfigValues = MidiThreadTool::ReadConfigFile(MIDI_SERVER_THREAD_CONFIG_PATH);
+    MidiOutputWorkerPool::GetInstance().LoadConfig(threadConfigValues);
+    DeviceConnectionForInput::LoadWakeConfig(threadConfigValues);
     deviceManager_->Init();
 }
 
@@ -316,8 +322,8 @@ void MidiServiceController::HandleBleOpenComplete(const std::string &address, bo
     }
 }
 
-int32_t MidiServiceController::OpenInputPort(
-    uint32_t clientId, std::shared_ptr<MidiSharedRing> &buffer, int64_t deviceId, uint32_t portIndex)
+int32_t MidiServiceController::OpenInputPort(uint32_t clientId, std::shared_ptr<MidiSharedRing> &buffer,
+    int64_t deviceId, uint32_t portIndex, uint32_t bufferSize)
 {
     MIDI_INFO_LOG(
         "clientId: %{public}u, deviceId: %{public}" PRId64 " portIndex: %{public}u", clientId, deviceId, portIndex);
@@ -342,7 +348,7 @@ int32_t MidiServiceController::OpenInputPort(
     if (inputPort != inputPortConnections.end()) {
         CHECK_AND_RETURN_RET_LOG(inputPort->second->HasClientConnection(clientId) != true,
             MIDI_STATUS_PORT_ALREADY_OPEN, "already connected inputport");
-        inputPort->second->AddClientConnection(clientId, deviceId, buffer);
+        inputPort->second->AddClientConnection(clientId, deviceId, buffer, bufferSize);
         MIDI_INFO_LOG("connect inputport success");
         return MIDI_STATUS_OK;
     }
@@ -350,15 +356,15 @@ int32_t MidiServiceController::OpenInputPort(
     auto ret = deviceManager_->OpenInputPort(inputConnection, deviceId, portIndex);
     CHECK_AND_RETURN_RET_LOG(ret == MIDI_STATUS_OK, ret, "open input port fail!");
 
-    inputConnection->AddClientConnection(clientId, deviceId, buffer);
+    inputConnection->AddClientConnection(clientId, deviceId, buffer, bufferSize);
 
     inputPortConnections.emplace(portIndex, std::move(inputConnection));
     MIDI_INFO_LOG("OpenInputPort Success");
     return MIDI_STATUS_OK;
 }
 
-int32_t MidiServiceController::OpenOutputPort(
-    uint32_t clientId, std::shared_ptr<MidiSharedRing> &buffer, int64_t deviceId, uint32_t portIndex)
+int32_t MidiServiceController::OpenOutputPort(uint32_t clientId, std::shared_ptr<MidiSharedRing> &buffer,
+    int64_t deviceId, uint32_t portIndex, uint32_t bufferSize, bool multiProducer)
 {
     MIDI_INFO_LOG(
         "clientId: %{public}u, deviceId: %{public}" PRId64 " portIndex: %{public}u", clientId, deviceId, portIndex);
@@ -378,12 +384,13 @@ int32_t MidiServiceController::OpenOutputPort(
         clientId,
         deviceId);
 
+    const MidiRingFormat ringFormat = multiProducer ? MidiRingFormat::MULTI_PRODUCER : MidiRingFormat::STANDARD;
     auto &outputPortConnections = it->second->outputDeviceconnections_;
     auto outputPort = outputPortConnections.find(portIndex);
     if (outputPort != outputPortConnections.end()) {
         CHECK_AND_RETURN_RET_LOG(outputPort->second->HasClientConnection(clientId) != true,
             MIDI_STATUS_PORT_ALREADY_OPEN, "already connected outputport");
-        outputPort->second->AddClientConnection(clientId, deviceId, buffer);
+        outputPort->second->AddClientConnection(clientId, deviceId, buffer, bufferSize, ringFormat);
         MIDI_INFO_LOG("connect outputport success");
         return MIDI_STATUS_OK;
     }
@@ -393,12 +400,42 @@ int32_t MidiServiceController::OpenOutputPort(
     CHECK_AND_RETURN_RET_LOG(ret == MIDI_STATUS_OK, ret, "open output port fail!");
     // start events handle thread of output port
     outputConnection->Start();
-    outputConnection->AddClientConnection(clientId, deviceId, buffer);
+    outputConnection->AddClientConnection(clientId, deviceId, buffer, bufferSize, ringFormat);
     outputPortConnections.emplace(portIndex, std::move(outputConnection));
     MIDI_INFO_LOG("OpenOutputPort Success");
     return MIDI_STATUS_OK;
 }
 
+int32_t MidiServiceController::OpenOutputLane(uint32_t clientId, std::shared_ptr<MidiSharedRing> &buffer,
+    int64_t deviceId, uint32_t portIndex, uint32_t bufferSize)
+{
+    MIDI_INFO_LOG(
+        "clientId: %{public}u, deviceId: %{public}" PRId64 " portIndex: %{public}u", clientId, deviceId, portIndex);
+    std::lock_guard lock(lock_);
+    CHECK_AND_RETURN_RET_LOG(clients_.find(clientId) != clients_.end(),
+        MIDI_STATUS_INVALID_CLIENT,
+        "Client not found: %{public}u",
+        clientId);
+    auto it = deviceClientContexts_.find(deviceId);
+    CHECK_AND_RETURN_RET_LOG(it != deviceClientContexts_.end(),
+        MIDI_STATUS_INVALID_DEVICE_HANDLE,
+        "device %{public}" PRId64 "not opened",
+        deviceId);
+    auto &outputPortConnections = it->second->outputDeviceconnections_;
+    auto outputPort = outputPortConnections.find(portIndex);
+    // lanes hang off a port the client opened with OpenOutputPort, closing that port closes them all
+    CHECK_AND_RETURN_RET_LOG(outputPort != outputPortConnections.end() &&
+        outputPort->second->HasClientConnection(clientId),
+        MIDI_STATUS_INVALID_PORT, "outputport %{public}u not opened by client %{public}u", portIndex, clientId);
+    CHECK_AND_RETURN_RET_LOG(outputPort->second->CountClientConnections(clientId) < MAX_OUTPUT_LANES,
+        MIDI_STATUS_TOO_MANY_OPEN_PORTS, "client %{public}u has too many lanes", clientId);
+    // each lane has exactly one sending thread, so it stays a single producer ring
+    auto ret = outputPort->second->AddClientConnection(clientId, deviceId, buffer, bufferSize);
+    CHECK_AND_RETURN_RET_LOG(ret == MIDI_STATUS_OK, ret, "open output lane fail");
+    MIDI_INFO_LOG("OpenOutputLane Success");
+    return MIDI_STATUS_OK;
+}
+
 
 int32_t MidiServiceController::CloseInputPort(uint32_t clientId, int64_t deviceId, uint32_t portIndex)
 {
@@ -595,5 +632,52 @@ void MidiServiceController::NotifyError(int32_t code)
         it.second->NotifyError(code);
     }
 }
+
+void MidiServiceController::Dump(std::string &dump)
+{
+    {
+        std::lock_guard lock(lock_);
+        dump += "MIDI clients " + std::to_string(clients_.size()) + ", open devices " +
+            std::to_string(deviceClientContexts_.size()) + "\n";
+        for (const auto &[deviceId, context] : deviceClientContexts_) {
+            CHECK_AND_CONTINUE(context != nullptr);
+            for (const auto &[portIndex, connection] : context->inputDeviceconnections_) {
+                CHECK_AND_CONTINUE(connection != nullptr);
+                dump += "  device " + std::to_string(deviceId) + " input port " + std::to_string(portIndex) + "\n";
+                connection->Dump(dump);
+            }
+            for (const auto &[portIndex, connection] : context->outputDeviceconnections_) {
+                CHECK_AND_CONTINUE(connection != nullptr);
+                dump += "  device " + std::to_string(deviceId) + " output port " + std::to_string(portIndex) + "\n";
+                connection->Dump(dump);
+            }
+        }
+    }
+    dump += "MIDI output workers\n";
+    for (const auto &stats : MidiOutputWorkerPool::GetInstance().GetStats()) {
+        dump += "  worker " + std::to_string(stats.workerIndex) + ": ports " + std::to_string(stats.portCount) +
+            " wakeups " + std::to_string(stats.wakeups) + " port_runs " + std::to_string(stats.portRuns) +
+            " busy_ns " + std::to_string(stats.busyNs) + "\n";
+    }
+}
+
+void MidiServiceController::DumpClient(uint32_t clientId, std::string &dump)
+{
+    std::lock_guard lock(lock_);
+    dump += "MIDI client " + std::to_string(clientId) + "\n";
+    for (const auto &[deviceId, context] : deviceClientContexts_) {
+        CHECK_AND_CONTINUE(context != nullptr);
+        for (const auto &[portIndex, connection] : context->inputDeviceconnections_) {
+            CHECK_AND_CONTINUE(connection != nullptr && connection->HasClientConnection(clientId));
+            dump += "  device " + std::to_string(deviceId) + " input port " + std::to_string(portIndex) + "\n";
+            connection->DumpClient(clientId, dump);
+        }
+        for (const auto &[portIndex, connection] : context->outputDeviceconnections_) {
+            CHECK_AND_CONTINUE(connection != nullptr && connection->HasClientConnection(clientId));
+            dump += "  device " + std::to_string(deviceId) + " output port " + std::to_string(portIndex) + "\n";
+            connection->DumpClient(clientId, dump);
+        }
+    }
+}
 }  // namespace MIDI
 }  // namespace OHOS
\ No newline at end of file
@@ -0,0 +1,230 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef LOG_TAG
+#define LOG_TAG "MidiTimerWheel"
+#endif
+
+#include "midi_timer_wheel.h"
+
+#include "midi_log.h"
+
+namespace OHOS {
+namespace MIDI {
+namespace {
+inline uint64_t RotateRight(uint64_t value, uint32_t bits)
+{
+    bits &= 63u;  // 64 bit word
+    return bits == 0 ? value : ((value >> bits) | (value << (64u - bits)));
+}
+}
+
+MidiTimerWheel::MidiTimerWheel(size_t maxSlots) : maxSlots_(maxSlots)
+{}
+
+bool MidiTimerWheel::Schedule(uint64_t dueNs, uint64_t timestamp, const uint32_t *words, uint32_t length)
+{
+    CHECK_AND_RETURN_RET(!Full(), false);
+    CHECK_AND_RETURN_RET_LOG(length == 0 || words != nullptr, false, "payload is nullptr");
+    if (size_ == 0) {
+        // nothing filed, the cursor may restart anywhere
+        currentTick_ = dueNs >> TICK_SHIFT;
+    }
+    const uint32_t index = AllocSlot();
+    Slot &slot = At(index);
+    slot.dueNs = dueNs;
+    slot.seq = nextSeq_++;
+    slot.timestamp = timestamp;
+    slot.length = length;
+    if (length <= INLINE_WORDS) {
+        for (uint32_t i = 0; i < length; ++i) {
+            slot.words[i] = words[i];
+        }
+    } else {
+        slot.spill.assign(words, words + length);
+    }
+    File(index);
+    ++size_;
+    return true;
+}
+
+const MidiTimerWheel::Slot *MidiTimerWheel::Front()
+{
+    uint64_t tick = 0;
+    while (ready_.head == INVALID_SLOT && NextBusyTick(tick)) {
+        RunTick(tick);
+    }
+    return ready_.head == INVALID_SLOT ? nullptr : &At(ready_.head);
+}
+
+void MidiTimerWheel::PopFront()
+{
+    CHECK_AND_RETURN(Front() != nullptr);
+    FreeSlot(Unlink(ready_));
+    --size_;
+}
+
+void MidiTimerWheel::Clear()
+{
+    auto release = [this](Bucket &bucket) {
+        while (bucket.head != INVALID_SLOT) {
+            FreeSlot(Unlink(bucket));
+        }
+    };
+    release(ready_);
+    for (uint32_t level = 0; level < LEVELS; ++level) {
+        for (auto &bucket : buckets_[level]) {
+            release(bucket);
+        }
+        occupied_[level] = 0;
+    }
+    size_ = 0;
+}
+
+uint32_t MidiTimerWheel::AllocSlot()
+{
+    if (freeHead_ != INVALID_SLOT) {
+        const uint32_t index = freeHead_;
+        freeHead_ = At(index).next;
+        return index;
+    }
+    if (allocated_ % SLAB_PAGE_SLOTS == 0) {
+        pages_.push_back(std::make_unique<Slot[]>(SLAB_PAGE_SLOTS));
+    }
+    return allocated_++;
+}
+
+void MidiTimerWheel::FreeSlot(uint32_t index)
+{
+    Slot &slot = At(index);
+    slot.prev = INVALID_SLOT;
+    slot.next = freeHead_;
+    freeHead_ = index;
+}
+
+void MidiTimerWheel::File(uint32_t index)
+{
+    Slot &slot = At(index);
+    const uint64_t tick = slot.dueNs >> TICK_SHIFT;
+    if (tick <= currentTick_) {
+        InsertSorted(ready_, index);
+        return;
+    }
+    const uint64_t delta = tick - currentTick_;
+    uint32_t level = 0;
+    while (level + 1 < LEVELS && delta >= (1ull << (LEVEL_BITS * (level + 1)))) {
+        ++level;
+    }
+    const uint32_t shift = LEVEL_BITS * level;
+    uint64_t group = tick >> shift;
+    const uint64_t lastGroup = (currentTick_ >> shift) + SLOTS_PER_LEVEL - 1;
+    if (group > lastGroup) {
+        // beyond the wheel, park in the furthest bucket and re-file when it cascades
+        group = lastGroup;
+    }
+    const uint32_t bucketIndex = static_cast<uint32_t>(group & (SLOTS_PER_LEVEL - 1));
+    Bucket &bucket = buckets_[level][bucketIndex];
+    if (level == 0) {
+        InsertSorted(bucket, index);
+    } else {
+        // order only matters once the event reaches level 0
+        slot.prev = bucket.tail;
+        slot.next = INVALID_SLOT;
+        (bucket.tail == INVALID_SLOT ? bucket.head : At(bucket.tail).next) = index;
+        bucket.tail = index;
+    }
+    occupied_[level] |= 1ull << bucketIndex;
+}
+
+void MidiTimerWheel::InsertSorted(Bucket &bucket, uint32_t index)
+{
+    Slot &slot = At(index);
+    // walk from the tail, events usually arrive in due order so this stops immediately
+    uint32_t after = bucket.tail;
+    while (after != INVALID_SLOT && (At(after).dueNs > slot.dueNs ||
+        (At(after).dueNs == slot.dueNs && At(after).seq > slot.seq))) {
+        after = At(after).prev;
+    }
+    slot.prev = after;
+    slot.next = (after == INVALID_SLOT) ? bucket.head : At(after).next;
+    (after == INVALID_SLOT ? bucket.head : At(after).next) = index;
+    (slot.next == INVALID_SLOT ? bucket.tail : At(slot.next).prev) = index;
+}
+
+uint32_t MidiTimerWheel::Unlink(Bucket &bucket)
+{
+    const uint32_t index = bucket.head;
+    Slot &slot = At(index);
+    bucket.head = slot.next;
+    (bucket.head == INVALID_SLOT ? bucket.tail : At(bucket.head).prev) = INVALID_SLOT;
+    slot.next = INVALID_SLOT;
+    return index;
+}
+
+bool MidiTimerWheel::NextBusyTick(uint64_t &outTick) const
+{
+    bool found = false;
+    for (uint32_t level = 0; level < LEVELS; ++level) {
+        if (occupied_[level] == 0) {
+            continue;
+        }
+        // buckets ahead of the current group, nearest first
+        const uint32_t shift = LEVEL_BITS * level;
+        const uint64_t group = currentTick_ >> shift;
+        const uint64_t ahead = RotateRight(occupied_[level], static_cast<uint32_t>((group + 1) & (SLOTS_PER_LEVEL - 1)));
+        const uint64_t tick = (group + 1 + static_cast<uint64_t>(__builtin_ctzll(ahead))) << shift;
+        if (!found || tick < outTick) {
+            outTick = tick;
+            found = true;
+        }
+    }
+    return found;
+}
+
+void MidiTimerWheel::RunTick(uint64_t tick)
+{
+    currentTick_ = tick;
+    // level 0 holds exactly this tick, already sorted and later than anything in ready_
+    const uint32_t bucketIndex = static_cast<uint32_t>(tick & (SLOTS_PER_LEVEL - 1));
+    Bucket &bucket = buckets_[0][bucketIndex];
+    if (bucket.head != INVALID_SLOT) {
+        At(bucket.head).prev = ready_.tail;
+        (ready_.tail == INVALID_SLOT ? ready_.head : At(ready_.tail).next) = bucket.head;
+        ready_.tail = bucket.tail;
+        bucket = Bucket{};
+        occupied_[0] &= ~(1ull << bucketIndex);
+    }
+    for (uint32_t level = 1; level < LEVELS; ++level) {
+        const uint32_t shift = LEVEL_BITS * level;
+        if ((tick & ((1ull << shift) - 1)) != 0) {
+            break;
+        }
+        Cascade(level, static_cast<uint32_t>((tick >> shift) & (SLOTS_PER_LEVEL - 1)));
+    }
+}
+
+void MidiTimerWheel::Cascade(uint32_t level, uint32_t slot)
+{
+    Bucket &bucket = buckets_[level][slot];
+    uint32_t index = bucket.head;
+    bucket = Bucket{};
+    occupied_[level] &= ~(1ull << slot);
+    while (index != INVALID_SLOT) {
+        const uint32_t next = At(index).next;
+        File(index);
+        index = next;
+    }
+}
+} // namespace MIDI
+} // namespace OHOS
@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LOG_TAG
+#define LOG_TAG "MidiConcurrentSendBenchmark"
+#endif
+
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "midi_shared_ring.h"
+
+namespace OHOS {
+namespace MIDI {
+namespace {
+constexpr uint32_t RING_CAPACITY_BYTES = 4096;
+constexpr uint32_t NOTE_ON = 0x20903C7F;  // MT=2, one word
+
+// shared by the benchmark threads of one run, set up and torn down by thread 0
+std::shared_ptr<MidiSharedRing> g_ring;
+std::mutex g_sendMutex;  // what MidiOutputPort::Send serialises on for a single producer ring
+std::atomic<bool> g_draining{false};
+std::thread g_consumer;
+
+void StartConsumer(MidiRingFormat format)
+{
+    g_ring = MidiSharedRing::CreateFromLocal(RING_CAPACITY_BYTES, format);
+    g_draining.store(true);
+    g_consumer = std::thread([]() {
+        std::vector<OH_MIDIEvent> views;
+        while (g_draining.load(std::memory_order_relaxed)) {
+            if (g_ring->PeekBatch(views) == MidiStatusCode::OK) {
+                g_ring->CommitBatch();
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+}
+
+void StopConsumer()
+{
+    g_draining.store(false);
+    g_consumer.join();
+    g_ring.reset();
+}
+
+// one single producer ring per sending thread, drained in turn like the service merges output lanes
+std::vector<std::shared_ptr<MidiSharedRing>> g_lanes;
+
+void StartLaneConsumer(size_t laneCount)
+{
+    g_lanes.clear();
+    for (size_t i = 0; i < laneCount; ++i) {
+        g_lanes.push_back(MidiSharedRing::CreateFromLocal(RING_CAPACITY_BYTES));
+    }
+    g_draining.store(true);
+    g_consumer = std::thread([]() {
+        std::vector<OH_MIDIEvent> views;
+        while (g_draining.load(std::memory_order_relaxed)) {
+            bool drained = false;
+            for (const auto &lane : g_lanes) {
+                if (lane->PeekBatch(views) == MidiStatusCode::OK) {
+                    lane->CommitBatch();
+                    drained = true;
+                }
+            }
+            if (!drained) {
+                std::this_thread::yield();
+            }
+        }
+    });
+}
+
+void StopLaneConsumer()
+{
+    g_draining.store(false);
+    g_consumer.join();
+    g_lanes.clear();
+}
+} // namespace
+
+/**
+ * Several threads sending one event per call to the same output ring while a consumer drains it.
+ * range(0): MidiRingFormat, STANDARD senders take a shared mutex like MidiOutputPort::Send does,
+ * MULTI_PRODUCER senders reserve their records lock-free.
+ */
+static void BM_ConcurrentSend(benchmark::State &state)
+{
+    const auto format = static_cast<MidiRingFormat>(state.range(0));
+    if (state.thread_index() == 0) {
+        StartConsumer(format);
+    }
+    const uint32_t payload = NOTE_ON;
+    const MidiEventInner event{0, 1, &payload};
+    int64_t retries = 0;
+    for (auto _ : state) {
+        for (;;) {
+            MidiStatusCode status = MidiStatusCode::OK;
+            if (format == MidiRingFormat::MULTI_PRODUCER) {
+                status = g_ring->TryWriteEvent(event, false);
+            } else {
+                std::lock_guard<std::mutex> lock(g_sendMutex);
+                status = g_ring->TryWriteEvent(event, false);
+            }
+            if (status == MidiStatusCode::OK) {
+                break;
+            }
+            // ring full, give the consumer a chance
+            ++retries;
+            std::this_thread::yield();
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["full_retries"] = benchmark::Counter(static_cast<double>(retries), benchmark::Counter::kAvgThreads);
+    if (state.thread_index() == 0) {
+        StopConsumer();
+    }
+}
+BENCHMARK(BM_ConcurrentSend)
+    ->Arg(static_cast<int64_t>(MidiRingFormat::STANDARD))
+    ->Arg(static_cast<int64_t>(MidiRingFormat::MULTI_PRODUCER))
+    ->ThreadRange(1, 8)
+    ->UseRealTime();
+
+/**
+ * Same load with one lane per sending thread: no lock and no shared cursor on the send path,
+ * the consumer pays for visiting every lane instead.
+ */
+static void BM_LaneSend(benchmark::State &state)
+{
+    if (state.thread_index() == 0) {
+        StartLaneConsumer(static_cast<size_t>(state.threads()));
+    }
+    const uint32_t payload = NOTE_ON;
+    const MidiEventInner event{0, 1, &payload};
+    int64_t retries = 0;
+    for (auto _ : state) {
+        MidiSharedRing &lane = *g_lanes[state.thread_index()];
+        while (lane.TryWriteEvent(event, false) != MidiStatusCode::OK) {
+            ++retries;
+            std::this_thread::yield();
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["full_retries"] = benchmark::Counter(static_cast<double>(retries), benchmark::Counter::kAvgThreads);
+    if (state.thread_index() == 0) {
+        StopLaneConsumer();
+    }
+}
+BENCHMARK(BM_LaneSend)->ThreadRange(1, 8)->UseRealTime();
+} // namespace MIDI
+} // namespace OHOS
+
+BENCHMARK_MAIN();
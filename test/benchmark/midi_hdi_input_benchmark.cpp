@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef LOG_TAG
+#define LOG_TAG "MidiHdiInputBenchmark"
+#endif
+
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "fake_midi_hdi.h"
+#include "midi_device_usb.h"
+#include "native_midi_base.h"
+
+namespace OHOS {
+namespace MIDI {
+namespace {
+constexpr int64_t DEVICE_ID = 1;
+constexpr uint32_t PORT_INDEX = 0;
+constexpr uint32_t RING_CAPACITY_BYTES = 64 * 1024;
+constexpr uint32_t NOTE_ON = 0x20903C7F;  // MT=2, one word
+
+/**
+ * Device bursts of range(0) events from the in-process fake HDI to the driver's input callback.
+ * range(1) == 0 marshals a MidiMessage vector per burst and calls IMidiCallback, the path every HDI takes today
+ * (the binder transaction a real HDI adds on top is not part of this number); range(1) == 1 writes the shared
+ * ring and waits for the service side reader to hand the burst over.
+ */
+static void BM_HdiInputBurst(benchmark::State &state)
+{
+    const auto burst = static_cast<uint32_t>(state.range(0));
+    const bool sharedRing = state.range(1) != 0;
+    sptr<FakeMidiHdi> fakeHdi = sptr<FakeMidiHdi>::MakeSptr(RING_CAPACITY_BYTES);
+    UsbMidiTransportDeviceDriver driver;
+    driver.midiHdi_ = fakeHdi;
+    if (sharedRing) {
+        driver.SetSharedInput(fakeHdi->GetSharedInput());
+    }
+    std::atomic<uint64_t> delivered{0};
+    UmpInputCallback callback = [&delivered](std::vector<MidiEventInner> &events) {
+        delivered.fetch_add(events.size(), std::memory_order_release);
+    };
+    if (driver.OpenInputPort(DEVICE_ID, PORT_INDEX, callback) != MIDI_STATUS_OK) {
+        state.SkipWithError("open input port failed");
+        return;
+    }
+    std::vector<MidiEventInner> events(burst, MidiEventInner{0, 1, &NOTE_ON});
+    uint64_t expected = 0;
+    for (auto _ : state) {
+        for (uint32_t i = 0; i < burst; ++i) {
+            events[i].timestamp = expected + i;
+        }
+        expected += fakeHdi->Inject(DEVICE_ID, PORT_INDEX, events);
+        while (delivered.load(std::memory_order_acquire) < expected) {
+            std::this_thread::yield();
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(expected));
+    (void)driver.CloseInputPort(DEVICE_ID, PORT_INDEX);
+}
+BENCHMARK(BM_HdiInputBurst)
+    ->ArgsProduct({{1, 8, 64}, {0, 1}})
+    ->ArgNames({"burst", "ring"})
+    ->UseRealTime();
+} // namespace
+} // namespace MIDI
+} // namespace OHOS
+
+BENCHMARK_MAIN();
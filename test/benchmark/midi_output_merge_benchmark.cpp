@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef LOG_TAG
+#define LOG_TAG "MidiOutputMergeBenchmark"
+#endif
+
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "midi_device_connection.h"
+#include "native_midi_base.h"
+
+namespace OHOS {
+namespace MIDI {
+namespace {
+constexpr uint32_t EVENTS_PER_ROUND = 4096;
+constexpr uint32_t NOTE_ON = 0x20903C7F;  // MT=2, one word
+
+class NullDriver : public MidiDeviceDriver {
+public:
+    std::vector<DeviceInformation> GetRegisteredDevices() override { return {}; }
+    int32_t OpenDevice(int64_t deviceId) override { return MIDI_STATUS_OK; }
+    int32_t OpenDevice(std::string deviceAddr, BleDriverCallback deviceCallback) override { return MIDI_STATUS_OK; }
+    int32_t CloseDevice(int64_t deviceId) override { return MIDI_STATUS_OK; }
+    int32_t OpenInputPort(int64_t deviceId, uint32_t portIndex, UmpInputCallback cb) override { return MIDI_STATUS_OK; }
+    int32_t OpenOutputPort(int64_t deviceId, uint32_t portIndex) override { return MIDI_STATUS_OK; }
+    int32_t CloseInputPort(int64_t deviceId, uint32_t portIndex) override { return MIDI_STATUS_OK; }
+    int32_t CloseOutputPort(int64_t deviceId, uint32_t portIndex) override { return MIDI_STATUS_OK; }
+    int32_t HanleUmpInput(int64_t deviceId, uint32_t portIndex, std::vector<MidiEventInner> &list) override
+    {
+        sent += list.size();
+        return MIDI_STATUS_OK;
+    }
+    size_t sent = 0;
+};
+
+struct MergeFixture {
+    explicit MergeFixture(uint32_t clientCount) : connection(MakeInfo(&driver))
+    {
+        for (uint32_t i = 0; i < clientCount; ++i) {
+            std::shared_ptr<MidiSharedRing> ring;
+            (void)connection.AddClientConnection(i, 0, ring);
+        }
+        connection.RefreshClientsSnapshot();
+    }
+
+    static DeviceConnectionInfo MakeInfo(MidiDeviceDriver *driver)
+    {
+        DeviceConnectionInfo info{};
+        info.driver = driver;
+        info.direction = MidiPortDirection::OUTPUT;
+        return info;
+    }
+
+    // round robin over clients with increasing due times, all already in the past
+    void ScheduleRound()
+    {
+        const auto &clients = *connection.clientsSnapshot_;
+        for (uint32_t i = 0; i < EVENTS_PER_ROUND; ++i) {
+            const auto due = std::chrono::steady_clock::time_point(std::chrono::nanoseconds(i + 1));
+            (void)clients[i % clients.size()]->EnqueueNonRealtime(&NOTE_ON, 1, due, i + 1);
+        }
+    }
+
+    NullDriver driver;
+    DeviceConnectionForOutput connection;
+};
+} // namespace
+
+// port-level heap of client heads
+static void BM_CollectDueHeap(benchmark::State &state)
+{
+    MergeFixture fixture(static_cast<uint32_t>(state.range(0)));
+    for (auto _ : state) {
+        state.PauseTiming();
+        fixture.ScheduleRound();
+        state.ResumeTiming();
+        fixture.connection.CollectDueEventsFromClientHeaps();
+        fixture.connection.FlushSendCacheToDriver();
+    }
+    state.SetItemsProcessed(state.iterations() * EVENTS_PER_ROUND);
+}
+BENCHMARK(BM_CollectDueHeap)->RangeMultiplier(2)->Range(1, 64);
+
+// reference: the previous per-event scan over every client
+static void BM_CollectDueLinearScan(benchmark::State &state)
+{
+    MergeFixture fixture(static_cast<uint32_t>(state.range(0)));
+    auto &connection = fixture.connection;
+    for (auto _ : state) {
+        state.PauseTiming();
+        fixture.ScheduleRound();
+        state.ResumeTiming();
+        while (true) {
+            ClientConnectionInServer *earliest = nullptr;
+            std::chrono::steady_clock::time_point earliestDue{};
+            for (const auto &client : *connection.clientsSnapshot_) {
+                const auto *top = client->PeekPendingTop();
+                if (top != nullptr && (earliest == nullptr || top->due < earliestDue)) {
+                    earliest = client.get();
+                    earliestDue = top->due;
+                }
+            }
+            if (earliest == nullptr || earliestDue > std::chrono::steady_clock::now()) {
+                break;
+            }
+            ClientConnectionInServer::PendingEvent dueEvent;
+            (void)earliest->PopPendingTop(dueEvent);
+            if (!connection.TryAppendToSendCache(dueEvent.timestamp, dueEvent.data, dueEvent.length)) {
+                connection.FlushSendCacheToDriver();
+                (void)connection.TryAppendToSendCache(dueEvent.timestamp, dueEvent.data, dueEvent.length);
+            }
+        }
+        connection.FlushSendCacheToDriver();
+    }
+    state.SetItemsProcessed(state.iterations() * EVENTS_PER_ROUND);
+}
+BENCHMARK(BM_CollectDueLinearScan)->RangeMultiplier(2)->Range(1, 64);
+} // namespace MIDI
+} // namespace OHOS
+
+BENCHMARK_MAIN();
@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LOG_TAG
+#define LOG_TAG "MidiSharedRingBenchmark"
+#endif
+
+#include <benchmark/benchmark.h>
+#include <vector>
+
+#include "midi_shared_ring.h"
+
+namespace OHOS {
+namespace MIDI {
+namespace {
+constexpr uint32_t RING_CAPACITY_BYTES = 2048;
+constexpr uint32_t LARGE_RING_CAPACITY_BYTES = 32768;
+constexpr uint32_t SEND_BATCH_EVENTS = 1000;
+constexpr uint32_t NOTE_ON = 0x20903C7F;  // MT=2, one word
+constexpr uint64_t EVENT_INTERVAL_NS = 1000;
+
+std::vector<MidiEventInner> MakeNoteEvents(const std::vector<uint32_t> &payload, uint32_t count)
+{
+    std::vector<MidiEventInner> events(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        events[i].timestamp = (i + 1) * EVENT_INTERVAL_NS;
+        events[i].length = payload.size();
+        events[i].data = payload.data();
+    }
+    return events;
+}
+} // namespace
+
+// how many one-word events an empty ring holds, and how many ring bytes each one costs
+static void BM_RingFill(benchmark::State &state)
+{
+    const auto format = static_cast<MidiRingFormat>(state.range(0));
+    const std::vector<uint32_t> payload = {NOTE_ON};
+    const auto events = MakeNoteEvents(payload, RING_CAPACITY_BYTES);
+    auto ring = MidiSharedRing::CreateFromLocal(RING_CAPACITY_BYTES, format);
+    if (ring == nullptr) {
+        state.SkipWithError("create ring failed");
+        return;
+    }
+
+    uint32_t written = 0;
+    std::vector<OH_MIDIEvent> views;
+    for (auto _ : state) {
+        ring->TryWriteEvents(events.data(), events.size(), &written, false);
+        state.PauseTiming();
+        ring->PeekBatch(views);
+        ring->CommitBatch();
+        state.ResumeTiming();
+    }
+    state.counters["events_per_ring"] = written;
+    state.counters["bytes_per_event"] = written == 0 ? 0.0 : static_cast<double>(RING_CAPACITY_BYTES) / written;
+}
+BENCHMARK(BM_RingFill)->Arg(static_cast<int64_t>(MidiRingFormat::STANDARD))
+    ->Arg(static_cast<int64_t>(MidiRingFormat::COMPACT));
+
+// steady state write + zero-copy read of batchSize one-word events
+static void BM_RingWriteRead(benchmark::State &state)
+{
+    const auto format = static_cast<MidiRingFormat>(state.range(0));
+    const uint32_t batchSize = static_cast<uint32_t>(state.range(1));
+    const std::vector<uint32_t> payload = {NOTE_ON};
+    const auto events = MakeNoteEvents(payload, batchSize);
+    auto ring = MidiSharedRing::CreateFromLocal(RING_CAPACITY_BYTES, format);
+    if (ring == nullptr) {
+        state.SkipWithError("create ring failed");
+        return;
+    }
+
+    uint64_t totalEvents = 0;
+    uint64_t totalBytes = 0;
+    std::vector<OH_MIDIEvent> views;
+    views.reserve(batchSize);
+    for (auto _ : state) {
+        uint32_t written = 0;
+        const uint32_t before = ring->GetWritePosition();
+        ring->TryWriteEvents(events.data(), events.size(), &written, false);
+        const uint32_t after = ring->GetWritePosition();
+        ring->PeekBatch(views);
+        benchmark::DoNotOptimize(views.data());
+        ring->CommitBatch();
+        totalEvents += written;
+        totalBytes += (after >= before) ? (after - before) : (RING_CAPACITY_BYTES - before + after);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(totalEvents));
+    state.counters["bytes_per_event"] = totalEvents == 0 ? 0.0 : static_cast<double>(totalBytes) / totalEvents;
+}
+BENCHMARK(BM_RingWriteRead)->ArgsProduct({
+    {static_cast<int64_t>(MidiRingFormat::STANDARD), static_cast<int64_t>(MidiRingFormat::COMPACT)}, {1, 16, 64}});
+
+// one large OH_MIDISend style batch into a ring big enough to take it whole
+static void BM_RingBulkWrite(benchmark::State &state)
+{
+    const auto format = static_cast<MidiRingFormat>(state.range(0));
+    const std::vector<uint32_t> payload = {NOTE_ON};
+    const auto events = MakeNoteEvents(payload, SEND_BATCH_EVENTS);
+    auto ring = MidiSharedRing::CreateFromLocal(LARGE_RING_CAPACITY_BYTES, format);
+    if (ring == nullptr) {
+        state.SkipWithError("create ring failed");
+        return;
+    }
+
+    std::vector<OH_MIDIEvent> views;
+    views.reserve(SEND_BATCH_EVENTS);
+    uint64_t totalEvents = 0;
+    for (auto _ : state) {
+        uint32_t written = 0;
+        ring->TryWriteEvents(events.data(), events.size(), &written, false);
+        totalEvents += written;
+        state.PauseTiming();
+        ring->PeekBatch(views);
+        ring->CommitBatch();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(totalEvents));
+}
+BENCHMARK(BM_RingBulkWrite)->Arg(static_cast<int64_t>(MidiRingFormat::STANDARD))
+    ->Arg(static_cast<int64_t>(MidiRingFormat::COMPACT));
+} // namespace MIDI
+} // namespace OHOS
+
+BENCHMARK_MAIN();
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LOG_TAG
+#define LOG_TAG "MidiSysExBenchmark"
+#endif
+
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "midi_client_private.h"
+#include "ump_processor.h"
+
+namespace OHOS {
+namespace MIDI {
+namespace {
+constexpr uint32_t RING_CAPACITY_BYTES = 2048;
+constexpr int64_t CONSUMER_WAIT_NS = 1000 * 1000;
+constexpr int64_t MEGABYTE = 1024 * 1024;
+
+std::vector<uint8_t> MakeSysEx(size_t dataBytes)
+{
+    std::vector<uint8_t> sysEx(dataBytes + 2);
+    sysEx.front() = 0xF0;
+    sysEx.back() = 0xF7;
+    for (size_t i = 0; i < dataBytes; ++i) {
+        sysEx[i + 1] = static_cast<uint8_t>(i & 0x7F);
+    }
+    return sysEx;
+}
+
+// stands in for the service output worker: drain, then release the sender
+class RingDrainer {
+public:
+    explicit RingDrainer(std::shared_ptr<MidiSharedRing> ring) : ring_(std::move(ring))
+    {
+        worker_ = std::thread([this]() { Loop(); });
+    }
+    ~RingDrainer()
+    {
+        running_.store(false);
+        ring_->NotifyConsumer();
+        worker_.join();
+    }
+
+private:
+    void Loop()
+    {
+        std::vector<OH_MIDIEvent> views;
+        while (running_.load()) {
+            (void)ring_->WaitFor(CONSUMER_WAIT_NS, [this]() { return !ring_->IsEmpty() || !running_.load(); });
+            if (ring_->PeekBatch(views) == MidiStatusCode::OK) {
+                ring_->CommitBatch();
+                ring_->NotifyProducer();
+            }
+        }
+    }
+
+    std::shared_ptr<MidiSharedRing> ring_;
+    std::atomic<bool> running_{true};
+    std::thread worker_;
+};
+} // namespace
+
+// OH_MIDISendSysEx path: batched MT=3 packets, parks on the space futex when the ring is full
+static void BM_SysExSend(benchmark::State &state)
+{
+    const auto sysEx = MakeSysEx(static_cast<size_t>(state.range(0)));
+    MidiOutputPort outputPort(MIDI_PROTOCOL_1_0);
+    outputPort.GetRingBuffer() = MidiSharedRing::CreateFromLocal(RING_CAPACITY_BYTES);
+    RingDrainer drainer(outputPort.GetRingBuffer());
+
+    for (auto _ : state) {
+        if (outputPort.SendSysEx(sysEx.data(), sysEx.size()) != MIDI_STATUS_OK) {
+            state.SkipWithError("send sysex failed");
+            break;
+        }
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(sysEx.size()));
+}
+BENCHMARK(BM_SysExSend)->Arg(MEGABYTE)->Arg(4 * MEGABYTE)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// what applications did before: fragment by hand, one OH_MIDISend per packet, spin on WOULD_BLOCK
+static void BM_SysExPerPacketSend(benchmark::State &state)
+{
+    const auto sysEx = MakeSysEx(static_cast<size_t>(state.range(0)));
+    MidiOutputPort outputPort(MIDI_PROTOCOL_1_0);
+    outputPort.GetRingBuffer() = MidiSharedRing::CreateFromLocal(RING_CAPACITY_BYTES);
+    RingDrainer drainer(outputPort.GetRingBuffer());
+
+    uint64_t retries = 0;
+    for (auto _ : state) {
+        UmpProcessor processor;
+        processor.ProcessBytes(sysEx.data(), sysEx.size(), [&outputPort, &retries](const UmpPacket &packet) {
+            uint32_t words[UmpPacket::MAX_WORD_COUNT] = {packet.Word(0), packet.Word(1)};
+            OH_MIDIEvent event{0, packet.WordCount(), words};
+            uint32_t written = 0;
+            while (outputPort.Send(&event, 1, &written) == MIDI_STATUS_WOULD_BLOCK) {
+                ++retries;
+                std::this_thread::yield();
+            }
+        });
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(sysEx.size()));
+    state.counters["retries"] = benchmark::Counter(static_cast<double>(retries), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_SysExPerPacketSend)->Arg(MEGABYTE)->Arg(4 * MEGABYTE)->Unit(benchmark::kMillisecond)->UseRealTime();
+} // namespace MIDI
+} // namespace OHOS
+
+BENCHMARK_MAIN();
@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef LOG_TAG
+#define LOG_TAG "MidiThreadJitterBenchmark"
+#endif
+
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <atomic>
+#include <ctime>
+#include <thread>
+#include <vector>
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "midi_thread_config.h"
+
+namespace OHOS {
+namespace MIDI {
+namespace {
+constexpr int64_t PERIOD_NS = 1000000;  // 1ms, a dense sequencer tick
+constexpr int64_t NS_PER_SECOND = 1000000000;
+constexpr double NS_PER_US = 1000.0;
+constexpr int32_t RT_PRIORITY = 2;
+constexpr int BENCH_ITERATIONS = 2000;
+
+int64_t NowNs()
+{
+    timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * NS_PER_SECOND + ts.tv_nsec;
+}
+
+// one busy thread per cpu, all at default priority
+class CpuContention {
+public:
+    explicit CpuContention(bool enabled)
+    {
+        const unsigned cpuCount = enabled ? std::max(1u, std::thread::hardware_concurrency()) : 0;
+        for (unsigned i = 0; i < cpuCount; ++i) {
+            threads_.emplace_back([this]() {
+                volatile uint64_t sink = 0;
+                while (!stop_.load(std::memory_order_relaxed)) {
+                    sink = sink + 1;
+                }
+            });
+        }
+    }
+    ~CpuContention()
+    {
+        stop_.store(true);
+        for (auto &thread : threads_) {
+            thread.join();
+        }
+    }
+
+private:
+    std::atomic<bool> stop_{false};
+    std::vector<std::thread> threads_;
+};
+
+// restores the benchmark thread after a config was applied to it
+class SchedulingGuard {
+public:
+    SchedulingGuard()
+    {
+        (void)pthread_getschedparam(pthread_self(), &policy_, &param_);
+        nice_ = getpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)));
+    }
+    ~SchedulingGuard()
+    {
+        (void)pthread_setschedparam(pthread_self(), policy_, &param_);
+        (void)setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), nice_);
+    }
+
+private:
+    int policy_ = SCHED_OTHER;
+    sched_param param_{};
+    int nice_ = 0;
+};
+} // namespace
+
+// wake-up lateness of a periodic thread, args: {policy (0 normal, 1 fifo), contention (0/1)}
+static void BM_PeriodicWakeJitter(benchmark::State &state)
+{
+    // started first, threads inherit the scheduling of their creator
+    CpuContention contention(state.range(1) != 0);
+    SchedulingGuard guard;
+    MidiThreadConfig config;
+    config.policy = static_cast<MidiSchedPolicy>(state.range(0));
+    config.priority = RT_PRIORITY;
+    const MidiSchedPolicy applied = MidiThreadTool::ApplyToCurrentThread(config);
+
+    std::vector<int64_t> latenessNs;
+    latenessNs.reserve(BENCH_ITERATIONS);
+    int64_t target = NowNs() + PERIOD_NS;
+    for (auto _ : state) {
+        timespec ts{static_cast<time_t>(target / NS_PER_SECOND), static_cast<long>(target % NS_PER_SECOND)};
+        (void)clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr);
+        latenessNs.push_back(NowNs() - target);
+        target += PERIOD_NS;
+    }
+
+    std::sort(latenessNs.begin(), latenessNs.end());
+    auto percentile = [&latenessNs](double p) {
+        return static_cast<double>(latenessNs[static_cast<size_t>(p * (latenessNs.size() - 1))]) / NS_PER_US;
+    };
+    state.counters["p50_us"] = percentile(0.5);    // 0.5: median
+    state.counters["p99_us"] = percentile(0.99);   // 0.99: tail
+    state.counters["max_us"] = percentile(1.0);
+    state.counters["rt"] = applied == MidiSchedPolicy::NORMAL ? 0 : 1;
+}
+BENCHMARK(BM_PeriodicWakeJitter)
+    ->ArgsProduct({{static_cast<int64_t>(MidiSchedPolicy::NORMAL), static_cast<int64_t>(MidiSchedPolicy::FIFO)},
+        {0, 1}})
+    ->Iterations(BENCH_ITERATIONS)
+    ->UseRealTime();
+} // namespace MIDI
+} // namespace OHOS
+
+BENCHMARK_MAIN();
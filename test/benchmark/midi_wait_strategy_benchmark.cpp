@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LOG_TAG
+#define LOG_TAG "MidiWaitStrategyBenchmark"
+#endif
+
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "midi_shared_ring.h"
+
+namespace OHOS {
+namespace MIDI {
+namespace {
+constexpr uint32_t RING_CAPACITY_BYTES = 2048;
+constexpr uint32_t NOTE_ON = 0x20903C7F;  // MT=2, one word
+constexpr int64_t ECHO_WAIT_NS = 100000000;  // lets the echo thread notice the end of a run
+
+// one ping: write into `to`, then wait on `from` until an event shows up and consume it
+bool WaitAndConsume(MidiSharedRing &from, const std::atomic<bool> &running)
+{
+    std::vector<OH_MIDIEvent> events;
+    while (from.PeekBatch(events) != MidiStatusCode::OK) {
+        if (!running.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        (void)from.WaitFor(ECHO_WAIT_NS, [&from, &running]() {
+            return !from.IsEmpty() || !running.load(std::memory_order_relaxed);
+        });
+    }
+    from.CommitBatch();
+    return true;
+}
+
+void BusyDelay(int64_t ns)
+{
+    const int64_t end = ClockTime::GetCurNano() + ns;
+    while (ClockTime::GetCurNano() < end) {
+    }
+}
+} // namespace
+
+/**
+ * Round trip of one event between two threads over a pair of rings, both sides waiting with the same strategy.
+ * range(0): MidiWaitStrategy, range(1): ns the pinging side works between round trips, which is the gap the
+ * adaptive spin budget has to cover.
+ */
+static void BM_RingPingPong(benchmark::State &state)
+{
+    const auto strategy = static_cast<MidiWaitStrategy>(state.range(0));
+    const int64_t gapNs = state.range(1);
+    auto ping = MidiSharedRing::CreateFromLocal(RING_CAPACITY_BYTES);
+    auto pong = MidiSharedRing::CreateFromLocal(RING_CAPACITY_BYTES);
+    if (ping == nullptr || pong == nullptr) {
+        state.SkipWithError("create ring failed");
+        return;
+    }
+    ping->SetWaitStrategy(strategy);
+    pong->SetWaitStrategy(strategy);
+    const uint32_t payload = NOTE_ON;
+    const MidiEventInner event{1, 1, &payload};
+
+    std::atomic<bool> running{true};
+    std::thread echo([&]() {
+        while (WaitAndConsume(*ping, running)) {
+            (void)pong->TryWriteEvent(event);
+        }
+    });
+    for (auto _ : state) {
+        (void)ping->TryWriteEvent(event);
+        (void)WaitAndConsume(*pong, running);
+        state.PauseTiming();
+        BusyDelay(gapNs);
+        state.ResumeTiming();
+    }
+    running.store(false);
+    ping->NotifyConsumer();
+    echo.join();
+    state.counters["spin_budget_ns"] = static_cast<double>(pong->GetWaiter().GetSpinBudgetNs());
+}
+BENCHMARK(BM_RingPingPong)->ArgsProduct({
+    {static_cast<int64_t>(MidiWaitStrategy::PARK), static_cast<int64_t>(MidiWaitStrategy::ADAPTIVE)},
+    {0, 20000, 200000}})->UseRealTime();
+} // namespace MIDI
+} // namespace OHOS
+
+BENCHMARK_MAIN();
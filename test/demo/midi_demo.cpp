@@ -63,6 +63,12 @@ static void OnError(void *userData, OH_MIDIStatusCode code)
     cout << "[Error] Critical Service Error! Code=" << code << endl;
 }
 
+static void OnInputOverflow(void *userData, int64_t deviceId, uint32_t portIndex, uint32_t lostEvents)
+{
+    (void)userData;
+    cout << "[Overflow] Device " << deviceId << " port " << portIndex << " lost " << lostEvents << " events" << endl;
+}
+
 // 3. 数据接收回调
 static void OnMidiReceived(void *userData, const OH_MIDIEvent *events, size_t eventCount)
 {
@@ -136,7 +142,7 @@ static int RunMidiDemo()
     cout << "Starting MIDI Demo..." << endl;
 
     OH_MIDIClient *client = nullptr;
-    OH_MIDICallbacks callbacks = {OnDeviceChange, OnError};
+    OH_MIDICallbacks callbacks = {OnDeviceChange, OnError, OnInputOverflow};
 
     if (OH_MIDIClientCreate(&client, callbacks, nullptr) != MIDI_STATUS_OK) {
         cout << "Failed to create MIDI client." << endl;
@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef FAKE_MIDI_HDI_H
+#define FAKE_MIDI_HDI_H
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "midi_hdi_input_ring.h"
+#include "midi_shared_ring.h"
+#include "native_midi_base.h"
+#include "v1_0/imidi_interface.h"
+
+namespace OHOS {
+namespace MIDI {
+
+// HDI side of the shared input rings: creates one ring per opened port, Write is its single producer
+class FakeMidiHdiSharedInput : public MidiHdiSharedInput {
+public:
+    explicit FakeMidiHdiSharedInput(uint32_t ringBytes = 4096) : ringBytes_(ringBytes) {}
+
+    int32_t OpenInputRing(int64_t deviceId, uint32_t portId, std::shared_ptr<MidiSharedRing> &ring) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ring = MidiSharedRing::CreateFromLocal(ringBytes_);
+        if (ring == nullptr) {
+            return MIDI_STATUS_UNKNOWN_ERROR;
+        }
+        rings_[{deviceId, portId}] = PortRing{ring, 0};
+        return MIDI_STATUS_OK;
+    }
+
+    int32_t CloseInputRing(int64_t deviceId, uint32_t portId) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return rings_.erase({deviceId, portId}) != 0 ? MIDI_STATUS_OK : MIDI_STATUS_INVALID_PORT;
+    }
+
+    bool HasRing(int64_t deviceId, uint32_t portId)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return rings_.count({deviceId, portId}) != 0;
+    }
+
+    // writes like ClientConnectionInServer does: a full ring drops the rest and the next write leads with a marker
+    uint32_t Write(int64_t deviceId, uint32_t portId, const std::vector<MidiEventInner> &events)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = rings_.find({deviceId, portId});
+        if (it == rings_.end() || events.empty()) {
+            return 0;
+        }
+        PortRing &port = it->second;
+        if (port.unreportedDrops != 0) {
+            const uint32_t markerWords[MIDI_RING_OVERFLOW_MARKER_WORDS] = {MIDI_RING_OVERFLOW_MARKER,
+                port.unreportedDrops};
+            const MidiEventInner marker{events[0].timestamp, MIDI_RING_OVERFLOW_MARKER_WORDS, markerWords};
+            if (port.ring->TryWriteEvent(marker, false) != MidiStatusCode::OK) {
+                port.unreportedDrops += static_cast<uint32_t>(events.size());
+                return 0;
+            }
+            port.unreportedDrops = 0;
+        }
+        uint32_t written = 0;
+        (void)port.ring->TryWriteEvents(events.data(), static_cast<uint32_t>(events.size()), &written);
+        port.unreportedDrops += static_cast<uint32_t>(events.size()) - written;
+        return written;
+    }
+
+private:
+    struct PortRing {
+        std::shared_ptr<MidiSharedRing> ring;
+        uint32_t unreportedDrops;
+    };
+    uint32_t ringBytes_;
+    std::mutex mutex_;
+    std::map<std::pair<int64_t, uint32_t>, PortRing> rings_;
+};
+
+/**
+ * In-process stand-in for the USB MIDI HDI. Inject plays the device: it writes into the port's shared ring when the
+ * port was opened in ring mode, otherwise it marshals a MidiMessage vector per burst and calls the port callback
+ * the way the HDI proxy does.
+ */
+class FakeMidiHdi : public HDI::Midi::V1_0::IMidiInterface {
+public:
+    explicit FakeMidiHdi(uint32_t ringBytes = 4096)
+        : sharedInput_(std::make_shared<FakeMidiHdiSharedInput>(ringBytes)) {}
+
+    int32_t GetDeviceList(std::vector<HDI::Midi::V1_0::MidiDeviceInfo> &deviceList) override
+    {
+        deviceList.clear();
+        return MIDI_STATUS_OK;
+    }
+    int32_t OpenDevice(int64_t deviceId) override { return MIDI_STATUS_OK; }
+    int32_t CloseDevice(int64_t deviceId) override { return MIDI_STATUS_OK; }
+    int32_t OpenInputPort(int64_t deviceId, uint32_t portId,
+        const sptr<HDI::Midi::V1_0::IMidiCallback> &dataCallback) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        callbacks_[{deviceId, portId}] = dataCallback;
+        return MIDI_STATUS_OK;
+    }
+    int32_t OpenOutputPort(int64_t deviceId, uint32_t portId) override { return MIDI_STATUS_OK; }
+    int32_t CloseInputPort(int64_t deviceId, uint32_t portId) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return callbacks_.erase({deviceId, portId}) != 0 ? MIDI_STATUS_OK : MIDI_STATUS_INVALID_PORT;
+    }
+    int32_t CloseOutputPort(int64_t deviceId, uint32_t portId) override { return MIDI_STATUS_OK; }
+    int32_t SendMidiMessages(int64_t deviceId, uint32_t portId,
+        const std::vector<HDI::Midi::V1_0::MidiMessage> &messages) override
+    {
+        return MIDI_STATUS_OK;
+    }
+
+    std::shared_ptr<FakeMidiHdiSharedInput> GetSharedInput() const { return sharedInput_; }
+
+    // one device burst, returns how many events were delivered or queued
+    uint32_t Inject(int64_t deviceId, uint32_t portId, const std::vector<MidiEventInner> &events)
+    {
+        if (sharedInput_->HasRing(deviceId, portId)) {
+            return sharedInput_->Write(deviceId, portId, events);
+        }
+        sptr<HDI::Midi::V1_0::IMidiCallback> callback = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = callbacks_.find({deviceId, portId});
+            if (it == callbacks_.end()) {
+                return 0;
+            }
+            callback = it->second;
+        }
+        std::vector<HDI::Midi::V1_0::MidiMessage> messages;
+        messages.reserve(events.size());
+        for (const auto &event : events) {
+            HDI::Midi::V1_0::MidiMessage message;
+            message.timestamp = static_cast<int64_t>(event.timestamp);
+            message.data.assign(event.data, event.data + event.length);
+            messages.push_back(std::move(message));
+        }
+        (void)callback->OnMidiDataReceived(messages);
+        return static_cast<uint32_t>(events.size());
+    }
+
+private:
+    std::shared_ptr<FakeMidiHdiSharedInput> sharedInput_;
+    std::mutex mutex_;
+    std::map<std::pair<int64_t, uint32_t>, sptr<HDI::Midi::V1_0::IMidiCallback>> callbacks_;
+};
+} // namespace MIDI
+} // namespace OHOS
+#endif
@@ -373,4 +373,70 @@ HWTEST_F(FutexToolUnitTest, FutexWait_NegativeTimeout_001, TestSize.Level0)
     FutexCode ret = FutexTool::FutexWait(&testFutex_, 0, pred);
     EXPECT_EQ(ret, FUTEX_SUCCESS);
     EXPECT_TRUE(nullTimeoutPtr);
-}
\ No newline at end of file
+}
+/**
+ * @tc.name: AdaptiveWait_001
+ * @tc.desc: an event arriving during the spin phase is picked up without publishing IS_NOT_READY or a syscall
+ * @tc.type: FUNC
+ */
+HWTEST_F(FutexToolUnitTest, AdaptiveWait_001, TestSize.Level0)
+{
+    int syscalls = 0;
+    FutexTool::SetStubFunc([&syscalls](std::atomic<uint32_t> *, int, int, const struct timespec *) -> long {
+        syscalls++;
+        return 0;
+    }, nullptr);
+    int checks = 0;
+    MidiAdaptiveWaiter waiter(MidiWaitStrategy::ADAPTIVE);
+    FutexCode ret = waiter.Wait(&testFutex_, -1, [&checks]() { return ++checks > 3; });
+    EXPECT_EQ(ret, FUTEX_SUCCESS);
+    EXPECT_EQ(0, syscalls);
+    EXPECT_EQ(IS_READY, testFutex_.load());
+}
+
+/**
+ * @tc.name: AdaptiveWait_002
+ * @tc.desc: the spin budget follows the observed wait times and collapses when events arrive far apart
+ * @tc.type: FUNC
+ */
+HWTEST_F(FutexToolUnitTest, AdaptiveWait_002, TestSize.Level0)
+{
+    int64_t now = 0;
+    int64_t step = 10000;  // every clock read advances 10us
+    FutexTool::SetStubFunc(nullptr, [&now, &step]() { return now += step; });
+    MidiAdaptiveWaiter waiter(MidiWaitStrategy::ADAPTIVE);
+    EXPECT_EQ(MidiAdaptiveWaiter::ADAPTIVE_MIN_SPIN_NS, waiter.GetSpinBudgetNs());
+    constexpr int rounds = 64;
+    for (int i = 0; i < rounds; ++i) {
+        ASSERT_EQ(FUTEX_SUCCESS, waiter.Wait(&testFutex_, -1, []() { return true; }));
+    }
+    EXPECT_GT(waiter.GetSpinBudgetNs(), 15000);
+    EXPECT_LE(waiter.GetSpinBudgetNs(), 20000);
+
+    step = 200000;
+    for (int i = 0; i < rounds; ++i) {
+        ASSERT_EQ(FUTEX_SUCCESS, waiter.Wait(&testFutex_, -1, []() { return true; }));
+    }
+    EXPECT_EQ(MidiAdaptiveWaiter::ADAPTIVE_MIN_SPIN_NS, waiter.GetSpinBudgetNs());
+}
+
+/**
+ * @tc.name: AdaptiveWait_003
+ * @tc.desc: a wait that outlives spin and yield parks on the futex and honours the timeout
+ * @tc.type: FUNC
+ */
+HWTEST_F(FutexToolUnitTest, AdaptiveWait_003, TestSize.Level0)
+{
+    int64_t now = 0;
+    int parks = 0;
+    FutexTool::SetStubFunc([&parks](std::atomic<uint32_t> *, int op, int, const struct timespec *) -> long {
+        parks += (op == FUTEX_WAIT) ? 1 : 0;
+        errno = ETIMEDOUT;
+        return -1;
+    }, [&now]() { return now += 1000; });
+    MidiAdaptiveWaiter waiter(MidiWaitStrategy::ADAPTIVE);
+    FutexCode ret = waiter.Wait(&testFutex_, 1000000, []() { return false; });
+    EXPECT_EQ(ret, FUTEX_TIMEOUT);
+    EXPECT_EQ(1, parks);
+    EXPECT_EQ(IS_NOT_READY, testFutex_.load());
+}
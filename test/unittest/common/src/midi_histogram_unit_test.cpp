@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdint>
+
+#include <gtest/gtest.h>
+
+#include "midi_histogram.h"
+
+using namespace OHOS;
+using namespace MIDI;
+using namespace testing::ext;
+
+class MidiHistogramUnitTest : public testing::Test {};
+
+/**
+ * @tc.name: BucketIndex_001
+ * @tc.desc: every value falls in a bucket whose upper bound is within 12.5% above it.
+ * @tc.type: FUNC
+ */
+HWTEST_F(MidiHistogramUnitTest, BucketIndex_001, TestSize.Level0)
+{
+    for (uint64_t value = 0; value < 16; ++value) {
+        EXPECT_EQ(value, MidiHistogram::BucketUpperBound(MidiHistogram::BucketIndex(value)));
+    }
+    const uint64_t samples[] = {16, 17, 100, 1000, 123456, 1ull << 40, (1ull << 40) + 12345, UINT64_MAX};
+    for (uint64_t value : samples) {
+        const uint32_t index = MidiHistogram::BucketIndex(value);
+        ASSERT_LT(index, MidiHistogram::BUCKET_COUNT);
+        const uint64_t upper = MidiHistogram::BucketUpperBound(index);
+        EXPECT_GE(upper, value);
+        EXPECT_LE(upper - value, value / MidiHistogram::SUB_BUCKETS);
+        if (index > 0) {
+            EXPECT_LT(MidiHistogram::BucketUpperBound(index - 1), value);
+        }
+    }
+    EXPECT_EQ(MidiHistogram::BUCKET_COUNT - 1, MidiHistogram::BucketIndex(UINT64_MAX));
+}
+
+/**
+ * @tc.name: Percentile_001
+ * @tc.desc: percentiles, mean and max over a uniform sample; Reset empties the histogram.
+ * @tc.type: FUNC
+ */
+HWTEST_F(MidiHistogramUnitTest, Percentile_001, TestSize.Level0)
+{
+    MidiHistogram histogram;
+    EXPECT_EQ(0u, histogram.Percentile(0.99));
+    EXPECT_EQ(0u, histogram.Mean());
+
+    for (uint64_t value = 1; value <= 1000; ++value) {
+        histogram.Record(value);
+    }
+    EXPECT_EQ(1000u, histogram.Count());
+    EXPECT_EQ(500500u, histogram.Sum());
+    EXPECT_EQ(500u, histogram.Mean());
+    EXPECT_EQ(1000u, histogram.Max());
+    EXPECT_EQ(1u, histogram.Percentile(0.0));
+    const uint64_t p50 = histogram.Percentile(0.5);
+    EXPECT_GE(p50, 500u);
+    EXPECT_LE(p50, 500u + 500u / MidiHistogram::SUB_BUCKETS);
+    const uint64_t p99 = histogram.Percentile(0.99);
+    EXPECT_GE(p99, 990u);
+    EXPECT_LE(p99, 1000u);  // capped by max
+    EXPECT_EQ(1000u, histogram.Percentile(1.0));
+
+    histogram.Reset();
+    EXPECT_EQ(0u, histogram.Count());
+    EXPECT_EQ(0u, histogram.Max());
+    EXPECT_EQ(0u, histogram.Percentile(0.5));
+}
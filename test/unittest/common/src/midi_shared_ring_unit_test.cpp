@@ -22,7 +22,10 @@
 #include <unistd.h>
 #include <cstdint>
 #include <cstddef>
+#include <cstring>
+#include <thread>
 #include <sys/eventfd.h>
+#include <linux/futex.h>
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
@@ -36,8 +39,8 @@ namespace MIDI {
 
 namespace {
 constexpr int32_t INVALID_FD = -1;
-// midi_shared_ring.cpp 内部 MAX_MMAP_BUFFER_SIZE = 0x2000
-constexpr uint32_t MAX_MMAP_BUFFER_SIZE = 0x2000;
+// midi_shared_ring.cpp 内部 MAX_MMAP_BUFFER_SIZE = 0x10000
+constexpr uint32_t MAX_MMAP_BUFFER_SIZE = 0x10000;
 } // namespace
 
 void MidiSharedRingUnitTest::SetUpTestCase(void) {}
@@ -245,6 +248,74 @@ HWTEST_F(MidiSharedRingUnitTest, MidiSharedRingMarshalling_002, TestSize.Level0)
     delete out;
 }
 
+/**
+ * @tc.name   : Test MidiSharedRing Marshalling & Unmarshalling
+ * @tc.number : MidiSharedRingMarshalling_003
+ * @tc.desc   : Unmarshalling rejects a peer with a different shared memory layout version.
+ */
+HWTEST_F(MidiSharedRingUnitTest, MidiSharedRingMarshalling_003, TestSize.Level0)
+{
+    constexpr uint32_t RING_CAPACITY_BYTES = 256;
+    auto ring = MidiSharedRing::CreateFromLocal(RING_CAPACITY_BYTES);
+    ASSERT_NE(nullptr, ring);
+
+    MessageParcel parcel;
+    parcel.WriteUint32(RING_CAPACITY_BYTES);
+    parcel.WriteUint32(MIDI_SHM_LAYOUT_VERSION + 1);
+    parcel.WriteFileDescriptor(ring->dataMem_->GetFd());
+    EXPECT_EQ(nullptr, MidiSharedRing::Unmarshalling(parcel));
+}
+
+/**
+ * @tc.name   : Test MidiSharedRing ControlHeader layout
+ * @tc.number : MidiSharedRingLayout_001
+ * @tc.desc   : producer index, consumer index and futex live on separate cache lines.
+ */
+HWTEST_F(MidiSharedRingUnitTest, MidiSharedRingLayout_001, TestSize.Level0)
+{
+    MidiSharedRing ring(256);
+    ASSERT_EQ(MIDI_STATUS_OK, ring.Init(INVALID_FD));
+    auto *ctrl = ring.GetControlHeader();
+    ASSERT_NE(nullptr, ctrl);
+    EXPECT_EQ(MIDI_SHM_LAYOUT_VERSION, ctrl->layoutVersion);
+
+    auto addr = [](const void *p) { return reinterpret_cast<uintptr_t>(p); };
+    const uintptr_t writeLine = addr(&ctrl->writePosition) / MIDI_CACHE_LINE_SIZE;
+    const uintptr_t readLine = addr(&ctrl->readPosition) / MIDI_CACHE_LINE_SIZE;
+    const uintptr_t futexLine = addr(&ctrl->futexObj) / MIDI_CACHE_LINE_SIZE;
+    const uintptr_t spaceFutexLine = addr(&ctrl->spaceFutexObj) / MIDI_CACHE_LINE_SIZE;
+    const uintptr_t capacityLine = addr(&ctrl->capacity) / MIDI_CACHE_LINE_SIZE;
+    EXPECT_NE(writeLine, readLine);
+    EXPECT_NE(writeLine, futexLine);
+    EXPECT_NE(readLine, futexLine);
+    EXPECT_NE(futexLine, spaceFutexLine);
+    EXPECT_NE(readLine, spaceFutexLine);
+    EXPECT_NE(capacityLine, writeLine);
+    EXPECT_NE(capacityLine, readLine);
+    const uintptr_t flushRequestLine = addr(&ctrl->flushRequest) / MIDI_CACHE_LINE_SIZE;
+    const uintptr_t flushAckLine = addr(&ctrl->flushAck) / MIDI_CACHE_LINE_SIZE;
+    EXPECT_NE(flushRequestLine, flushAckLine);
+    EXPECT_NE(flushRequestLine, writeLine);
+    EXPECT_NE(flushAckLine, readLine);
+    EXPECT_EQ(0u, sizeof(ControlHeader) % MIDI_CACHE_LINE_SIZE);
+}
+
+/**
+ * @tc.name   : Test MidiSharedRing Init API
+ * @tc.number : MidiSharedRingInit_006
+ * @tc.desc   : Init with remote fd fails when the header carries an unknown layout version.
+ */
+HWTEST_F(MidiSharedRingUnitTest, MidiSharedRingInit_006, TestSize.Level0)
+{
+    constexpr uint32_t RING_CAPACITY_BYTES = 256;
+    auto ring = MidiSharedRing::CreateFromLocal(RING_CAPACITY_BYTES);
+    ASSERT_NE(nullptr, ring);
+    ring->GetControlHeader()->layoutVersion = MIDI_SHM_LAYOUT_VERSION + 1;
+
+    MidiSharedRing peer(RING_CAPACITY_BYTES);
+    EXPECT_NE(MIDI_STATUS_OK, peer.Init(ring->dataMem_->GetFd()));
+}
+
 static MidiEventInner MakeEvent(uint64_t ts, const std::vector<uint32_t> &payload)
 {
     MidiEventInner ev{};
@@ -373,7 +444,7 @@ HWTEST_F(MidiSharedRingUnitTest, MidiSharedRingTryWriteEvents_006, TestSize.Leve
 /**
  * @tc.name   : Test MidiSharedRing TryWriteEvents API
  * @tc.number : MidiSharedRingTryWriteEvents_007
- * @tc.desc   : cover wrap marker branch in UpdateWriteIndexIfNeed.
+ * @tc.desc   : cover wrap marker branch in ReserveContiguous.
  */
 HWTEST_F(MidiSharedRingUnitTest, MidiSharedRingTryWriteEvents_007, TestSize.Level0)
 {
@@ -435,6 +506,159 @@ HWTEST_F(MidiSharedRingUnitTest, MidiSharedRingTryWriteEvents_008, TestSize.Leve
     EXPECT_EQ(0u, peek.length);
 }
 
+/**
+ * @tc.name   : Test MidiSharedRing TryWriteEvents API
+ * @tc.number : MidiSharedRingTryWriteEvents_009
+ * @tc.desc   : producer refreshes its cached read index only when the ring looks full.
+ */
+HWTEST_F(MidiSharedRingUnitTest, MidiSharedRingTryWriteEvents_009, TestSize.Level0)
+{
+    MidiSharedRing ring(128);
+    ASSERT_EQ(MIDI_STATUS_OK, ring.Init(INVALID_FD));
+
+    // 16 + 4 * 4 = 32 bytes each, three events fill the ring up to the 127 byte limit
+    std::vector<uint32_t> payload(4, 0x5);
+    MidiEventInner ev = MakeEvent(1, payload);
+    uint32_t written = 0;
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_EQ(MidiStatusCode::OK, ring.TryWriteEvents(&ev, 1, &written, false));
+    }
+    EXPECT_EQ(0u, ring.cachedReadPosition_);
+    EXPECT_EQ(MidiStatusCode::WOULD_BLOCK, ring.TryWriteEvents(&ev, 1, &written, false));
+
+    std::vector<OH_MIDIEvent> views;
+    ASSERT_EQ(MidiStatusCode::OK, ring.PeekBatch(views));
+    ring.CommitBatch();
+    EXPECT_EQ(MidiStatusCode::OK, ring.TryWriteEvents(&ev, 1, &written, false));
+    EXPECT_EQ(96u, ring.cachedReadPosition_);
+}
+
+/**
+ * @tc.name   : Test MidiSharedRing TryWriteEvents API
+ * @tc.number : MidiSharedRingTryWriteEvents_010
+ * @tc.desc   : one batch splits at the wrap point and is published once, events read back in order.
+ */
+HWTEST_F(MidiSharedRingUnitTest, MidiSharedRingTryWriteEvents_010, TestSize.Level0)
+{
+    MidiSharedRing ring(128);
+    ASSERT_EQ(MIDI_STATUS_OK, ring.Init(INVALID_FD));
+
+    // move both indexes to 80 so the next batch starts near the end
+    std::vector<uint32_t> payload1(16, 0);
+    MidiEventInner ev1 = MakeEvent(1, payload1);
+    uint32_t written = 0;
+    ASSERT_EQ(MidiStatusCode::OK, ring.TryWriteEvents(&ev1, 1, &written, false));
+    std::vector<OH_MIDIEvent> views;
+    ASSERT_EQ(MidiStatusCode::OK, ring.PeekBatch(views));
+    ring.CommitBatch();
+
+    // 20 bytes each: two fit [80, 120), the third wraps, the fourth follows it at 20
+    std::vector<uint32_t> payloads[4] = {{0x20900001}, {0x20900002}, {0x20900003}, {0x20900004}};
+    MidiEventInner evs[4];
+    for (uint32_t i = 0; i < 4; ++i) {
+        evs[i] = MakeEvent(10 + i, payloads[i]);
+    }
+    ASSERT_EQ(MidiStatusCode::OK, ring.TryWriteEvents(evs, 4, &written, false));
+    EXPECT_EQ(4u, written);
+    EXPECT_EQ(40u, ring.GetWritePosition());
+
+    ASSERT_EQ(MidiStatusCode::OK, ring.PeekBatch(views));
+    ASSERT_EQ(4u, views.size());
+    for (uint32_t i = 0; i < 4; ++i) {
+        EXPECT_EQ(10u + i, views[i].timestamp);
+        EXPECT_EQ(payloads[i][0], views[i].data[0]);
+    }
+    // the 8 byte tail is too short for a marker, the third event restarts at 0
+    EXPECT_EQ(ring.GetDataBase() + sizeof(ShmMidiEventHeader), reinterpret_cast<uint8_t *>(views[2].data));
+    ring.CommitBatch();
+    EXPECT_TRUE(ring.IsEmpty());
+}
+
+/**
+ * @tc.name   : Test MidiSharedRing TryWriteEvents API
+ * @tc.number : MidiSharedRingTryWriteEvents_011
+ * @tc.desc   : no wrap marker is written when the record fits neither the tail nor the head.
+ */
+HWTEST_F(MidiSharedRingUnitTest, MidiSharedRingTryWriteEvents_011, TestSize.Level0)
+{
+    MidiSharedRing ring(128);
+    ASSERT_EQ(MIDI_STATUS_OK, ring.Init(INVALID_FD));
+
+    std::vector<uint32_t> payload1(21, 0x1);
+    MidiEventInner ev1 = MakeEvent(10, payload1);
+    uint32_t written = 0;
+    ASSERT_EQ(MidiStatusCode::OK, ring.TryWriteEvents(&ev1, 1, &written, false));
+    ASSERT_EQ(100u, ring.GetWritePosition());
+    ring.GetControlHeader()->readPosition.store(20);
+
+    // 32 bytes: tail has 28, head has 19
+    std::vector<uint32_t> payload2(4, 0x2);
+    MidiEventInner ev2 = MakeEvent(20, payload2);
+    EXPECT_EQ(MidiStatusCode::WOULD_BLOCK, ring.TryWriteEvents(&ev2, 1, &written, false));
+    EXPECT_EQ(0u, written);
+    EXPECT_EQ(100u, ring.GetWritePosition());
+    auto *hdr = reinterpret_cast<ShmMidiEventHeader *>(ring.GetDataBase() + 100);
+    EXPECT_NE(SHM_EVENT_FLAG_WRAP, hdr->flags);
+}
+
+/**
+ * @tc.name   : Test MidiSharedRing WriteEventsBlocking API
+ * @tc.number : MidiSharedRingWriteEventsBlocking_001
+ * @tc.desc   : returns TIMEOUT with partial count, and INVALID_ARGUMENT instead of waiting on a bad event.
+ */
+HWTEST_F(MidiSharedRingUnitTest, MidiSharedRingWriteEventsBlocking_001, TestSize.Level0)
+{
+    MidiSharedRing ring(128);
+    ASSERT_EQ(MIDI_STATUS_OK, ring.Init(INVALID_FD));
+
+    std::vector<uint32_t> payload(4, 0x5);
+    std::vector<MidiEventInner> evs(4, MakeEvent(1, payload));
+    uint32_t written = 0;
+    constexpr int64_t timeoutNs = 5 * 1000 * 1000;
+    EXPECT_EQ(MidiStatusCode::TIMEOUT, ring.WriteEventsBlocking(evs.data(), evs.size(), &written, timeoutNs));
+    EXPECT_EQ(3u, written);
+
+    std::vector<OH_MIDIEvent> views;
+    ASSERT_EQ(MidiStatusCode::OK, ring.PeekBatch(views));
+    ring.CommitBatch();
+    evs[1].data = nullptr;
+    EXPECT_EQ(MidiStatusCode::INVALID_ARGUMENT, ring.WriteEventsBlocking(evs.data(), evs.size(), &written, 0));
+    EXPECT_EQ(1u, written);
+}
+
+/**
+ * @tc.name   : Test MidiSharedRing WriteEventsBlocking API
+ * @tc.number : MidiSharedRingWriteEventsBlocking_002
+ * @tc.desc   : producer parked on the space futex resumes when the consumer commits and notifies.
+ */
+HWTEST_F(MidiSharedRingUnitTest, MidiSharedRingWriteEventsBlocking_002, TestSize.Level0)
+{
+    MidiSharedRing ring(128);
+    ASSERT_EQ(MIDI_STATUS_OK, ring.Init(INVALID_FD));
+
+    constexpr uint32_t eventCount = 32;
+    std::vector<uint32_t> payload(4, 0x5);
+    std::vector<MidiEventInner> evs(eventCount, MakeEvent(1, payload));
+    std::atomic<uint32_t> consumed{0};
+    std::thread consumer([&ring, &consumed]() {
+        while (consumed.load() < eventCount) {
+            std::vector<OH_MIDIEvent> views;
+            if (ring.PeekBatch(views) == MidiStatusCode::OK) {
+                consumed += views.size();
+                ring.CommitBatch();
+                ring.NotifyProducer();
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    });
+    uint32_t written = 0;
+    constexpr int64_t timeoutNs = 2000LL * 1000 * 1000;
+    EXPECT_EQ(MidiStatusCode::OK, ring.WriteEventsBlocking(evs.data(), evs.size(), &written, timeoutNs));
+    EXPECT_EQ(eventCount, written);
+    consumer.join();
+    EXPECT_EQ(eventCount, consumed.load());
+}
+
 /**
  * @tc.name   : Test MidiSharedRing TryWriteEvent API
  * @tc.number : MidiSharedRingTryWriteEvent1_001
@@ -708,5 +932,555 @@ HWTEST_F(MidiSharedRingUnitTest, MidiSharedRingDrainToBatch_003, TestSize.Level0
     // After draining first event, read position should now point to corrupted header offset.
     EXPECT_EQ(corruptOff, ring.GetReadPosition());
 }
+
+/**
+ * @tc.name   : Test MidiSharedRing PeekBatch API
+ * @tc.number : MidiSharedRingPeekBatch_001
+ * @tc.desc   : views point into ring memory and readPosition moves only on CommitBatch.
+ */
+HWTEST_F(MidiSharedRingUnitTest, MidiSharedRingPeekBatch_001, TestSize.Level0)
+{
+    MidiSharedRing ring(256);
+    ASSERT_EQ(MIDI_STATUS_OK, ring.Init(INVALID_FD));
+
+    std::vector<uint32_t> p1{0x20903c64};
+    std::vector<uint32_t> p2{0x40904000, 0x12345678};
+    MidiEventInner evs[2] = {MakeEvent(1, p1), MakeEvent(2, p2)};
+
+    uint32_t written = 0;
+    ASSERT_EQ(MidiStatusCode::OK, ring.TryWriteEvents(evs, 2, &written, false));
+    ASSERT_EQ(2u, written);
+    const uint32_t writeAfter = ring.GetWritePosition();
+
+    std::vector<OH_MIDIEvent> views;
+    ASSERT_EQ(MidiStatusCode::OK, ring.PeekBatch(views));
+    ASSERT_EQ(2u, views.size());
+    EXPECT_EQ(1u, views[0].timestamp);
+    EXPECT_EQ(1u, views[0].length);
+    EXPECT_EQ(0x20903c64u, views[0].data[0]);
+    EXPECT_EQ(2u, views[1].timestamp);
+    EXPECT_EQ(2u, views[1].length);
+    EXPECT_EQ(0x12345678u, views[1].data[1]);
+
+    const uint8_t *base = ring.GetDataBase();
+    EXPECT_EQ(base + sizeof(ShmMidiEventHeader), reinterpret_cast<const uint8_t *>(views[0].data));
+    EXPECT_EQ(0u, ring.GetReadPosition());
+
+    ring.CommitBatch();
+    EXPECT_EQ(writeAfter, ring.GetReadPosition());
+    EXPECT_TRUE(ring.IsEmpty());
+
+    // empty ring, nothing to commit
+    EXPECT_EQ(MidiStatusCode::WOULD_BLOCK, ring.PeekBatch(views));
+    EXPECT_TRUE(views.empty());
+    ring.CommitBatch();
+    EXPECT_EQ(writeAfter, ring.GetReadPosition());
+}
+
+/**
+ * @tc.name   : Test MidiSharedRing PeekBatch API
+ * @tc.number : MidiSharedRingPeekBatch_002
+ * @tc.desc   : batch crosses the wrap marker without publishing readPosition early.
+ */
+HWTEST_F(MidiSharedRingUnitTest, MidiSharedRingPeekBatch_002, TestSize.Level0)
+{
+    MidiSharedRing ring(128);
+    ASSERT_EQ(MIDI_STATUS_OK, ring.Init(INVALID_FD));
+
+    // event1 totalBytes = 16 + 16*4 = 80, consume it so the next writes start at 80
+    std::vector<uint32_t> payload1(16, 0);
+    MidiEventInner ev1 = MakeEvent(10, payload1);
+    uint32_t written = 0;
+    ASSERT_EQ(MidiStatusCode::OK, ring.TryWriteEvents(&ev1, 1, &written, false));
+    std::vector<OH_MIDIEvent> views;
+    ASSERT_EQ(MidiStatusCode::OK, ring.PeekBatch(views));
+    ring.CommitBatch();
+    ASSERT_EQ(80u, ring.GetReadPosition());
+
+    // event2 fits the tail [80, 100), event3 needs 32 bytes and wraps to 0
+    std::vector<uint32_t> payload2(1, 0x22);
+    std::vector<uint32_t> payload3(4, 0x33);
+    MidiEventInner evs[2] = {MakeEvent(20, payload2), MakeEvent(30, payload3)};
+    ASSERT_EQ(MidiStatusCode::OK, ring.TryWriteEvents(evs, 2, &written, false));
+    ASSERT_EQ(2u, written);
+    ASSERT_EQ(32u, ring.GetWritePosition());
+
+    ASSERT_EQ(MidiStatusCode::OK, ring.PeekBatch(views));
+    ASSERT_EQ(2u, views.size());
+    EXPECT_EQ(20u, views[0].timestamp);
+    EXPECT_EQ(0x22u, views[0].data[0]);
+    EXPECT_EQ(30u, views[1].timestamp);
+    EXPECT_EQ(0x33u, views[1].data[1]);
+    EXPECT_EQ(ring.GetDataBase() + sizeof(ShmMidiEventHeader), reinterpret_cast<uint8_t *>(views[1].data));
+    EXPECT_EQ(80u, ring.GetReadPosition());
+
+    ring.CommitBatch();
+    EXPECT_EQ(32u, ring.GetReadPosition());
+    EXPECT_TRUE(ring.IsEmpty());
+}
+
+/**
+ * @tc.name   : Test MidiSharedRing PeekBatch API
+ * @tc.number : MidiSharedRingPeekBatch_003
+ * @tc.desc   : respect maxEvents limit and stop before a corrupted header.
+ */
+HWTEST_F(MidiSharedRingUnitTest, MidiSharedRingPeekBatch_003, TestSize.Level0)
+{
+    MidiSharedRing ring(256);
+    ASSERT_EQ(MIDI_STATUS_OK, ring.Init(INVALID_FD));
+
+    std::vector<uint32_t> p1(1, 0x111);
+    std::vector<uint32_t> p2(1, 0x222);
+    MidiEventInner evs[2] = {MakeEvent(1, p1), MakeEvent(2, p2)};
+    uint32_t written = 0;
+    ASSERT_EQ(MidiStatusCode::OK, ring.TryWriteEvents(evs, 2, &written, false));
+
+    std::vector<OH_MIDIEvent> views;
+    ASSERT_EQ(MidiStatusCode::OK, ring.PeekBatch(views, 1));
+    ASSERT_EQ(1u, views.size());
+    ring.CommitBatch();
+
+    uint32_t corruptOff = ring.GetWritePosition();
+    auto *hdr = reinterpret_cast<ShmMidiEventHeader *>(ring.GetDataBase() + corruptOff);
+    hdr->timestamp = 9;
+    hdr->flags = SHM_EVENT_FLAG_NONE;
+    hdr->length = 999;
+    ring.GetControlHeader()->writePosition.store(corruptOff + 4);
+
+    ASSERT_EQ(MidiStatusCode::OK, ring.PeekBatch(views));
+    ASSERT_EQ(1u, views.size());
+    EXPECT_EQ(2u, views[0].timestamp);
+    ring.CommitBatch();
+    EXPECT_EQ(corruptOff, ring.GetReadPosition());
+
+    EXPECT_EQ(MidiStatusCode::SHM_BROKEN, ring.PeekBatch(views));
+    EXPECT_TRUE(views.empty());
+}
+
+/**
+ * @tc.name   : Test MidiSharedRing compact format
+ * @tc.number : MidiSharedRingCompact_001
+ * @tc.desc   : short records cost one header word, long records carry length and absolute timestamp.
+ */
+HWTEST_F(MidiSharedRingUnitTest, MidiSharedRingCompact_001, TestSize.Level0)
+{
+    auto ring = MidiSharedRing::CreateFromLocal(256, MidiRingFormat::COMPACT);
+    ASSERT_NE(nullptr, ring);
+    EXPECT_EQ(MidiRingFormat::COMPACT, ring->GetFormat());
+    EXPECT_EQ(static_cast<uint32_t>(RING_FLAG_COMPACT_RECORDS), ring->GetControlHeader()->flags);
+
+    // MT=2 channel voice (1 word), MT=4 (2 words), then 3 words whose MT says 1 word
+    std::vector<uint32_t> p1 = {0x20903C7F};
+    std::vector<uint32_t> p2 = {0x40903C00, 0x7FFF0000};
+    std::vector<uint32_t> p3 = {0x20803C00, 0x1, 0x2};
+    MidiEventInner evs[3] = {MakeEvent(1000, p1), MakeEvent(1500, p2), MakeEvent(1200, p3)};
+    uint32_t written = 0;
+    ASSERT_EQ(MidiStatusCode::OK, ring->TryWriteEvents(evs, 3, &written, false));
+    ASSERT_EQ(3u, written);
+    // (4 + 4) + (4 + 8) + (12 + 12)
+    EXPECT_EQ(44u, ring->GetWritePosition());
+
+    const uint64_t expectTs[3] = {1000, 1500, 1200};
+    const std::vector<uint32_t> *expectPayload[3] = {&p1, &p2, &p3};
+    for (uint32_t i = 0; i < 3; ++i) {
+        MidiSharedRing::PeekedEvent peeked;
+        ASSERT_EQ(MidiStatusCode::OK, ring->PeekNext(peeked));
+        EXPECT_EQ(nullptr, peeked.headerPtr);
+        EXPECT_EQ(expectTs[i], peeked.timestamp);
+        ASSERT_EQ(expectPayload[i]->size(), peeked.length);
+        EXPECT_EQ(0, memcmp(expectPayload[i]->data(), peeked.payloadPtr, peeked.length * sizeof(uint32_t)));
+        ring->CommitRead(peeked);
+    }
+    EXPECT_TRUE(ring->IsEmpty());
+}
+
+/**
+ * @tc.name   : Test MidiSharedRing compact format
+ * @tc.number : MidiSharedRingCompact_002
+ * @tc.desc   : remote peer adopts the format picked by the creator and decodes its records.
+ */
+HWTEST_F(MidiSharedRingUnitTest, MidiSharedRingCompact_002, TestSize.Level0)
+{
+    constexpr uint32_t RING_CAPACITY_BYTES = 256;
+    auto writer = MidiSharedRing::CreateFromLocal(RING_CAPACITY_BYTES, MidiRingFormat::COMPACT);
+    ASSERT_NE(nullptr, writer);
+    MidiSharedRing reader(RING_CAPACITY_BYTES);
+    ASSERT_EQ(MIDI_STATUS_OK, reader.Init(writer->dataMem_->GetFd()));
+    EXPECT_EQ(MidiRingFormat::COMPACT, reader.GetFormat());
+
+    std::vector<uint32_t> p1 = {0x20903C7F};
+    std::vector<uint32_t> p2 = {0x20803C00};
+    // the second delta does not fit 30 bits and falls back to the long form
+    MidiEventInner evs[2] = {MakeEvent(5, p1), MakeEvent(5 + (1ULL << 40), p2)};
+    uint32_t written = 0;
+    ASSERT_EQ(MidiStatusCode::OK, writer->TryWriteEvents(evs, 2, &written, false));
+    ASSERT_EQ(2u, written);
+
+    std::vector<OH_MIDIEvent> views;
+    ASSERT_EQ(MidiStatusCode::OK, reader.PeekBatch(views));
+    ASSERT_EQ(2u, views.size());
+    EXPECT_EQ(5u, views[0].timestamp);
+    EXPECT_EQ(0x20903C7Fu, views[0].data[0]);
+    EXPECT_EQ(5 + (1ULL << 40), views[1].timestamp);
+    EXPECT_EQ(0x20803C00u, views[1].data[0]);
+    reader.CommitBatch();
+    EXPECT_TRUE(writer->IsEmpty());
+}
+
+/**
+ * @tc.name   : Test MidiSharedRing compact format
+ * @tc.number : MidiSharedRingCompact_003
+ * @tc.desc   : compact wrap marker is skipped and delta timestamps survive the wrap.
+ */
+HWTEST_F(MidiSharedRingUnitTest, MidiSharedRingCompact_003, TestSize.Level0)
+{
+    auto ring = MidiSharedRing::CreateFromLocal(64, MidiRingFormat::COMPACT);
+    ASSERT_NE(nullptr, ring);
+
+    // 6 short records of 8 bytes leave a 16 byte tail
+    std::vector<uint32_t> p = {0x20903C7F};
+    std::vector<MidiEventInner> evs;
+    for (uint64_t i = 0; i < 6; ++i) {
+        evs.push_back(MakeEvent(100 + i, p));
+    }
+    uint32_t written = 0;
+    ASSERT_EQ(MidiStatusCode::OK, ring->TryWriteEvents(evs.data(), evs.size(), &written, false));
+    ASSERT_EQ(48u, ring->GetWritePosition());
+    std::vector<OH_MIDIEvent> views;
+    ASSERT_EQ(MidiStatusCode::OK, ring->PeekBatch(views));
+    ASSERT_EQ(6u, views.size());
+    ring->CommitBatch();
+
+    // MT=5 needs 4 words, 20 bytes do not fit the tail so the writer wraps
+    std::vector<uint32_t> sysex8 = {0x50000000, 0x1, 0x2, 0x3};
+    MidiEventInner ev = MakeEvent(110, sysex8);
+    ASSERT_EQ(MidiStatusCode::OK, ring->TryWriteEvent(ev, false));
+    EXPECT_EQ(20u, ring->GetWritePosition());
+
+    MidiSharedRing::PeekedEvent peeked;
+    ASSERT_EQ(MidiStatusCode::OK, ring->PeekNext(peeked));
+    EXPECT_EQ(0u, ring->GetReadPosition());
+    EXPECT_EQ(110u, peeked.timestamp);
+    EXPECT_EQ(4u, peeked.length);
+    ring->CommitRead(peeked);
+    EXPECT_TRUE(ring->IsEmpty());
+}
+
+/**
+ * @tc.name   : Test MidiSharedRing Flush API
+ * @tc.number : MidiSharedRingFlush_001
+ * @tc.desc   : ConsumeFlushRequest drops records written before RequestFlush and keeps later ones.
+ */
+HWTEST_F(MidiSharedRingUnitTest, MidiSharedRingFlush_001, TestSize.Level0)
+{
+    auto ring = MidiSharedRing::CreateFromLocal(256);
+    ASSERT_NE(nullptr, ring);
+    EXPECT_FALSE(ring->IsFlushRequested());
+
+    std::vector<uint32_t> p = {0x20903C7F};
+    std::vector<MidiEventInner> evs = {MakeEvent(10, p), MakeEvent(20, p), MakeEvent(30, p)};
+    uint32_t written = 0;
+    ASSERT_EQ(MidiStatusCode::OK, ring->TryWriteEvents(evs.data(), evs.size(), &written, false));
+    ring->RequestFlush();
+    MidiEventInner after = MakeEvent(40, p);
+    ASSERT_EQ(MidiStatusCode::OK, ring->TryWriteEvent(after, false));
+
+    EXPECT_TRUE(ring->IsFlushRequested());
+    EXPECT_EQ(3u, ring->ConsumeFlushRequest());
+    EXPECT_FALSE(ring->IsFlushRequested());
+
+    MidiSharedRing::PeekedEvent peeked;
+    ASSERT_EQ(MidiStatusCode::OK, ring->PeekNext(peeked));
+    EXPECT_EQ(40u, peeked.timestamp);
+    ring->CommitRead(peeked);
+    EXPECT_TRUE(ring->IsEmpty());
+    // nothing left before the flush point, a second request drops nothing
+    ring->RequestFlush();
+    EXPECT_EQ(0u, ring->ConsumeFlushRequest());
+}
+
+/**
+ * @tc.name   : Test MidiSharedRing Flush API
+ * @tc.number : MidiSharedRingFlush_002
+ * @tc.desc   : flushing a compact ring across a wrap keeps delta timestamps of later records intact.
+ */
+HWTEST_F(MidiSharedRingUnitTest, MidiSharedRingFlush_002, TestSize.Level0)
+{
+    auto ring = MidiSharedRing::CreateFromLocal(64, MidiRingFormat::COMPACT);
+    ASSERT_NE(nullptr, ring);
+
+    std::vector<uint32_t> p = {0x20903C7F};
+    std::vector<MidiEventInner> evs;
+    for (uint64_t i = 0; i < 6; ++i) {
+        evs.push_back(MakeEvent(100 + i, p));
+    }
+    uint32_t written = 0;
+    ASSERT_EQ(MidiStatusCode::OK, ring->TryWriteEvents(evs.data(), evs.size(), &written, false));
+    MidiSharedRing::PeekedEvent peeked;
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_EQ(MidiStatusCode::OK, ring->PeekNext(peeked));
+        ring->CommitRead(peeked);
+    }
+    // wraps behind the two unread records
+    std::vector<uint32_t> sysex8 = {0x50000000, 0x1, 0x2, 0x3};
+    MidiEventInner wrapped = MakeEvent(110, sysex8);
+    ASSERT_EQ(MidiStatusCode::OK, ring->TryWriteEvent(wrapped, false));
+    ring->RequestFlush();
+    MidiEventInner after = MakeEvent(115, p);
+    ASSERT_EQ(MidiStatusCode::OK, ring->TryWriteEvent(after, false));
+
+    EXPECT_EQ(3u, ring->ConsumeFlushRequest());
+    ASSERT_EQ(MidiStatusCode::OK, ring->PeekNext(peeked));
+    EXPECT_EQ(115u, peeked.timestamp);
+    EXPECT_EQ(1u, peeked.length);
+    ring->CommitRead(peeked);
+    EXPECT_TRUE(ring->IsEmpty());
+}
+
+/**
+ * @tc.name   : Test MidiSharedRing Flush API
+ * @tc.number : MidiSharedRingFlush_003
+ * @tc.desc   : on a multi-producer ring a flush behind an uncommitted record stays pending until that record
+ *              commits, and the consumer may park meanwhile.
+ */
+HWTEST_F(MidiSharedRingUnitTest, MidiSharedRingFlush_003, TestSize.Level0)
+{
+    auto ring = MidiSharedRing::CreateFromLocal(256, MidiRingFormat::MULTI_PRODUCER);
+    ASSERT_NE(nullptr, ring);
+    std::vector<uint32_t> p = {0x20903C7F};
+    MidiEventInner evs[2] = {MakeEvent(10, p), MakeEvent(20, p)};
+    uint32_t written = 0;
+    ASSERT_EQ(MidiStatusCode::OK, ring->TryWriteEvents(evs, 2, &written, false));
+    // the producer of the first record is still copying it, the second one is already live
+    auto *first = reinterpret_cast<ShmMidiEventHeader *>(ring->GetDataBase());
+    first->flags &= ~SHM_EVENT_FLAG_COMMITTED;
+    ring->RequestFlush();
+    MidiEventInner after = MakeEvent(30, p);
+    ASSERT_EQ(MidiStatusCode::OK, ring->TryWriteEvent(after, false));
+
+    EXPECT_EQ(0u, ring->ConsumeFlushRequest());
+    EXPECT_TRUE(ring->IsFlushRequested());
+    EXPECT_TRUE(ring->PrepareToPark());
+    ring->Unpark();
+
+    first->flags |= SHM_EVENT_FLAG_COMMITTED;
+    EXPECT_FALSE(ring->PrepareToPark());
+    ring->Unpark();
+    EXPECT_EQ(2u, ring->ConsumeFlushRequest());
+    EXPECT_FALSE(ring->IsFlushRequested());
+    MidiSharedRing::PeekedEvent peeked;
+    ASSERT_EQ(MidiStatusCode::OK, ring->PeekNext(peeked));
+    EXPECT_EQ(30u, peeked.timestamp);
+    ring->CommitRead(peeked);
+    EXPECT_TRUE(ring->IsEmpty());
+}
+
+static uint64_t ReadEventFdCount(int eventFd)
+{
+    uint64_t count = 0;
+    return ::read(eventFd, &count, sizeof(count)) == sizeof(count) ? count : 0;
+}
+
+/**
+ * @tc.name   : Test MidiSharedRing wake gating
+ * @tc.number : MidiSharedRingWake_001
+ * @tc.desc   : producers only write the eventfd while the consumer is parked, PrepareToPark refuses with data.
+ */
+HWTEST_F(MidiSharedRingUnitTest, MidiSharedRingWake_001, TestSize.Level0)
+{
+    auto fd = std::make_shared<UniqueFd>();
+    fd->Reset(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC));
+    auto ring = MidiSharedRing::CreateFromLocal(256, fd);
+    ASSERT_NE(nullptr, ring);
+    std::vector<uint32_t> p = {0x20903C7F};
+
+    // a fresh ring counts as parked, the consumer has never looked at it
+    ASSERT_EQ(MidiStatusCode::OK, ring->TryWriteEvent(MakeEvent(1, p)));
+    EXPECT_EQ(1u, ReadEventFdCount(fd->Get()));
+
+    ring->Unpark();
+    ASSERT_EQ(MidiStatusCode::OK, ring->TryWriteEvent(MakeEvent(2, p)));
+    EXPECT_EQ(0u, ReadEventFdCount(fd->Get()));
+    EXPECT_FALSE(ring->PrepareToPark());
+
+    std::vector<OH_MIDIEvent> events;
+    ASSERT_EQ(MidiStatusCode::OK, ring->PeekBatch(events));
+    EXPECT_EQ(2u, events.size());
+    ring->CommitBatch();
+    EXPECT_TRUE(ring->PrepareToPark());
+    ASSERT_EQ(MidiStatusCode::OK, ring->TryWriteEvent(MakeEvent(3, p)));
+    EXPECT_EQ(1u, ReadEventFdCount(fd->Get()));
+}
+
+/**
+ * @tc.name   : Test MidiSharedRing wake coalescing
+ * @tc.number : MidiSharedRingWake_002
+ * @tc.desc   : a parked futex consumer is woken once the threshold is reached and parks for at most the budget.
+ */
+HWTEST_F(MidiSharedRingUnitTest, MidiSharedRingWake_002, TestSize.Level0)
+{
+    auto ring = MidiSharedRing::CreateFromLocal(256);
+    ASSERT_NE(nullptr, ring);
+    EXPECT_EQ(-1, ring->GetParkTimeoutNs());
+    ring->SetWakeCoalescing(3, 500);
+    EXPECT_EQ(500000, ring->GetParkTimeoutNs());
+
+    uint32_t wakeCalls = 0;
+    FutexTool::SetStubFunc([&wakeCalls](std::atomic<uint32_t> *, int op, int, const struct timespec *) -> long {
+        wakeCalls += (op == FUTEX_WAKE) ? 1 : 0;
+        return 0;
+    }, nullptr);
+    ring->GetFutex()->store(IS_NOT_READY);  // the consumer is parked
+    std::vector<uint32_t> p = {0x20903C7F};
+    ASSERT_EQ(MidiStatusCode::OK, ring->TryWriteEvent(MakeEvent(1, p)));
+    ASSERT_EQ(MidiStatusCode::OK, ring->TryWriteEvent(MakeEvent(2, p)));
+    EXPECT_EQ(0u, wakeCalls);
+    ASSERT_EQ(MidiStatusCode::OK, ring->TryWriteEvent(MakeEvent(3, p)));
+    EXPECT_EQ(1u, wakeCalls);
+    EXPECT_EQ(IS_READY, ring->GetFutex()->load());
+
+    // an awake consumer costs the producer neither the CAS nor the syscall
+    ring->SetWakeCoalescing(0, 0);
+    EXPECT_EQ(-1, ring->GetParkTimeoutNs());
+    ASSERT_EQ(MidiStatusCode::OK, ring->TryWriteEvent(MakeEvent(4, p)));
+    EXPECT_EQ(1u, wakeCalls);
+    FutexTool::SetStubFunc(nullptr, nullptr);
+}
+
+/**
+ * @tc.name   : Test MidiSharedRing multi-producer format
+ * @tc.number : MidiSharedRingMultiProducer_001
+ * @tc.desc   : an uncommitted record hides everything behind it, consumed bytes are zeroed, the cursor is tagged.
+ */
+HWTEST_F(MidiSharedRingUnitTest, MidiSharedRingMultiProducer_001, TestSize.Level0)
+{
+    constexpr uint32_t RING_CAPACITY_BYTES = 256;
+    auto writer = MidiSharedRing::CreateFromLocal(RING_CAPACITY_BYTES, MidiRingFormat::MULTI_PRODUCER);
+    ASSERT_NE(nullptr, writer);
+    MidiSharedRing reader(RING_CAPACITY_BYTES);
+    ASSERT_EQ(MIDI_STATUS_OK, reader.Init(writer->dataMem_->GetFd()));
+    EXPECT_EQ(MidiRingFormat::MULTI_PRODUCER, reader.GetFormat());
+
+    std::vector<uint32_t> p1 = {0x20903C7F};
+    std::vector<uint32_t> p2 = {0x20803C00};
+    MidiEventInner evs[2] = {MakeEvent(1, p1), MakeEvent(2, p2)};
+    uint32_t written = 0;
+    ASSERT_EQ(MidiStatusCode::OK, writer->TryWriteEvents(evs, 2, &written, false));
+    ASSERT_EQ(2u, written);
+    const uint32_t span = 2 * (sizeof(ShmMidiEventHeader) + sizeof(uint32_t));
+    EXPECT_EQ(span, writer->GetWritePosition());
+    // one reservation for the whole call
+    EXPECT_EQ((1u << 16) | span, writer->GetControlHeader()->writePosition.load());
+
+    // pretend the producer of the first record is still copying it
+    auto *first = reinterpret_cast<ShmMidiEventHeader *>(reader.GetDataBase());
+    first->flags &= ~SHM_EVENT_FLAG_COMMITTED;
+    EXPECT_TRUE(reader.IsEmpty());
+    std::vector<OH_MIDIEvent> views;
+    EXPECT_EQ(MidiStatusCode::WOULD_BLOCK, reader.PeekBatch(views));
+
+    first->flags |= SHM_EVENT_FLAG_COMMITTED;
+    EXPECT_FALSE(reader.IsEmpty());
+    ASSERT_EQ(MidiStatusCode::OK, reader.PeekBatch(views));
+    ASSERT_EQ(2u, views.size());
+    EXPECT_EQ(0x20903C7Fu, views[0].data[0]);
+    EXPECT_EQ(0x20803C00u, views[1].data[0]);
+    reader.CommitBatch();
+    EXPECT_TRUE(writer->IsEmpty());
+    for (uint32_t i = 0; i < span; ++i) {
+        ASSERT_EQ(0u, reader.GetDataBase()[i]);
+    }
+}
+
+/**
+ * @tc.name   : Test MidiSharedRing multi-producer format
+ * @tc.number : MidiSharedRingMultiProducer_002
+ * @tc.desc   : a call that crosses the end of the ring takes a second reservation at 0 and stays in order.
+ */
+HWTEST_F(MidiSharedRingUnitTest, MidiSharedRingMultiProducer_002, TestSize.Level0)
+{
+    auto ring = MidiSharedRing::CreateFromLocal(64, MidiRingFormat::MULTI_PRODUCER);
+    ASSERT_NE(nullptr, ring);
+    std::vector<uint32_t> p = {0x20903C7F};
+
+    // two 20 byte records, consumed, leave the cursor at 40
+    MidiEventInner evs[3] = {MakeEvent(1, p), MakeEvent(2, p), MakeEvent(3, p)};
+    uint32_t written = 0;
+    ASSERT_EQ(MidiStatusCode::OK, ring->TryWriteEvents(evs, 2, &written, false));
+    std::vector<OH_MIDIEvent> views;
+    ASSERT_EQ(MidiStatusCode::OK, ring->PeekBatch(views));
+    ring->CommitBatch();
+
+    // 40..60 takes one record, the 4 byte tail cannot hold a header so the next one goes to 0
+    ASSERT_EQ(MidiStatusCode::OK, ring->TryWriteEvents(evs, 2, &written, false));
+    EXPECT_EQ(2u, written);
+    EXPECT_EQ(20u, ring->GetWritePosition());
+    EXPECT_EQ(3u, ring->GetControlHeader()->writePosition.load() >> 16);
+    // the third does not fit in front of the reader
+    EXPECT_EQ(MidiStatusCode::WOULD_BLOCK, ring->TryWriteEvent(evs[2], false));
+
+    MidiSharedRing::PeekedEvent peeked;
+    ASSERT_EQ(MidiStatusCode::OK, ring->PeekNext(peeked));
+    EXPECT_EQ(1u, peeked.timestamp);
+    ring->CommitRead(peeked);
+    ASSERT_EQ(MidiStatusCode::OK, ring->PeekNext(peeked));
+    EXPECT_EQ(2u, peeked.timestamp);
+    EXPECT_EQ(0u, peeked.beginOffset);
+    ring->CommitRead(peeked);
+    EXPECT_TRUE(ring->IsEmpty());
+}
+
+/**
+ * @tc.name   : Test MidiSharedRing multi-producer format
+ * @tc.number : MidiSharedRingMultiProducer_003
+ * @tc.desc   : concurrent producers on a small ring, every event arrives once and in order per producer.
+ */
+HWTEST_F(MidiSharedRingUnitTest, MidiSharedRingMultiProducer_003, TestSize.Level0)
+{
+    constexpr uint32_t PRODUCERS = 4;
+    constexpr uint32_t EVENTS_PER_PRODUCER = 2000;
+    auto ring = MidiSharedRing::CreateFromLocal(512, MidiRingFormat::MULTI_PRODUCER);
+    ASSERT_NE(nullptr, ring);
+
+    std::vector<std::thread> producers;
+    for (uint32_t id = 0; id < PRODUCERS; ++id) {
+        producers.emplace_back([&ring, id]() {
+            for (uint32_t seq = 0; seq < EVENTS_PER_PRODUCER; ++seq) {
+                const uint32_t payload[2] = {id, seq};
+                const MidiEventInner event{seq, 2, payload};
+                while (ring->TryWriteEvent(event, false) != MidiStatusCode::OK) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    std::vector<uint32_t> nextSeq(PRODUCERS, 0);
+    uint32_t received = 0;
+    bool inOrder = true;
+    std::vector<OH_MIDIEvent> views;
+    while (received < PRODUCERS * EVENTS_PER_PRODUCER) {
+        if (ring->PeekBatch(views) != MidiStatusCode::OK) {
+            std::this_thread::yield();
+            continue;
+        }
+        for (const auto &view : views) {
+            const uint32_t id = view.data[0];
+            ASSERT_LT(id, PRODUCERS);
+            inOrder = inOrder && view.data[1] == nextSeq[id] && view.timestamp == nextSeq[id];
+            ++nextSeq[id];
+        }
+        received += views.size();
+        ring->CommitBatch();
+    }
+    for (auto &producer : producers) {
+        producer.join();
+    }
+    EXPECT_TRUE(inOrder);
+    EXPECT_TRUE(ring->IsEmpty());
+    for (uint32_t id = 0; id < PRODUCERS; ++id) {
+        EXPECT_EQ(EVENTS_PER_PRODUCER, nextSeq[id]);
+    }
+}
 } // namespace MIDI
 } // namespace OHOS
\ No newline at end of file
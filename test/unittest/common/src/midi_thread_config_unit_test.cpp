@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "midi_shared_ring.h"
+#include "midi_thread_config.h"
+
+using namespace OHOS;
+using namespace MIDI;
+using namespace testing::ext;
+
+class MidiThreadConfigUnitTest : public testing::Test {};
+
+/**
+ * @tc.name: ParseThreadConfig_001
+ * @tc.desc: prefixed keys fill the config, missing keys keep the defaults.
+ * @tc.type: FUNC
+ */
+HWTEST_F(MidiThreadConfigUnitTest, ParseThreadConfig_001, TestSize.Level0)
+{
+    const std::string path = "/data/local/tmp/midi_thread_config_ut.conf";
+    {
+        std::ofstream file(path);
+        ASSERT_TRUE(file.is_open());
+        file << "# comment\n"
+             << "output_sched_policy = rr   # trailing comment\n"
+             << "output_sched_priority=5\n"
+             << "output_cpu_set = 0, 2-3\n"
+             << "input_sched_policy = fifo\n"
+             << "not a key value line\n";
+    }
+    const auto values = MidiThreadTool::ReadConfigFile(path);
+    std::remove(path.c_str());
+    ASSERT_EQ(4u, values.size());
+
+    MidiThreadConfig config;
+    ASSERT_TRUE(MidiThreadTool::ParseThreadConfig(values, "output_", config));
+    EXPECT_EQ(MidiSchedPolicy::RR, config.policy);
+    EXPECT_EQ(5, config.priority);
+    EXPECT_EQ(0b1101u, config.cpuMask);
+    EXPECT_FALSE(config.lockMemory);
+
+    EXPECT_TRUE(MidiThreadTool::ReadConfigFile("/nonexistent/midi.conf").empty());
+}
+
+/**
+ * @tc.name: ParseThreadConfig_002
+ * @tc.desc: a malformed value fails the parse and leaves the config untouched.
+ * @tc.type: FUNC
+ */
+HWTEST_F(MidiThreadConfigUnitTest, ParseThreadConfig_002, TestSize.Level0)
+{
+    MidiThreadConfig config;
+    config.priority = 3;
+    const std::map<std::string, std::string> badPolicy = {{"sched_policy", "idle"}, {"sched_priority", "9"}};
+    EXPECT_FALSE(MidiThreadTool::ParseThreadConfig(badPolicy, "", config));
+    EXPECT_EQ(3, config.priority);
+    EXPECT_FALSE(MidiThreadTool::ParseThreadConfig({{"lock_memory", "yes"}}, "", config));
+    EXPECT_FALSE(MidiThreadTool::ParseThreadConfig({{"sched_priority", "-1"}}, "", config));
+
+    uint64_t cpuMask = 0;
+    EXPECT_FALSE(MidiThreadTool::ParseCpuSet("3-1", cpuMask));
+    EXPECT_FALSE(MidiThreadTool::ParseCpuSet("64", cpuMask));
+    EXPECT_FALSE(MidiThreadTool::ParseCpuSet("1,,2", cpuMask));
+    EXPECT_TRUE(MidiThreadTool::ParseCpuSet("63", cpuMask));
+    EXPECT_EQ(1ull << 63, cpuMask);
+}
+
+/**
+ * @tc.name: ApplyToCurrentThread_001
+ * @tc.desc: affinity is applied, a real-time policy is either granted or falls back to NORMAL.
+ * @tc.type: FUNC
+ */
+HWTEST_F(MidiThreadConfigUnitTest, ApplyToCurrentThread_001, TestSize.Level0)
+{
+    std::thread worker([]() {
+        MidiThreadConfig config;
+        config.cpuMask = 1;  // cpu 0 always exists
+        EXPECT_EQ(MidiSchedPolicy::NORMAL, MidiThreadTool::ApplyToCurrentThread(config));
+        cpu_set_t cpuSet;
+        CPU_ZERO(&cpuSet);
+        ASSERT_EQ(0, pthread_getaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet));
+        EXPECT_EQ(1, CPU_COUNT(&cpuSet));
+        EXPECT_TRUE(CPU_ISSET(0, &cpuSet));
+
+        config.cpuMask = 0;
+        config.policy = MidiSchedPolicy::FIFO;
+        config.priority = 1000;  // clamped
+        const MidiSchedPolicy applied = MidiThreadTool::ApplyToCurrentThread(config);
+        int policy = -1;
+        sched_param param{};
+        ASSERT_EQ(0, pthread_getschedparam(pthread_self(), &policy, &param));
+        if (applied == MidiSchedPolicy::FIFO) {
+            EXPECT_EQ(SCHED_FIFO, policy);
+            EXPECT_EQ(sched_get_priority_max(SCHED_FIFO), param.sched_priority);
+        } else {
+            EXPECT_EQ(SCHED_OTHER, policy);
+        }
+    });
+    worker.join();
+}
+
+/**
+ * @tc.name: MidiSharedRingLockMemory_001
+ * @tc.desc: a mapped ring can be locked, RLIMIT_MEMLOCK permitting.
+ * @tc.type: FUNC
+ */
+HWTEST_F(MidiThreadConfigUnitTest, MidiSharedRingLockMemory_001, TestSize.Level0)
+{
+    auto ring = MidiSharedRing::CreateFromLocal(256);
+    ASSERT_NE(nullptr, ring);
+    EXPECT_EQ(MIDI_STATUS_OK, ring->LockMemory());
+}
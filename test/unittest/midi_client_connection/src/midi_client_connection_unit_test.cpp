@@ -13,9 +13,12 @@
  * limitations under the License.
  */
 
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
 #include <gtest/gtest.h>
+#include <random>
+#include <set>
 #include <vector>
 
 #include "midi_client_connection.h"
@@ -84,6 +87,29 @@ HWTEST_F(MidiClientConnectionUnitTest, ClientConnectionInServerCreateRingBuffer_
     EXPECT_EQ(0u, dataBase[3]);
 }
 
+/**
+ * @tc.name   : Test ClientConnectionInServer CreateRingBuffer
+ * @tc.number : ClientConnectionInServerCreateRingBuffer_002
+ * @tc.desc   : Requested ring size is honored within policy, defaulted for 0 and clamped otherwise.
+ */
+HWTEST_F(MidiClientConnectionUnitTest, ClientConnectionInServerCreateRingBuffer_002, TestSize.Level0)
+{
+    EXPECT_EQ(DEFAULT_RING_BUFFER_SIZE, ClientConnectionInServer::ResolveRingBufferSize(0));
+    EXPECT_EQ(MIN_RING_BUFFER_SIZE, ClientConnectionInServer::ResolveRingBufferSize(1));
+    EXPECT_EQ(MAX_RING_BUFFER_SIZE, ClientConnectionInServer::ResolveRingBufferSize(UINT32_MAX));
+    EXPECT_EQ(1024u, ClientConnectionInServer::ResolveRingBufferSize(1027));
+
+    ClientConnectionInServer smallConnection(1, 2, 3);
+    ASSERT_EQ(MIDI_STATUS_OK, smallConnection.CreateRingBuffer(-1, 512));
+    ASSERT_NE(nullptr, smallConnection.GetRingBuffer());
+    EXPECT_EQ(512u, smallConnection.GetRingBuffer()->GetCapacity());
+
+    ClientConnectionInServer largeConnection(1, 2, 3);
+    ASSERT_EQ(MIDI_STATUS_OK, largeConnection.CreateRingBuffer(-1, MAX_RING_BUFFER_SIZE));
+    ASSERT_NE(nullptr, largeConnection.GetRingBuffer());
+    EXPECT_EQ(MAX_RING_BUFFER_SIZE, largeConnection.GetRingBuffer()->GetCapacity());
+}
+
 /**
  * @tc.name   : Test ClientConnectionInServer TrySendToClient
  * @tc.number : ClientConnectionInServerTrySendToClient_001
@@ -143,6 +169,44 @@ HWTEST_F(MidiClientConnectionUnitTest, ClientConnectionInServerTrySendToClient_0
     EXPECT_EQ(MIDI_STATUS_UNKNOWN_ERROR, lastReturnCode);
 }
 
+/**
+ * @tc.name   : Test ClientConnectionInServer TrySendBatchToClient
+ * @tc.number : ClientConnectionInServerTrySendBatchToClient_001
+ * @tc.desc   : a batch is written in one publish; what does not fit is dropped and counted.
+ */
+HWTEST_F(MidiClientConnectionUnitTest, ClientConnectionInServerTrySendBatchToClient_001, TestSize.Level0)
+{
+    ClientConnectionInServer clientConnection(12, 22, 33);
+    ASSERT_EQ(MIDI_STATUS_OK, clientConnection.CreateRingBuffer(-1, MIN_RING_BUFFER_SIZE));
+    std::shared_ptr<MidiSharedRing> ring = clientConnection.GetRingBuffer();
+    ASSERT_NE(nullptr, ring);
+
+    std::vector<uint32_t> payloadWords{0x20903C7F};
+    std::vector<MidiEventInner> events;
+    for (uint64_t timestamp = 1; timestamp <= 4; ++timestamp) {
+        events.push_back(MakeMidiEventInner(timestamp, payloadWords));
+    }
+    EXPECT_EQ(0u, clientConnection.TrySendBatchToClient(nullptr, 1));
+    EXPECT_EQ(4u, clientConnection.TrySendBatchToClient(events.data(), events.size()));
+    std::vector<OH_MIDIEvent> received;
+    ASSERT_EQ(MidiStatusCode::OK, ring->PeekBatch(received, 0));
+    ASSERT_EQ(4u, received.size());
+    for (size_t i = 0; i < received.size(); ++i) {
+        EXPECT_EQ(i + 1, received[i].timestamp);
+    }
+    ring->CommitBatch();
+    EXPECT_EQ(4u, clientConnection.GetCounters().events.Load());
+    EXPECT_EQ(4u * sizeof(uint32_t), clientConnection.GetCounters().bytes.Load());
+
+    // far more than a minimum size ring holds: a prefix lands, the tail is dropped
+    std::vector<MidiEventInner> burst(100, MakeMidiEventInner(5, payloadWords));
+    const uint32_t written = clientConnection.TrySendBatchToClient(burst.data(), burst.size());
+    EXPECT_GT(written, 0u);
+    EXPECT_LT(written, burst.size());
+    EXPECT_EQ(burst.size() - written, clientConnection.GetCounters().wouldBlockDrops.Load());
+    EXPECT_EQ(burst.size() - written, ring->GetDroppedEvents());
+}
+
 /**
  * @tc.name   : Test ClientConnectionInServer Pending Queue
  * @tc.number : ClientConnectionInServerPendingQueue_001
@@ -170,9 +234,9 @@ HWTEST_F(MidiClientConnectionUnitTest, ClientConnectionInServerPendingQueue_001,
     const auto dueEarliest = nowTime + milliseconds(1);
     const auto dueMiddle = nowTime + milliseconds(5);
 
-    EXPECT_TRUE(clientConnection.EnqueueNonRealtime(std::move(payloadData1), dueLater, 100));
-    EXPECT_TRUE(clientConnection.EnqueueNonRealtime(std::move(payloadData2), dueEarliest, 200));
-    EXPECT_TRUE(clientConnection.EnqueueNonRealtime(std::move(payloadData3), dueMiddle, 300));
+    EXPECT_TRUE(clientConnection.EnqueueNonRealtime(payloadData1.data(), payloadData1.size(), dueLater, 100));
+    EXPECT_TRUE(clientConnection.EnqueueNonRealtime(payloadData2.data(), payloadData2.size(), dueEarliest, 200));
+    EXPECT_TRUE(clientConnection.EnqueueNonRealtime(payloadData3.data(), payloadData3.size(), dueMiddle, 300));
 
     EXPECT_TRUE(clientConnection.HasPending());
     EXPECT_FALSE(clientConnection.IsPendingFull());
@@ -181,14 +245,14 @@ HWTEST_F(MidiClientConnectionUnitTest, ClientConnectionInServerPendingQueue_001,
     const ClientConnectionInServer::PendingEvent *topPending = clientConnection.PeekPendingTop();
     ASSERT_NE(nullptr, topPending);
     EXPECT_EQ(200u, topPending->timestamp);
-    ASSERT_EQ(3, topPending->data.size());
+    ASSERT_EQ(3u, topPending->length);
     EXPECT_EQ(0x10, topPending->data[0]);
 
     // Pop should return the same earliest event.
     ClientConnectionInServer::PendingEvent poppedEvent{};
     ASSERT_TRUE(clientConnection.PopPendingTop(poppedEvent));
     EXPECT_EQ(200u, poppedEvent.timestamp);
-    ASSERT_EQ(3, poppedEvent.data.size());
+    ASSERT_EQ(3u, poppedEvent.length);
     EXPECT_EQ(0x10, poppedEvent.data[0]);
     EXPECT_EQ(0x11, poppedEvent.data[1]);
     EXPECT_EQ(0x12, poppedEvent.data[2]);
@@ -227,12 +291,12 @@ HWTEST_F(MidiClientConnectionUnitTest, ClientConnectionInServerPendingQueue_002,
     std::vector<uint32_t> payloadData = {0xAA, 0xBB, 0xCC};
     const auto dueTime = steady_clock::now() + milliseconds(3);
 
-    EXPECT_TRUE(clientConnection.EnqueueNonRealtime(std::move(payloadData), dueTime, 999));
+    EXPECT_TRUE(clientConnection.EnqueueNonRealtime(payloadData.data(), payloadData.size(), dueTime, 999));
     EXPECT_TRUE(clientConnection.HasPending());
     EXPECT_TRUE(clientConnection.IsPendingFull());
 
     // Second enqueue should fail due to maxPending limit.
-    EXPECT_FALSE(clientConnection.EnqueueNonRealtime(std::move(payloadData), dueTime, 1000));
+    EXPECT_FALSE(clientConnection.EnqueueNonRealtime(payloadData.data(), payloadData.size(), dueTime, 1000));
     EXPECT_TRUE(clientConnection.HasPending()); // still has the first one
 
     ClientConnectionInServer::PendingEvent poppedEvent{};
@@ -245,5 +309,161 @@ HWTEST_F(MidiClientConnectionUnitTest, ClientConnectionInServerPendingQueue_002,
     EXPECT_EQ(nullptr, clientConnection.PeekPendingTop());
 }
 
+/**
+ * @tc.name   : Test ClientConnectionInServer Pending Clear
+ * @tc.number : ClientConnectionInServerPendingQueue_003
+ * @tc.desc   : ClearPending drops every scheduled event and reports how many.
+ */
+HWTEST_F(MidiClientConnectionUnitTest, ClientConnectionInServerPendingQueue_003, TestSize.Level0)
+{
+    ClientConnectionInServer clientConnection(121, 232, 343);
+    EXPECT_EQ(0u, clientConnection.ClearPending());
+
+    const auto dueTime = steady_clock::now() + seconds(10);
+    for (uint64_t i = 0; i < 3; ++i) {
+        std::vector<uint32_t> payloadData = {0x20903C7F};
+        EXPECT_TRUE(clientConnection.EnqueueNonRealtime(payloadData.data(), payloadData.size(), dueTime, i + 1));
+    }
+    EXPECT_EQ(3u, clientConnection.ClearPending());
+    EXPECT_FALSE(clientConnection.HasPending());
+    EXPECT_EQ(nullptr, clientConnection.PeekPendingTop());
+}
+
+/**
+ * @tc.name   : Test MidiTimerWheel Ordering
+ * @tc.number : MidiTimerWheel_001
+ * @tc.desc   : events spread over every level and beyond the wheel come out in due order, ties in insert order,
+ *              also when scheduling interleaves with expiry so equal due times arrive through different levels.
+ */
+HWTEST_F(MidiClientConnectionUnitTest, MidiTimerWheel_001, TestSize.Level0)
+{
+    MidiTimerWheel wheel(4096);
+    std::mt19937_64 rng(7);
+    const uint64_t base = 5'000'000'000ull;
+    const uint64_t spans[] = {50'000ull, 3'000'000ull, 200'000'000ull, 15'000'000'000ull, 3'000'000'000'000ull};
+    std::vector<std::pair<uint64_t, uint64_t>> expected;  // (due, insert order)
+    for (uint64_t i = 0; i < 2000; ++i) {
+        const uint64_t due = base + rng() % spans[i % 5];
+        uint32_t word = static_cast<uint32_t>(i);
+        ASSERT_TRUE(wheel.Schedule(due, i, &word, 1));
+        expected.emplace_back(due, i);
+    }
+    // duplicate due times keep FIFO order
+    uint32_t word = 0;
+    ASSERT_TRUE(wheel.Schedule(base + 1000, 2000, &word, 1));
+    ASSERT_TRUE(wheel.Schedule(base + 1000, 2001, &word, 1));
+    expected.emplace_back(base + 1000, 2000);
+    expected.emplace_back(base + 1000, 2001);
+    std::stable_sort(expected.begin(), expected.end(),
+        [](const auto &a, const auto &b) { return a.first < b.first; });
+
+    for (const auto &item : expected) {
+        const MidiTimerWheel::Slot *front = wheel.Front();
+        ASSERT_NE(nullptr, front);
+        EXPECT_EQ(item.first, front->dueNs);
+        EXPECT_EQ(item.second, front->timestamp);
+        wheel.PopFront();
+    }
+    EXPECT_TRUE(wheel.Empty());
+    EXPECT_EQ(nullptr, wheel.Front());
+
+    // coarse due times (whole ticks) relative to the last expiry make ties between cascaded and direct filed events
+    std::set<std::pair<uint64_t, uint64_t>> pending;  // (due, insert order)
+    uint64_t now = base;
+    for (uint64_t i = 0; i < 20000; ++i) {
+        if (rng() % 2 == 0 || pending.empty()) {
+            const uint64_t due = now + ((rng() % 300) << 16);
+            ASSERT_TRUE(wheel.Schedule(due, i, &word, 1));
+            pending.emplace(due, i);
+            continue;
+        }
+        const MidiTimerWheel::Slot *front = wheel.Front();
+        ASSERT_NE(nullptr, front);
+        EXPECT_EQ(pending.begin()->first, front->dueNs);
+        EXPECT_EQ(pending.begin()->second, front->timestamp);
+        now = front->dueNs;
+        pending.erase(pending.begin());
+        wheel.PopFront();
+    }
+}
+
+/**
+ * @tc.name   : Test MidiTimerWheel Slab
+ * @tc.number : MidiTimerWheel_002
+ * @tc.desc   : slots are recycled, long payloads spill and the capacity limit holds.
+ */
+HWTEST_F(MidiClientConnectionUnitTest, MidiTimerWheel_002, TestSize.Level0)
+{
+    MidiTimerWheel wheel(3);
+    std::vector<uint32_t> longPayload = {1, 2, 3, 4, 5, 6};
+    for (uint64_t round = 0; round < 10000; ++round) {
+        ASSERT_TRUE(wheel.Schedule(round * 1000, round, longPayload.data(), longPayload.size()));
+        const MidiTimerWheel::Slot *front = wheel.Front();
+        ASSERT_NE(nullptr, front);
+        ASSERT_EQ(longPayload.size(), front->length);
+        EXPECT_EQ(6u, front->Data()[5]);
+        wheel.PopFront();
+    }
+    EXPECT_EQ(1u, wheel.allocated_);
+
+    uint32_t word = 0x20903C7F;
+    EXPECT_TRUE(wheel.Schedule(10, 1, &word, 1));
+    EXPECT_TRUE(wheel.Schedule(20, 2, &word, 1));
+    EXPECT_TRUE(wheel.Schedule(30, 3, &word, 1));
+    EXPECT_TRUE(wheel.Full());
+    EXPECT_FALSE(wheel.Schedule(40, 4, &word, 1));
+    wheel.Clear();
+    EXPECT_TRUE(wheel.Empty());
+    EXPECT_TRUE(wheel.Schedule(40, 4, &word, 1));
+    EXPECT_EQ(3u, wheel.allocated_);
+}
+
+/**
+ * @tc.name   : Test MidiTimerWheel Late Insert
+ * @tc.number : MidiTimerWheel_003
+ * @tc.desc   : an event earlier than the one Front() advanced to still comes out first, and an event filed
+ *              straight into level 0 stays behind an earlier scheduled one with the same due time that cascades.
+ */
+HWTEST_F(MidiClientConnectionUnitTest, MidiTimerWheel_003, TestSize.Level0)
+{
+    MidiTimerWheel wheel(16);
+    uint32_t word = 0x20903C7F;
+    ASSERT_TRUE(wheel.Schedule(1'000'000'000ull, 1, &word, 1));
+    ASSERT_TRUE(wheel.Schedule(9'000'000'000ull, 2, &word, 1));
+    ASSERT_NE(nullptr, wheel.Front());
+    wheel.PopFront();
+    // cursor now sits on the 9s event
+    ASSERT_NE(nullptr, wheel.Front());
+    ASSERT_TRUE(wheel.Schedule(2'000'000'000ull, 3, &word, 1));
+    ASSERT_TRUE(wheel.Schedule(9'500'000'000ull, 4, &word, 1));
+
+    const uint64_t order[] = {3, 2, 4};
+    for (uint64_t timestamp : order) {
+        const MidiTimerWheel::Slot *front = wheel.Front();
+        ASSERT_NE(nullptr, front);
+        EXPECT_EQ(timestamp, front->timestamp);
+        wheel.PopFront();
+    }
+    EXPECT_TRUE(wheel.Empty());
+
+    // ticks of 65.536us: A at tick 200 goes to level 1, B with the same due time is filed into level 0
+    // once the cursor reached tick 150, and must still come out after A
+    auto tickNs = [](uint64_t tick) { return tick << 16; };
+    ASSERT_TRUE(wheel.Schedule(tickNs(100), 10, &word, 1));
+    ASSERT_TRUE(wheel.Schedule(tickNs(200), 11, &word, 1));  // A
+    ASSERT_TRUE(wheel.Schedule(tickNs(150), 12, &word, 1));  // C
+    ASSERT_NE(nullptr, wheel.Front());
+    wheel.PopFront();
+    ASSERT_NE(nullptr, wheel.Front());
+    ASSERT_TRUE(wheel.Schedule(tickNs(200), 13, &word, 1));  // B
+    const uint64_t tieOrder[] = {12, 11, 13};
+    for (uint64_t timestamp : tieOrder) {
+        const MidiTimerWheel::Slot *front = wheel.Front();
+        ASSERT_NE(nullptr, front);
+        EXPECT_EQ(timestamp, front->timestamp);
+        wheel.PopFront();
+    }
+    EXPECT_TRUE(wheel.Empty());
+}
 } // namespace MIDI
 } // namespace OHOS
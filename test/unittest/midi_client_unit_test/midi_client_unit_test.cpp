@@ -15,6 +15,8 @@
 
 #include <mutex>
 #include <condition_variable>
+#include <future>
+#include <thread>
 
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
@@ -106,12 +108,18 @@ public:
     MOCK_METHOD(OH_MIDIStatusCode, GetDevicePorts,
         (int64_t deviceId, (std::vector<std::map<int32_t, std::string>>)&portInfos), (override));
     MOCK_METHOD(OH_MIDIStatusCode, OpenInputPort,
-        ((std::shared_ptr<MidiSharedRing>)&buffer, int64_t deviceId, uint32_t portIndex), (override));
+        ((std::shared_ptr<MidiSharedRing>)&buffer, int64_t deviceId, uint32_t portIndex, uint32_t bufferSize),
+        (override));
     MOCK_METHOD(OH_MIDIStatusCode, OpenOutputPort,
-        ((std::shared_ptr<MidiSharedRing>)&buffer, int64_t deviceId, uint32_t portIndex), (override));
+        ((std::shared_ptr<MidiSharedRing>)&buffer, int64_t deviceId, uint32_t portIndex, uint32_t bufferSize,
+        bool multiProducer), (override));
     MOCK_METHOD(OH_MIDIStatusCode, CloseInputPort, (int64_t deviceId, uint32_t portIndex), (override));
     MOCK_METHOD(OH_MIDIStatusCode, CloseOutputPort, (int64_t deviceId, uint32_t portIndex), (override));
     MOCK_METHOD(OH_MIDIStatusCode, DestroyMidiClient, (), (override));
+    MOCK_METHOD(OH_MIDIStatusCode, GetStatistics, (std::string &statistics), (override));
+    MOCK_METHOD(OH_MIDIStatusCode, OpenOutputLane,
+        ((std::shared_ptr<MidiSharedRing>)&buffer, int64_t deviceId, uint32_t portIndex, uint32_t bufferSize),
+        (override));
 };
 
 class MidiClientUnitTest : public testing::Test {
@@ -173,7 +181,7 @@ HWTEST_F(MidiClientUnitTest, GetDevices_001, TestSize.Level0)
             {ADDRESS, "aabbcc"}});
         return MIDI_STATUS_OK;
     }));
-    OH_MIDICallbacks callbacks;
+    OH_MIDICallbacks callbacks{};
     callbacks.onDeviceChange =
         [](void *userData, OH_MIDIDeviceChangeAction action, OH_MIDIDeviceInformation deviceInfo) {};
     callbacks.onError = [](void *userData, OH_MIDIStatusCode code) {
@@ -225,7 +233,7 @@ HWTEST_F(MidiClientUnitTest, GetDevices_002, TestSize.Level0)
             {ADDRESS, "aabbcc"}});
         return MIDI_STATUS_OK;
     }));
-    OH_MIDICallbacks callbacks;
+    OH_MIDICallbacks callbacks{};
     callbacks.onDeviceChange =
         [](void *userData, OH_MIDIDeviceChangeAction action, OH_MIDIDeviceInformation deviceInfo) {};
     callbacks.onError = [](void *userData, OH_MIDIStatusCode code) {
@@ -354,14 +362,14 @@ HWTEST_F(MidiClientUnitTest, MidiDevicePrivate_OpenInputPort_001, TestSize.Level
     int64_t deviceId = 2001;
     uint32_t portIndex = 0;
     auto device = std::make_unique<MidiDevicePrivate>(mockService, deviceId);
-    OH_MIDIPortDescriptor descriptor;
+    OH_MIDIPortDescriptor descriptor{};
     descriptor.portIndex = portIndex;
     descriptor.protocol = MIDI_PROTOCOL_1_0;
     CallbackCapture callbackCapture;
 
-    EXPECT_CALL(*mockService, OpenInputPort(_, deviceId, portIndex))
+    EXPECT_CALL(*mockService, OpenInputPort(_, deviceId, portIndex, _))
         .Times(1)
-        .WillOnce(Invoke([](std::shared_ptr<MidiSharedRing> &buffer, int64_t, uint32_t) {
+        .WillOnce(Invoke([](std::shared_ptr<MidiSharedRing> &buffer, int64_t, uint32_t, uint32_t) {
             buffer = MidiSharedRing::CreateFromLocal(256);
             return (buffer != nullptr) ? MIDI_STATUS_OK : MIDI_STATUS_UNKNOWN_ERROR;
         }));
@@ -389,14 +397,14 @@ HWTEST_F(MidiClientUnitTest, MidiDevicePrivate_OpenInputPort_002, TestSize.Level
     int64_t deviceId = 2002;
     uint32_t portIndex = 1;
     auto device = std::make_unique<MidiDevicePrivate>(mockService, deviceId);
-    OH_MIDIPortDescriptor descriptor;
+    OH_MIDIPortDescriptor descriptor{};
     descriptor.portIndex = portIndex;
     descriptor.protocol = MIDI_PROTOCOL_1_0;
     CallbackCapture callbackCapture;
 
-    EXPECT_CALL(*mockService, OpenInputPort(_, deviceId, portIndex))
+    EXPECT_CALL(*mockService, OpenInputPort(_, deviceId, portIndex, _))
         .Times(1)
-        .WillOnce(Invoke([](std::shared_ptr<MidiSharedRing> &buffer, int64_t, uint32_t) {
+        .WillOnce(Invoke([](std::shared_ptr<MidiSharedRing> &buffer, int64_t, uint32_t, uint32_t) {
             buffer = MidiSharedRing::CreateFromLocal(256);
             return MIDI_STATUS_OK;
         }));
@@ -420,12 +428,12 @@ HWTEST_F(MidiClientUnitTest, MidiDevicePrivate_OpenInputPort_003, TestSize.Level
     int64_t deviceId = 2003;
     uint32_t portIndex = 2;
     auto device = std::make_unique<MidiDevicePrivate>(mockService, deviceId);
-    OH_MIDIPortDescriptor descriptor;
+    OH_MIDIPortDescriptor descriptor{};
     descriptor.portIndex = portIndex;
     descriptor.protocol = MIDI_PROTOCOL_1_0;
     CallbackCapture callbackCapture;
 
-    EXPECT_CALL(*mockService, OpenInputPort(_, deviceId, portIndex))
+    EXPECT_CALL(*mockService, OpenInputPort(_, deviceId, portIndex, _))
         .Times(1)
         .WillOnce(Return(MIDI_STATUS_GENERIC_INVALID_ARGUMENT));
 
@@ -519,4 +527,402 @@ HWTEST_F(MidiClientUnitTest, MidiInputPort_StartReceiverThread_002, TestSize.Lev
     EXPECT_FALSE(inputPort.StartReceiverThread());
 
     EXPECT_TRUE(inputPort.StopReceiverThread());
-}
\ No newline at end of file
+}
+/**
+ * @tc.name: MidiOutputPort_SendBlocking_001
+ * @tc.desc: SendBlocking on a ring nobody drains returns TIMEOUT with the events that fit.
+ * @tc.type: FUNC
+ */
+HWTEST_F(MidiClientUnitTest, MidiOutputPort_SendBlocking_001, TestSize.Level0)
+{
+    MidiOutputPort outputPort(MIDI_PROTOCOL_1_0);
+    outputPort.GetRingBuffer() = MidiSharedRing::CreateFromLocal(128);
+    ASSERT_NE(outputPort.GetRingBuffer(), nullptr);
+
+    // 16 + 4 * 4 = 32 bytes each, only three fit
+    uint32_t words[4] = {0x40903C00, 0x7FFF0000, 0, 0};
+    std::vector<OH_MIDIEvent> events(4, OH_MIDIEvent{1, 4, words});
+    uint32_t written = 0;
+    constexpr int64_t timeoutNs = 10 * 1000 * 1000;
+    EXPECT_EQ(MIDI_STATUS_TIMEOUT, outputPort.SendBlocking(events.data(), events.size(), &written, timeoutNs));
+    EXPECT_EQ(3u, written);
+}
+
+/**
+ * @tc.name: MidiOutputPort_SendBlocking_002
+ * @tc.desc: a blocked SendBlocking completes once the consumer frees space, and Close releases a waiter.
+ * @tc.type: FUNC
+ */
+HWTEST_F(MidiClientUnitTest, MidiOutputPort_SendBlocking_002, TestSize.Level0)
+{
+    MidiOutputPort outputPort(MIDI_PROTOCOL_1_0);
+    std::shared_ptr<MidiSharedRing> ring = MidiSharedRing::CreateFromLocal(128);
+    ASSERT_NE(ring, nullptr);
+    outputPort.GetRingBuffer() = ring;
+
+    uint32_t words[4] = {0x40903C00, 0x7FFF0000, 0, 0};
+    std::vector<OH_MIDIEvent> events(5, OH_MIDIEvent{1, 4, words});
+    std::thread consumer([ring]() {
+        uint32_t drained = 0;
+        while (drained < 5) {
+            std::vector<OH_MIDIEvent> views;
+            if (ring->PeekBatch(views) == MidiStatusCode::OK) {
+                drained += views.size();
+                ring->CommitBatch();
+                ring->NotifyProducer();
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+    uint32_t written = 0;
+    EXPECT_EQ(MIDI_STATUS_OK, outputPort.SendBlocking(events.data(), events.size(), &written, 0));
+    EXPECT_EQ(5u, written);
+    consumer.join();
+
+    // fill the ring again and close while waiting forever
+    std::thread closer([&outputPort]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        outputPort.Close();
+    });
+    EXPECT_EQ(MIDI_STATUS_INVALID_PORT, outputPort.SendBlocking(events.data(), events.size(), &written, 0));
+    EXPECT_EQ(3u, written);
+    closer.join();
+}
+
+/**
+ * @tc.name: MidiOutputPort_SendSysEx_001
+ * @tc.desc: SendSysEx rejects null data and byte streams that are not a complete F0..F7 message.
+ * @tc.type: FUNC
+ */
+HWTEST_F(MidiClientUnitTest, MidiOutputPort_SendSysEx_001, TestSize.Level0)
+{
+    MidiOutputPort outputPort(MIDI_PROTOCOL_1_0);
+    outputPort.GetRingBuffer() = MidiSharedRing::CreateFromLocal(256);
+    ASSERT_NE(outputPort.GetRingBuffer(), nullptr);
+
+    uint8_t noEnd[] = {0xF0, 0x7E, 0x01};
+    uint8_t noStart[] = {0x7E, 0x01, 0xF7};
+    EXPECT_EQ(MIDI_STATUS_GENERIC_INVALID_ARGUMENT, outputPort.SendSysEx(nullptr, 4));
+    EXPECT_EQ(MIDI_STATUS_GENERIC_INVALID_ARGUMENT, outputPort.SendSysEx(noEnd, sizeof(noEnd)));
+    EXPECT_EQ(MIDI_STATUS_GENERIC_INVALID_ARGUMENT, outputPort.SendSysEx(noStart, sizeof(noStart)));
+    EXPECT_TRUE(outputPort.GetRingBuffer()->IsEmpty());
+}
+
+/**
+ * @tc.name: MidiOutputPort_SendSysEx_002
+ * @tc.desc: a SysEx larger than the ring is fragmented into MT=3 packets and delivered in order with flow control.
+ * @tc.type: FUNC
+ */
+HWTEST_F(MidiClientUnitTest, MidiOutputPort_SendSysEx_002, TestSize.Level0)
+{
+    MidiOutputPort outputPort(MIDI_PROTOCOL_1_0);
+    std::shared_ptr<MidiSharedRing> ring = MidiSharedRing::CreateFromLocal(128);
+    ASSERT_NE(ring, nullptr);
+    outputPort.GetRingBuffer() = ring;
+
+    constexpr uint32_t dataBytes = 1000;
+    std::vector<uint8_t> sysEx(dataBytes + 2);
+    sysEx.front() = 0xF0;
+    sysEx.back() = 0xF7;
+    for (uint32_t i = 0; i < dataBytes; ++i) {
+        sysEx[i + 1] = static_cast<uint8_t>(i & 0x7F);
+    }
+
+    constexpr uint32_t mtShift = 28;
+    constexpr uint32_t statusShift = 20;
+    constexpr uint32_t countShift = 16;
+    std::vector<uint8_t> received;
+    std::vector<uint32_t> statuses;
+    std::atomic<bool> done{false};
+    std::thread consumer([&]() {
+        while (!done.load() || !ring->IsEmpty()) {
+            std::vector<OH_MIDIEvent> views;
+            if (ring->PeekBatch(views) != MidiStatusCode::OK) {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+                continue;
+            }
+            for (const auto &view : views) {
+                ASSERT_EQ(2u, view.length);
+                ASSERT_EQ(3u, view.data[0] >> mtShift);
+                statuses.push_back((view.data[0] >> statusShift) & 0xF);
+                const uint32_t count = (view.data[0] >> countShift) & 0xF;
+                const uint8_t bytes[6] = {static_cast<uint8_t>(view.data[0] >> 8), static_cast<uint8_t>(view.data[0]),
+                    static_cast<uint8_t>(view.data[1] >> 24), static_cast<uint8_t>(view.data[1] >> 16),
+                    static_cast<uint8_t>(view.data[1] >> 8), static_cast<uint8_t>(view.data[1])};
+                received.insert(received.end(), bytes, bytes + count);
+            }
+            ring->CommitBatch();
+            ring->NotifyProducer();
+        }
+    });
+    EXPECT_EQ(MIDI_STATUS_OK, outputPort.SendSysEx(sysEx.data(), sysEx.size()));
+    done.store(true);
+    consumer.join();
+
+    EXPECT_EQ(std::vector<uint8_t>(sysEx.begin() + 1, sysEx.end() - 1), received);
+    ASSERT_FALSE(statuses.empty());
+    EXPECT_EQ(1u, statuses.front());  // start
+    EXPECT_EQ(3u, statuses.back());   // end
+}
+
+/**
+ * @tc.name: MidiOutputPort_Flush_001
+ * @tc.desc: Flush posts a request on the ring without waiting, and fails once the port is closed.
+ * @tc.type: FUNC
+ */
+HWTEST_F(MidiClientUnitTest, MidiOutputPort_Flush_001, TestSize.Level0)
+{
+    MidiOutputPort outputPort(MIDI_PROTOCOL_1_0);
+    std::shared_ptr<MidiSharedRing> ring = MidiSharedRing::CreateFromLocal(128);
+    ASSERT_NE(ring, nullptr);
+    outputPort.GetRingBuffer() = ring;
+
+    uint32_t words[1] = {0x20903C7F};
+    OH_MIDIEvent event{1, 1, words};
+    uint32_t written = 0;
+    ASSERT_EQ(MIDI_STATUS_OK, outputPort.Send(&event, 1, &written));
+    EXPECT_EQ(MIDI_STATUS_OK, outputPort.Flush());
+    EXPECT_TRUE(ring->IsFlushRequested());
+    EXPECT_EQ(1u, ring->ConsumeFlushRequest());
+    EXPECT_TRUE(ring->IsEmpty());
+
+    outputPort.Close();
+    EXPECT_EQ(MIDI_STATUS_INVALID_PORT, outputPort.Flush());
+}
+
+/**
+ * @tc.name: MidiOutputPort_MultiProducer_001
+ * @tc.desc: Send on a multi-producer ring does not wait for the send lock, a single producer ring waits for
+ *           another Send and returns WOULD_BLOCK only behind a blocking sender.
+ * @tc.type: FUNC
+ */
+HWTEST_F(MidiClientUnitTest, MidiOutputPort_MultiProducer_001, TestSize.Level0)
+{
+    uint32_t words[1] = {0x20903C7F};
+    OH_MIDIEvent event{1, 1, words};
+    uint32_t written = 0;
+
+    MidiOutputPort singlePort(MIDI_PROTOCOL_1_0);
+    singlePort.GetRingBuffer() = MidiSharedRing::CreateFromLocal(128);
+    ASSERT_NE(singlePort.GetRingBuffer(), nullptr);
+    {
+        // stands in for a sender parked in SendBlocking
+        MidiOutputPort::BlockingSendScope blocking(singlePort.blockingSenders_);
+        std::lock_guard<std::mutex> lock(singlePort.sendMutex_);
+        EXPECT_EQ(MIDI_STATUS_WOULD_BLOCK, singlePort.Send(&event, 1, &written));
+        EXPECT_EQ(0u, written);
+    }
+    {
+        // stands in for another Send in the middle of its ring write, the second one waits its turn
+        std::unique_lock<std::mutex> lock(singlePort.sendMutex_);
+        int32_t ret = MIDI_STATUS_UNKNOWN_ERROR;
+        std::thread sender([&]() { ret = singlePort.Send(&event, 1, &written); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        lock.unlock();
+        sender.join();
+        EXPECT_EQ(MIDI_STATUS_OK, ret);
+        EXPECT_EQ(1u, written);
+    }
+
+    MidiOutputPort sharedPort(MIDI_PROTOCOL_1_0);
+    sharedPort.GetRingBuffer() = MidiSharedRing::CreateFromLocal(128, MidiRingFormat::MULTI_PRODUCER);
+    ASSERT_NE(sharedPort.GetRingBuffer(), nullptr);
+    {
+        std::lock_guard<std::mutex> lock(sharedPort.sendMutex_);
+        EXPECT_EQ(MIDI_STATUS_OK, sharedPort.Send(&event, 1, &written));
+        EXPECT_EQ(1u, written);
+    }
+    EXPECT_FALSE(sharedPort.GetRingBuffer()->IsEmpty());
+}
+
+/**
+ * @tc.name: MidiOutputPort_Lanes_001
+ * @tc.desc: each sending thread binds its own lane and bypasses the send lock, later threads share the first ring.
+ * @tc.type: FUNC
+ */
+HWTEST_F(MidiClientUnitTest, MidiOutputPort_Lanes_001, TestSize.Level0)
+{
+    uint32_t words[1] = {0x20903C7F};
+    OH_MIDIEvent event{1, 1, words};
+    uint32_t written = 0;
+
+    MidiOutputPort outputPort(MIDI_PROTOCOL_1_0);
+    outputPort.GetRingBuffer() = MidiSharedRing::CreateFromLocal(128);
+    std::vector<std::shared_ptr<MidiSharedRing>> lanes = {
+        MidiSharedRing::CreateFromLocal(128), MidiSharedRing::CreateFromLocal(128)};
+    outputPort.SetLanes(lanes);
+
+    {
+        // stands in for a sender parked in SendBlocking on the shared ring
+        MidiOutputPort::BlockingSendScope blocking(outputPort.blockingSenders_);
+        std::lock_guard<std::mutex> lock(outputPort.sendMutex_);
+        EXPECT_EQ(MIDI_STATUS_OK, outputPort.Send(&event, 1, &written));
+        std::promise<void> secondSent;
+        std::promise<void> thirdDone;
+        // the second thread stays alive so the third cannot reuse its id
+        std::thread second([&]() {
+            uint32_t secondWritten = 0;
+            EXPECT_EQ(MIDI_STATUS_OK, outputPort.Send(&event, 1, &secondWritten));
+            EXPECT_EQ(MIDI_STATUS_OK, outputPort.Send(&event, 1, &secondWritten));
+            secondSent.set_value();
+            thirdDone.get_future().wait();
+        });
+        secondSent.get_future().wait();
+        std::thread third([&]() {
+            uint32_t thirdWritten = 0;
+            EXPECT_EQ(MIDI_STATUS_WOULD_BLOCK, outputPort.Send(&event, 1, &thirdWritten));
+        });
+        third.join();
+        thirdDone.set_value();
+        second.join();
+    }
+    EXPECT_EQ(MIDI_STATUS_OK, outputPort.Send(&event, 1, &written));
+
+    std::vector<OH_MIDIEvent> views;
+    ASSERT_EQ(MidiStatusCode::OK, lanes[0]->PeekBatch(views));
+    EXPECT_EQ(2u, views.size());
+    ASSERT_EQ(MidiStatusCode::OK, lanes[1]->PeekBatch(views));
+    EXPECT_EQ(2u, views.size());
+    EXPECT_TRUE(outputPort.GetRingBuffer()->IsEmpty());
+
+    EXPECT_EQ(MIDI_STATUS_OK, outputPort.Flush());
+    EXPECT_TRUE(lanes[0]->IsFlushRequested());
+    EXPECT_TRUE(lanes[1]->IsFlushRequested());
+}
+
+/**
+ * @tc.name: MidiDevicePrivate_OpenOutputPort_Lanes_001
+ * @tc.desc: laneCount opens one extra lane per ring beyond the first, a failing lane closes the port again.
+ * @tc.type: FUNC
+ */
+HWTEST_F(MidiClientUnitTest, MidiDevicePrivate_OpenOutputPort_Lanes_001, TestSize.Level0)
+{
+    int64_t deviceId = 2201;
+    uint32_t portIndex = 0;
+    auto device = std::make_unique<MidiDevicePrivate>(mockService, deviceId);
+    OH_MIDIPortDescriptor descriptor{};
+    descriptor.portIndex = portIndex;
+    descriptor.protocol = MIDI_PROTOCOL_1_0;
+    descriptor.laneCount = 9;
+    EXPECT_EQ(MIDI_STATUS_GENERIC_INVALID_ARGUMENT, device->OpenOutputPort(descriptor));
+
+    auto openRing = [](std::shared_ptr<MidiSharedRing> &buffer) {
+        buffer = MidiSharedRing::CreateFromLocal(256);
+        return MIDI_STATUS_OK;
+    };
+    EXPECT_CALL(*mockService, OpenOutputPort(_, deviceId, portIndex, _, false))
+        .Times(2)
+        .WillRepeatedly(Invoke([&](std::shared_ptr<MidiSharedRing> &buffer, int64_t, uint32_t, uint32_t, bool) {
+            return openRing(buffer);
+        }));
+    EXPECT_CALL(*mockService, OpenOutputLane(_, deviceId, portIndex, _))
+        .WillOnce(Invoke([&](std::shared_ptr<MidiSharedRing> &buffer, int64_t, uint32_t, uint32_t) {
+            return openRing(buffer);
+        }))
+        .WillOnce(Return(MIDI_STATUS_TOO_MANY_OPEN_PORTS))
+        .WillOnce(Invoke([&](std::shared_ptr<MidiSharedRing> &buffer, int64_t, uint32_t, uint32_t) {
+            return openRing(buffer);
+        }));
+    EXPECT_CALL(*mockService, CloseOutputPort(deviceId, portIndex)).Times(2).WillRepeatedly(Return(MIDI_STATUS_OK));
+
+    descriptor.laneCount = 3;
+    EXPECT_EQ(MIDI_STATUS_TOO_MANY_OPEN_PORTS, device->OpenOutputPort(descriptor));
+    EXPECT_EQ(MIDI_STATUS_INVALID_PORT, device->FlushOutputPort(portIndex));
+
+    descriptor.laneCount = 2;
+    EXPECT_EQ(MIDI_STATUS_OK, device->OpenOutputPort(descriptor));
+    EXPECT_EQ(MIDI_STATUS_OK, device->ClosePort(portIndex));
+}
+
+
+/**
+ * @tc.name: SetReceiverThreadConfig_001
+ * @tc.desc: receiver thread settings reach input ports opened afterwards, unknown policies are rejected.
+ * @tc.type: FUNC
+ */
+HWTEST_F(MidiClientUnitTest, SetReceiverThreadConfig_001, TestSize.Level0)
+{
+    OH_MIDIThreadConfig config{};
+    config.policy = static_cast<OH_MIDIThreadPolicy>(7);
+    EXPECT_EQ(MIDI_STATUS_GENERIC_INVALID_ARGUMENT, client->SetReceiverThreadConfig(config));
+
+    config.policy = MIDI_THREAD_POLICY_DEFAULT;
+    config.waitStrategy = static_cast<OH_MIDIWaitStrategy>(7);
+    EXPECT_EQ(MIDI_STATUS_GENERIC_INVALID_ARGUMENT, client->SetReceiverThreadConfig(config));
+
+    config.waitStrategy = MIDI_WAIT_STRATEGY_ADAPTIVE;
+    config.cpuMask = 1;  // cpu 0 always exists
+    config.lockMemory = true;
+    ASSERT_EQ(MIDI_STATUS_OK, client->SetReceiverThreadConfig(config));
+
+    int64_t deviceId = 2101;
+    uint32_t portIndex = 0;
+    auto device = std::make_unique<MidiDevicePrivate>(mockService, deviceId, client->receiverSettings_);
+    OH_MIDIPortDescriptor descriptor{};
+    descriptor.portIndex = portIndex;
+    descriptor.protocol = MIDI_PROTOCOL_1_0;
+    CallbackCapture callbackCapture;
+    EXPECT_CALL(*mockService, OpenInputPort(_, deviceId, portIndex, _))
+        .WillOnce(Invoke([](std::shared_ptr<MidiSharedRing> &buffer, int64_t, uint32_t, uint32_t) {
+            buffer = MidiSharedRing::CreateFromLocal(256);
+            return MIDI_STATUS_OK;
+        }));
+    EXPECT_CALL(*mockService, CloseInputPort(deviceId, portIndex)).WillOnce(Return(MIDI_STATUS_OK));
+
+    ASSERT_EQ(MIDI_STATUS_OK, device->OpenInputPort(descriptor, MidiReceivedTrampoline, &callbackCapture));
+    const auto &threadConfig = device->inputPortsMap_.at(portIndex)->threadConfig_;
+    EXPECT_EQ(MidiSchedPolicy::NORMAL, threadConfig.policy);
+    EXPECT_EQ(1u, threadConfig.cpuMask);
+    EXPECT_TRUE(threadConfig.lockMemory);
+    EXPECT_EQ(MidiWaitStrategy::ADAPTIVE, threadConfig.waitStrategy);
+    EXPECT_EQ(MIDI_STATUS_OK, device->ClosePort(portIndex));
+}
+
+/**
+ * @tc.name: InputOverflow_001
+ * @tc.desc: an overflow marker in the ring splits the batch and reaches onInputOverflow with the lost count.
+ * @tc.type: FUNC
+ */
+HWTEST_F(MidiClientUnitTest, InputOverflow_001, TestSize.Level0)
+{
+    struct OverflowCapture {
+        int64_t deviceId = 0;
+        uint32_t portIndex = 0;
+        uint32_t lostEvents = 0;
+        uint32_t calls = 0;
+    } overflowCapture;
+    CallbackCapture callbackCapture;
+    MidiInputPort inputPort(MidiReceivedTrampoline, &callbackCapture, MIDI_PROTOCOL_1_0);
+    inputPort.SetOverflowCallback(
+        [](void *userData, int64_t deviceId, uint32_t portIndex, uint32_t lostEvents) {
+            auto *capture = static_cast<OverflowCapture *>(userData);
+            capture->deviceId = deviceId;
+            capture->portIndex = portIndex;
+            capture->lostEvents = lostEvents;
+            ++capture->calls;
+        },
+        &overflowCapture, 2201, 1);
+    inputPort.GetRingBuffer() = MidiSharedRing::CreateFromLocal(256);
+    auto &ring = inputPort.GetRingBuffer();
+    ASSERT_NE(nullptr, ring);
+
+    std::vector<uint32_t> before = {0x20903C7F};
+    std::vector<uint32_t> marker = {MIDI_RING_OVERFLOW_MARKER, 3};
+    std::vector<uint32_t> after = {0x20803C00};
+    ASSERT_EQ(MidiStatusCode::OK, ring->TryWriteEvent(MakeMidiEventInner(1, before), false));
+    ASSERT_EQ(MidiStatusCode::OK, ring->TryWriteEvent(MakeMidiEventInner(2, marker), false));
+    ASSERT_EQ(MidiStatusCode::OK, ring->TryWriteEvent(MakeMidiEventInner(3, after), false));
+
+    inputPort.DrainRingAndDispatch();
+    EXPECT_EQ(1u, overflowCapture.calls);
+    EXPECT_EQ(2201, overflowCapture.deviceId);
+    EXPECT_EQ(1u, overflowCapture.portIndex);
+    EXPECT_EQ(3u, overflowCapture.lostEvents);
+    // the marker itself is never handed to onReceived
+    EXPECT_EQ(2u, callbackCapture.GetReceivedCount());
+    auto lastEvents = callbackCapture.GetLastEvents();
+    ASSERT_EQ(1u, lastEvents.size());
+    EXPECT_EQ(3u, lastEvents[0].timestamp);
+    EXPECT_EQ(0x20803C00u, lastEvents[0].data[0]);
+    EXPECT_EQ(0u, ring->GetUsedBytes());
+}
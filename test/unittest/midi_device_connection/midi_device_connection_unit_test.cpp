@@ -16,7 +16,10 @@
 #include <atomic>
 #include <chrono>
 #include <cstdint>
+#include <cstdlib>
 #include <memory>
+#include <new>
+#include <string>
 #include <thread>
 #include <vector>
 
@@ -27,12 +30,47 @@
 #include "gtest/gtest.h"
 
 #include "midi_device_connection.h"
+#include "midi_output_worker_pool.h"
 #include "midi_shared_ring.h"
 #include "native_midi_base.h"
 
 using namespace std::chrono;
 using namespace testing::ext;
 
+namespace {
+// counts global heap allocations of the thread that set it, see DeviceConnectionForOutput_007
+thread_local bool g_countAllocations = false;
+std::atomic<size_t> g_allocations{0};
+}  // namespace
+
+void *operator new(std::size_t size)
+{
+    if (g_countAllocations) {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    void *memory = std::malloc(size == 0 ? 1 : size);
+    if (memory == nullptr) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+// out of line so the compiler does not pair the inlined free with operator new
+__attribute__((noinline)) static void FreeAllocation(void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void *memory) noexcept
+{
+    FreeAllocation(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept
+{
+    FreeAllocation(memory);
+}
+
 namespace OHOS {
 namespace MIDI {
 
@@ -49,6 +87,46 @@ static MidiEventInner MakeMidiEventInner(uint64_t timestamp, const std::vector<u
     return midiEventInner;
 }
 
+class RecordingDriver : public MidiDeviceDriver {
+public:
+    std::vector<DeviceInformation> GetRegisteredDevices() override { return {}; }
+    int32_t OpenDevice(int64_t deviceId) override { return MIDI_STATUS_OK; }
+    int32_t OpenDevice(std::string deviceAddr, BleDriverCallback deviceCallback) override { return MIDI_STATUS_OK; }
+    int32_t CloseDevice(int64_t deviceId) override { return MIDI_STATUS_OK; }
+    int32_t OpenInputPort(int64_t deviceId, uint32_t portIndex, UmpInputCallback cb) override { return MIDI_STATUS_OK; }
+    int32_t OpenOutputPort(int64_t deviceId, uint32_t portIndex) override { return MIDI_STATUS_OK; }
+    int32_t CloseInputPort(int64_t deviceId, uint32_t portIndex) override { return MIDI_STATUS_OK; }
+    int32_t CloseOutputPort(int64_t deviceId, uint32_t portIndex) override { return MIDI_STATUS_OK; }
+    int32_t HanleUmpInput(int64_t deviceId, uint32_t portIndex, std::vector<MidiEventInner> &list) override
+    {
+        for (const auto &event : list) {
+            timestamps.push_back(event.timestamp);
+        }
+        return MIDI_STATUS_OK;
+    }
+    std::vector<uint64_t> timestamps;
+};
+
+class CountingDriver : public RecordingDriver {
+public:
+    int32_t HanleUmpInput(int64_t deviceId, uint32_t portIndex, std::vector<MidiEventInner> &list) override
+    {
+        sent.fetch_add(list.size());
+        return MIDI_STATUS_OK;
+    }
+    std::atomic<size_t> sent{0};
+};
+
+class TimingDriver : public RecordingDriver {
+public:
+    int32_t HanleUmpInput(int64_t deviceId, uint32_t portIndex, std::vector<MidiEventInner> &list) override
+    {
+        sentAtNs.store(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+        return MIDI_STATUS_OK;
+    }
+    std::atomic<int64_t> sentAtNs{0};
+};
+
 static bool IsFdValid(int fd)
 {
     if (fd < 0) {
@@ -230,6 +308,227 @@ HWTEST_F(MidiDeviceConnectionUnitTest, DeviceConnectionForInput_001, TestSize.Le
     EXPECT_EQ(payloadWords3.size(), static_cast<size_t>(peekedEventAfterRemove.length));
 }
 
+/**
+ * @tc.name   : Test DeviceConnection histograms
+ * @tc.number : DeviceConnectionHistograms_001
+ * @tc.desc   : input records batch size and delivery delay, output records batch size and send duration;
+ *              the dump lists only histograms that have samples.
+ */
+HWTEST_F(MidiDeviceConnectionUnitTest, DeviceConnectionHistograms_001, TestSize.Level1)
+{
+    DeviceConnectionInfo inputInfo{};
+    inputInfo.deviceId = 10;
+    inputInfo.direction = MidiPortDirection::INPUT;
+    inputInfo.portIndex = 0;
+    DeviceConnectionForInput inputConnection(inputInfo);
+    std::shared_ptr<MidiSharedRing> inputRing;
+    ASSERT_EQ(MIDI_STATUS_OK, inputConnection.AddClientConnection(60, 1239, inputRing));
+
+    std::vector<uint32_t> payloadWords{0x20903C7F};
+    const uint64_t receivedAt = static_cast<uint64_t>(
+        duration_cast<nanoseconds>((steady_clock::now() - milliseconds(1)).time_since_epoch()).count());
+    std::vector<MidiEventInner> deviceEvents{MakeMidiEventInner(receivedAt, payloadWords),
+        MakeMidiEventInner(receivedAt, payloadWords), MakeMidiEventInner(0, payloadWords)};
+    inputConnection.HandleDeviceUmpInput(deviceEvents);
+
+    const MidiPortHistograms &inputHistograms = inputConnection.GetHistograms();
+    EXPECT_EQ(1u, inputHistograms.batchSize.Count());
+    EXPECT_EQ(3u, inputHistograms.batchSize.Max());
+    EXPECT_EQ(2u, inputHistograms.deliveryDelay.Count());  // no timestamp, no delay
+    EXPECT_GE(inputHistograms.deliveryDelay.Max(), static_cast<uint64_t>(
+        duration_cast<nanoseconds>(milliseconds(1)).count()));
+    std::string dump;
+    inputConnection.DumpHistograms(dump);
+    EXPECT_NE(std::string::npos, dump.find("delivery_delay_ns: count 2"));
+    EXPECT_EQ(std::string::npos, dump.find("lateness_ns"));
+
+    CountingDriver driver;
+    DeviceConnectionInfo outputInfo{};
+    outputInfo.driver = &driver;
+    outputInfo.deviceId = 10;
+    outputInfo.direction = MidiPortDirection::OUTPUT;
+    outputInfo.portIndex = 1;
+    DeviceConnectionForOutput outputConnection(outputInfo);
+    ASSERT_EQ(MIDI_STATUS_OK, outputConnection.Start());
+    std::shared_ptr<MidiSharedRing> outputRing;
+    ASSERT_EQ(MIDI_STATUS_OK, outputConnection.AddClientConnection(61, 1239, outputRing));
+    ASSERT_EQ(MidiStatusCode::OK, outputRing->TryWriteEvent(MakeMidiEventInner(0, payloadWords), true));
+    for (int i = 0; i < 200 && driver.sent.load() == 0; ++i) {
+        std::this_thread::sleep_for(milliseconds(5));
+    }
+    ASSERT_EQ(MIDI_STATUS_OK, outputConnection.Stop());
+
+    const MidiPortHistograms &outputHistograms = outputConnection.GetHistograms();
+    EXPECT_EQ(1u, outputHistograms.sendDuration.Count());
+    EXPECT_EQ(1u, outputHistograms.batchSize.Sum());
+    EXPECT_EQ(0u, outputHistograms.lateness.Count());  // realtime events are not scheduled
+    dump.clear();
+    outputConnection.DumpHistograms(dump);
+    EXPECT_NE(std::string::npos, dump.find("send_duration_ns: count 1"));
+    EXPECT_NE(std::string::npos, dump.find("batch_size: count 1"));
+}
+
+/**
+ * @tc.name   : Test DeviceConnection counters
+ * @tc.number : DeviceConnectionCounters_001
+ * @tc.desc   : a full client ring counts WOULD_BLOCK drops, delivered events and the ring high-water mark.
+ */
+HWTEST_F(MidiDeviceConnectionUnitTest, DeviceConnectionCounters_001, TestSize.Level1)
+{
+    DeviceConnectionInfo inputInfo{};
+    inputInfo.deviceId = 11;
+    inputInfo.direction = MidiPortDirection::INPUT;
+    inputInfo.portIndex = 0;
+    DeviceConnectionForInput inputConnection(inputInfo);
+    std::shared_ptr<MidiSharedRing> ring;
+    ASSERT_EQ(MIDI_STATUS_OK, inputConnection.AddClientConnection(70, 1240, ring, MIN_RING_BUFFER_SIZE));
+
+    constexpr uint64_t eventCount = 100;  // far more than a minimum size ring holds
+    std::vector<uint32_t> payloadWords{0x20903C7F, 0x12345678};
+    std::vector<MidiEventInner> deviceEvents(eventCount, MakeMidiEventInner(1, payloadWords));
+    inputConnection.HandleDeviceUmpInput(deviceEvents);
+
+    const MidiPortCounters &portCounters = inputConnection.GetCounters();
+    EXPECT_EQ(eventCount, portCounters.eventsIn.Load());
+    EXPECT_EQ(eventCount * payloadWords.size() * sizeof(uint32_t), portCounters.bytesIn.Load());
+    const MidiClientCounters &clientCounters = (*inputConnection.SnapshotClients())[0]->GetCounters();
+    EXPECT_GT(clientCounters.events.Load(), 0u);
+    EXPECT_GT(clientCounters.wouldBlockDrops.Load(), 0u);
+    EXPECT_EQ(eventCount, clientCounters.events.Load() + clientCounters.wouldBlockDrops.Load());
+    EXPECT_EQ(clientCounters.events.Load(), portCounters.eventsOut.Load());
+    EXPECT_GT(clientCounters.ringHighWater.Load(), 0u);
+    EXPECT_LE(clientCounters.ringHighWater.Load(), ring->GetCapacity());
+
+    std::string dump;
+    inputConnection.Dump(dump);
+    EXPECT_NE(std::string::npos, dump.find("client 70: events " + std::to_string(clientCounters.events.Load())));
+}
+
+/**
+ * @tc.name   : Test input overflow signalling
+ * @tc.number : DeviceConnectionOverflow_001
+ * @tc.desc   : drops are counted in the ring header and reported by a marker ahead of the next delivered event.
+ */
+HWTEST_F(MidiDeviceConnectionUnitTest, DeviceConnectionOverflow_001, TestSize.Level1)
+{
+    DeviceConnectionInfo inputInfo{};
+    inputInfo.deviceId = 12;
+    inputInfo.direction = MidiPortDirection::INPUT;
+    inputInfo.portIndex = 0;
+    DeviceConnectionForInput inputConnection(inputInfo);
+    std::shared_ptr<MidiSharedRing> ring;
+    ASSERT_EQ(MIDI_STATUS_OK, inputConnection.AddClientConnection(71, 1241, ring, MIN_RING_BUFFER_SIZE));
+
+    std::vector<uint32_t> payloadWords{0x20903C7F};
+    std::vector<MidiEventInner> deviceEvents(100, MakeMidiEventInner(1, payloadWords));
+    inputConnection.HandleDeviceUmpInput(deviceEvents);
+    const MidiClientCounters &clientCounters = (*inputConnection.SnapshotClients())[0]->GetCounters();
+    const uint64_t drops = clientCounters.wouldBlockDrops.Load();
+    ASSERT_GT(drops, 0u);
+    EXPECT_EQ(drops, ring->GetDroppedEvents());
+
+    // the slow client catches up
+    std::vector<OH_MIDIEvent> events;
+    ASSERT_EQ(MidiStatusCode::OK, ring->PeekBatch(events, 0));
+    for (const auto &event : events) {
+        EXPECT_FALSE(MidiSharedRing::IsOverflowMarker(event.data, event.length));
+    }
+    ring->CommitBatch();
+
+    std::vector<uint32_t> nextWords{0x20803C00};
+    std::vector<MidiEventInner> nextEvents{MakeMidiEventInner(2, nextWords)};
+    inputConnection.HandleDeviceUmpInput(nextEvents);
+    ASSERT_EQ(MidiStatusCode::OK, ring->PeekBatch(events, 0));
+    ASSERT_EQ(2u, events.size());
+    ASSERT_TRUE(MidiSharedRing::IsOverflowMarker(events[0].data, events[0].length));
+    EXPECT_EQ(drops, events[0].data[1]);
+    EXPECT_EQ(0x20803C00u, events[1].data[0]);
+    ring->CommitBatch();
+    EXPECT_EQ(drops, ring->GetDroppedEvents());
+}
+
+/**
+ * @tc.name   : Test driver overflow forwarding
+ * @tc.number : DeviceConnectionOverflow_002
+ * @tc.desc   : an overflow marker from the HDI input ring is not delivered as an event, it is counted on the port
+ *              and every client gets its own marker ahead of the events that follow.
+ */
+HWTEST_F(MidiDeviceConnectionUnitTest, DeviceConnectionOverflow_002, TestSize.Level1)
+{
+    DeviceConnectionInfo inputInfo{};
+    inputInfo.deviceId = 13;
+    inputInfo.direction = MidiPortDirection::INPUT;
+    inputInfo.portIndex = 0;
+    DeviceConnectionForInput inputConnection(inputInfo);
+    std::shared_ptr<MidiSharedRing> firstRing;
+    std::shared_ptr<MidiSharedRing> secondRing;
+    ASSERT_EQ(MIDI_STATUS_OK, inputConnection.AddClientConnection(72, 1242, firstRing));
+    ASSERT_EQ(MIDI_STATUS_OK, inputConnection.AddClientConnection(73, 1243, secondRing));
+
+    std::vector<uint32_t> markerWords{MIDI_RING_OVERFLOW_MARKER, 5};
+    std::vector<uint32_t> payloadWords{0x20903C7F};
+    std::vector<MidiEventInner> deviceEvents{MakeMidiEventInner(1, markerWords), MakeMidiEventInner(2, payloadWords)};
+    inputConnection.HandleDeviceUmpInput(deviceEvents);
+
+    const MidiPortCounters &portCounters = inputConnection.GetCounters();
+    EXPECT_EQ(5u, portCounters.driverDrops.Load());
+    EXPECT_EQ(1u, portCounters.eventsIn.Load());
+    for (const auto &ring : {firstRing, secondRing}) {
+        std::vector<OH_MIDIEvent> events;
+        ASSERT_EQ(MidiStatusCode::OK, ring->PeekBatch(events, 0));
+        ASSERT_EQ(2u, events.size());
+        ASSERT_TRUE(MidiSharedRing::IsOverflowMarker(events[0].data, events[0].length));
+        EXPECT_EQ(5u, events[0].data[1]);
+        EXPECT_EQ(0x20903C7Fu, events[1].data[0]);
+        ring->CommitBatch();
+        EXPECT_EQ(5u, ring->GetDroppedEvents());
+    }
+    const MidiClientCounters &clientCounters = (*inputConnection.SnapshotClients())[0]->GetCounters();
+    EXPECT_EQ(0u, clientCounters.wouldBlockDrops.Load());
+
+    std::string dump;
+    inputConnection.Dump(dump);
+    EXPECT_NE(std::string::npos, dump.find("driver_drops 5"));
+}
+
+/**
+ * @tc.name   : Test client list publication
+ * @tc.number : DeviceConnectionClientList_001
+ * @tc.desc   : published client lists never change under a reader; the input path picks up adds and removes.
+ */
+HWTEST_F(MidiDeviceConnectionUnitTest, DeviceConnectionClientList_001, TestSize.Level1)
+{
+    DeviceConnectionInfo inputInfo{};
+    inputInfo.deviceId = 13;
+    inputInfo.direction = MidiPortDirection::INPUT;
+    inputInfo.portIndex = 0;
+    DeviceConnectionForInput inputConnection(inputInfo);
+    std::shared_ptr<MidiSharedRing> firstRing;
+    std::shared_ptr<MidiSharedRing> secondRing;
+    ASSERT_EQ(MIDI_STATUS_OK, inputConnection.AddClientConnection(80, 1250, firstRing));
+    auto before = inputConnection.SnapshotClients();
+
+    std::vector<uint32_t> payloadWords{0x20903C7F};
+    std::vector<MidiEventInner> deviceEvents{MakeMidiEventInner(1, payloadWords)};
+    inputConnection.HandleDeviceUmpInput(deviceEvents);
+    ASSERT_EQ(MIDI_STATUS_OK, inputConnection.AddClientConnection(81, 1251, secondRing));
+    inputConnection.HandleDeviceUmpInput(deviceEvents);
+    EXPECT_EQ(1u, before->size());
+    EXPECT_EQ(2u, inputConnection.SnapshotClients()->size());
+    EXPECT_EQ(2u, firstRing->GetUsedBytes() / secondRing->GetUsedBytes());
+
+    inputConnection.RemoveClientConnection(80);
+    EXPECT_FALSE(inputConnection.HasClientConnection(80));
+    EXPECT_TRUE(inputConnection.HasClientConnection(81));
+    const uint32_t firstUsed = firstRing->GetUsedBytes();
+    inputConnection.HandleDeviceUmpInput(deviceEvents);
+    EXPECT_EQ(firstUsed, firstRing->GetUsedBytes());
+    EXPECT_EQ(1u, before->size());
+    EXPECT_EQ(80u, before->front()->GetClientId());
+    EXPECT_EQ(3u, inputConnection.GetCounters().eventsIn.Load());
+    EXPECT_EQ(4u, inputConnection.GetCounters().eventsOut.Load());
+}
+
 //==================== DeviceConnectionForOutput ====================//
 
 /**
@@ -350,5 +649,379 @@ HWTEST_F(MidiDeviceConnectionUnitTest, DeviceConnectionForOutput_003, TestSize.L
     }
 }
 
+/**
+ * @tc.name   : Test DeviceConnectionForOutput Flush
+ * @tc.number : DeviceConnectionForOutput_004
+ * @tc.desc   : a flush request drops the client's scheduled events and queued ring records, later events survive.
+ */
+HWTEST_F(MidiDeviceConnectionUnitTest, DeviceConnectionForOutput_004, TestSize.Level1)
+{
+    DeviceConnectionInfo deviceConnectionInfo{};
+    deviceConnectionInfo.driver = nullptr;
+    deviceConnectionInfo.deviceId = 6;
+    deviceConnectionInfo.direction = MidiPortDirection::OUTPUT;
+    deviceConnectionInfo.portIndex = 0;
+
+    DeviceConnectionForOutput outputConnection(deviceConnectionInfo);
+    std::shared_ptr<MidiSharedRing> clientRingBuffer;
+    ASSERT_EQ(MIDI_STATUS_OK, outputConnection.AddClientConnection(11, 1235, clientRingBuffer));
+    ASSERT_NE(nullptr, clientRingBuffer);
+    auto clientConnection = outputConnection.SnapshotClients()->front();
+
+    const uint64_t farFuture = static_cast<uint64_t>(
+        duration_cast<nanoseconds>((steady_clock::now() + seconds(10)).time_since_epoch()).count());
+    std::vector<uint32_t> payloadWords{0x20903C7F};
+    for (uint64_t i = 0; i < 4; ++i) {
+        ASSERT_EQ(MidiStatusCode::OK, clientRingBuffer->TryWriteEvent(MakeMidiEventInner(farFuture + i, payloadWords),
+            false));
+    }
+    // worker thread not started, drive the drain step by hand
+    outputConnection.RefreshClientsSnapshot();
+    outputConnection.DrainAllClientsRings();
+    EXPECT_TRUE(clientConnection->HasPending());
+
+    ASSERT_EQ(MidiStatusCode::OK, clientRingBuffer->TryWriteEvent(MakeMidiEventInner(farFuture + 10, payloadWords),
+        false));
+    clientRingBuffer->RequestFlush();
+    ASSERT_EQ(MidiStatusCode::OK, clientRingBuffer->TryWriteEvent(MakeMidiEventInner(farFuture + 20, payloadWords),
+        false));
+    outputConnection.DrainAllClientsRings();
+
+    EXPECT_FALSE(clientRingBuffer->IsFlushRequested());
+    EXPECT_TRUE(clientRingBuffer->IsEmpty());
+    ClientConnectionInServer::PendingEvent pendingEvent{};
+    ASSERT_TRUE(clientConnection->PopPendingTop(pendingEvent));
+    EXPECT_EQ(farFuture + 20, pendingEvent.timestamp);
+    EXPECT_FALSE(clientConnection->HasPending());
+}
+
+/**
+ * @tc.name   : Test DeviceConnectionForOutput Merge
+ * @tc.number : DeviceConnectionForOutput_005
+ * @tc.desc   : due events of several clients reach the driver merged in due order.
+ */
+HWTEST_F(MidiDeviceConnectionUnitTest, DeviceConnectionForOutput_005, TestSize.Level1)
+{
+    RecordingDriver driver;
+    DeviceConnectionInfo deviceConnectionInfo{};
+    deviceConnectionInfo.driver = &driver;
+    deviceConnectionInfo.deviceId = 7;
+    deviceConnectionInfo.direction = MidiPortDirection::OUTPUT;
+    deviceConnectionInfo.portIndex = 0;
+
+    DeviceConnectionForOutput outputConnection(deviceConnectionInfo);
+    constexpr uint32_t clientCount = 3;
+    constexpr uint64_t eventsPerClient = 5;
+    std::vector<std::shared_ptr<MidiSharedRing>> rings(clientCount);
+    std::vector<uint32_t> payloadWords{0x20903C7F};
+    for (uint32_t client = 0; client < clientCount; ++client) {
+        ASSERT_EQ(MIDI_STATUS_OK, outputConnection.AddClientConnection(20 + client, 1236, rings[client]));
+        // timestamps far in the past of steady_clock, so everything is due; client k owns k+1, k+1+3, ...
+        for (uint64_t i = 0; i < eventsPerClient; ++i) {
+            ASSERT_EQ(MidiStatusCode::OK, rings[client]->TryWriteEvent(
+                MakeMidiEventInner(1 + client + i * clientCount, payloadWords), false));
+        }
+    }
+    // a later client with nothing due must not hold the others back
+    std::shared_ptr<MidiSharedRing> idleRing;
+    ASSERT_EQ(MIDI_STATUS_OK, outputConnection.AddClientConnection(30, 1236, idleRing));
+    const uint64_t farFuture = static_cast<uint64_t>(
+        duration_cast<nanoseconds>((steady_clock::now() + seconds(10)).time_since_epoch()).count());
+    ASSERT_EQ(MidiStatusCode::OK, idleRing->TryWriteEvent(MakeMidiEventInner(farFuture, payloadWords), false));
+
+    outputConnection.RefreshClientsSnapshot();
+    outputConnection.DrainAllClientsRings();
+    outputConnection.CollectDueEventsFromClientHeaps();
+    outputConnection.FlushSendCacheToDriver();
+
+    ASSERT_EQ(clientCount * eventsPerClient, driver.timestamps.size());
+    for (size_t i = 0; i < driver.timestamps.size(); ++i) {
+        EXPECT_EQ(i + 1, driver.timestamps[i]);
+    }
+    ASSERT_EQ(1u, outputConnection.dueHeap_.size());
+    EXPECT_EQ(farFuture, static_cast<uint64_t>(duration_cast<nanoseconds>(
+        outputConnection.dueHeap_.front().due.time_since_epoch()).count()));
+}
+
+/**
+ * @tc.name   : Test DeviceConnectionForOutput Lanes
+ * @tc.number : DeviceConnectionForOutput_006
+ * @tc.desc   : lanes of one client are numbered, merged by timestamp and removed together.
+ */
+HWTEST_F(MidiDeviceConnectionUnitTest, DeviceConnectionForOutput_006, TestSize.Level1)
+{
+    RecordingDriver driver;
+    DeviceConnectionInfo deviceConnectionInfo{};
+    deviceConnectionInfo.driver = &driver;
+    deviceConnectionInfo.deviceId = 7;
+    deviceConnectionInfo.direction = MidiPortDirection::OUTPUT;
+    deviceConnectionInfo.portIndex = 0;
+
+    DeviceConnectionForOutput outputConnection(deviceConnectionInfo);
+    constexpr uint32_t laneCount = 3;
+    constexpr uint32_t clientId = 40;
+    std::vector<std::shared_ptr<MidiSharedRing>> lanes(laneCount);
+    for (uint32_t lane = 0; lane < laneCount; ++lane) {
+        ASSERT_EQ(MIDI_STATUS_OK, outputConnection.AddClientConnection(clientId, 1237, lanes[lane]));
+    }
+    std::shared_ptr<MidiSharedRing> otherRing;
+    ASSERT_EQ(MIDI_STATUS_OK, outputConnection.AddClientConnection(41, 1237, otherRing));
+    EXPECT_EQ(laneCount, outputConnection.CountClientConnections(clientId));
+    auto clients = outputConnection.SnapshotClients();
+    for (uint32_t lane = 0; lane < laneCount; ++lane) {
+        EXPECT_EQ(lane, (*clients)[lane]->GetLane());
+    }
+    EXPECT_EQ(0u, clients->back()->GetLane());
+
+    // every lane is in order on its own, together they interleave
+    std::vector<uint32_t> payloadWords{0x20903C7F};
+    const std::vector<std::vector<uint64_t>> laneTimestamps = {{1, 4, 5}, {2, 7}, {3, 6, 8}};
+    for (uint32_t lane = 0; lane < laneCount; ++lane) {
+        for (uint64_t timestamp : laneTimestamps[lane]) {
+            ASSERT_EQ(MidiStatusCode::OK, lanes[lane]->TryWriteEvent(
+                MakeMidiEventInner(timestamp, payloadWords), false));
+        }
+    }
+    outputConnection.RunOnce();
+    ASSERT_EQ(8u, driver.timestamps.size());
+    for (size_t i = 0; i < driver.timestamps.size(); ++i) {
+        EXPECT_EQ(i + 1, driver.timestamps[i]);
+    }
+
+    std::string dump;
+    outputConnection.Dump(dump);
+    EXPECT_NE(std::string::npos, dump.find("client 40 lane 2: events 3"));
+
+    outputConnection.RemoveClientConnection(clientId);
+    EXPECT_FALSE(outputConnection.HasClientConnection(clientId));
+    EXPECT_TRUE(outputConnection.HasClientConnection(41));
+}
+
+/**
+ * @tc.name   : Test DeviceConnectionForOutput Allocations
+ * @tc.number : DeviceConnectionForOutput_007
+ * @tc.desc   : once warmed up, draining, scheduling and sending to the driver allocate nothing.
+ */
+HWTEST_F(MidiDeviceConnectionUnitTest, DeviceConnectionForOutput_007, TestSize.Level1)
+{
+    CountingDriver driver;
+    DeviceConnectionInfo deviceConnectionInfo{};
+    deviceConnectionInfo.driver = &driver;
+    deviceConnectionInfo.deviceId = 8;
+    deviceConnectionInfo.direction = MidiPortDirection::OUTPUT;
+    deviceConnectionInfo.portIndex = 0;
+
+    DeviceConnectionForOutput outputConnection(deviceConnectionInfo);
+    std::shared_ptr<MidiSharedRing> clientRing;
+    ASSERT_EQ(MIDI_STATUS_OK, outputConnection.AddClientConnection(50, 1238, clientRing));
+
+    const std::vector<uint32_t> noteOn{0x20903C7F};
+    const std::vector<uint32_t> sysEx{0x30160102, 0x03040506};
+    constexpr uint32_t eventsPerRound = 16;
+    auto sendRound = [&](uint64_t round) {
+        for (uint32_t i = 0; i < eventsPerRound; ++i) {
+            // even: immediate, odd: scheduled in the past of steady_clock, so due right away
+            const uint64_t timestamp = (i % 2 == 0) ? 0 : round * eventsPerRound + i;
+            ASSERT_EQ(MidiStatusCode::OK, clientRing->TryWriteEvent(
+                MakeMidiEventInner(timestamp, (i % 4 < 2) ? noteOn : sysEx), false));
+        }
+        outputConnection.RunOnce();
+    };
+    constexpr uint64_t warmupRounds = 4;
+    for (uint64_t round = 1; round <= warmupRounds; ++round) {
+        sendRound(round);
+    }
+    ASSERT_EQ(warmupRounds * eventsPerRound, driver.sent.load());
+
+    constexpr uint64_t measuredRounds = 100;
+    g_allocations.store(0);
+    g_countAllocations = true;
+    for (uint64_t round = warmupRounds + 1; round <= warmupRounds + measuredRounds; ++round) {
+        sendRound(round);
+    }
+    g_countAllocations = false;
+    EXPECT_EQ(0u, g_allocations.load());
+    EXPECT_EQ((warmupRounds + measuredRounds) * eventsPerRound, driver.sent.load());
+}
+
+/**
+ * @tc.name   : Test MidiOutputWorkerPool
+ * @tc.number : OutputWorkerPool_001
+ * @tc.desc   : started ports spread over the configured workers, scheduled events are sent by the shared timer.
+ */
+HWTEST_F(MidiDeviceConnectionUnitTest, OutputWorkerPool_001, TestSize.Level1)
+{
+    auto &pool = MidiOutputWorkerPool::GetInstance();
+    const uint32_t savedWorkerCount = pool.GetWorkerCount();
+    pool.SetWorkerCount(2);
+
+    constexpr uint32_t portCount = 4;
+    CountingDriver driver;
+    std::vector<std::unique_ptr<DeviceConnectionForOutput>> ports;
+    std::vector<std::shared_ptr<MidiSharedRing>> rings(portCount);
+    for (uint32_t i = 0; i < portCount; ++i) {
+        DeviceConnectionInfo deviceConnectionInfo{};
+        deviceConnectionInfo.driver = &driver;
+        deviceConnectionInfo.deviceId = 8;
+        deviceConnectionInfo.direction = MidiPortDirection::OUTPUT;
+        deviceConnectionInfo.portIndex = i;
+        ports.push_back(std::make_unique<DeviceConnectionForOutput>(deviceConnectionInfo));
+        ASSERT_EQ(MIDI_STATUS_OK, ports.back()->Start());
+        ASSERT_EQ(MIDI_STATUS_OK, ports.back()->AddClientConnection(40 + i, 1237, rings[i]));
+    }
+    auto stats = pool.GetStats();
+    ASSERT_GE(stats.size(), 2u);
+    EXPECT_EQ(2u, stats[0].portCount);
+    EXPECT_EQ(2u, stats[1].portCount);
+
+    // one realtime and one scheduled event per port, the scheduled one needs the worker timer
+    std::vector<uint32_t> payloadWords{0x20903C7F};
+    const uint64_t soon = static_cast<uint64_t>(
+        duration_cast<nanoseconds>((steady_clock::now() + milliseconds(2)).time_since_epoch()).count());
+    for (auto &ring : rings) {
+        ASSERT_EQ(MidiStatusCode::OK, ring->TryWriteEvent(MakeMidiEventInner(0, payloadWords), true));
+        ASSERT_EQ(MidiStatusCode::OK, ring->TryWriteEvent(MakeMidiEventInner(soon, payloadWords), true));
+    }
+    for (int i = 0; i < 200 && driver.sent.load() < 2 * portCount; ++i) {
+        std::this_thread::sleep_for(milliseconds(5));
+    }
+    EXPECT_EQ(2 * portCount, driver.sent.load());
+
+    stats = pool.GetStats();
+    for (uint32_t i = 0; i < 2; ++i) {
+        EXPECT_GT(stats[i].wakeups, 0u);
+        EXPECT_GE(stats[i].portRuns, 2u);
+    }
+
+    for (auto &port : ports) {
+        EXPECT_EQ(MIDI_STATUS_OK, port->Stop());
+    }
+    stats = pool.GetStats();
+    for (const auto &workerStats : stats) {
+        EXPECT_EQ(0u, workerStats.portCount);
+    }
+    pool.SetWorkerCount(savedWorkerCount);
+}
+
+/**
+ * @tc.name   : Test MidiOutputWorker deadline modes
+ * @tc.number : OutputWorkerDeadline_001
+ * @tc.desc   : with an early timer wakeup the sleep and spin modes still send no earlier than the due time,
+ *              and the port records the lateness.
+ */
+HWTEST_F(MidiDeviceConnectionUnitTest, OutputWorkerDeadline_001, TestSize.Level1)
+{
+    for (MidiDeadlineMode mode : {MidiDeadlineMode::NONE, MidiDeadlineMode::SLEEP, MidiDeadlineMode::SPIN}) {
+        MidiDeadlineConfig deadlineConfig;
+        deadlineConfig.mode = mode;
+        deadlineConfig.leadNs = duration_cast<nanoseconds>(milliseconds(2)).count();
+        MidiOutputWorker worker(0, MidiThreadConfig{}, deadlineConfig);
+        ASSERT_EQ(MIDI_STATUS_OK, worker.Start());
+
+        TimingDriver driver;
+        DeviceConnectionInfo deviceConnectionInfo{};
+        deviceConnectionInfo.driver = &driver;
+        deviceConnectionInfo.deviceId = 9;
+        deviceConnectionInfo.direction = MidiPortDirection::OUTPUT;
+        DeviceConnectionForOutput port(deviceConnectionInfo);
+        // move the port from the shared pool onto the worker under test
+        ASSERT_EQ(MIDI_STATUS_OK, port.Start());
+        MidiOutputWorkerPool::GetInstance().Detach(&port);
+        ASSERT_EQ(MIDI_STATUS_OK, worker.Attach(&port));
+        std::shared_ptr<MidiSharedRing> ring;
+        ASSERT_EQ(MIDI_STATUS_OK, port.AddClientConnection(50, 1238, ring));
+
+        std::vector<uint32_t> payloadWords{0x20903C7F};
+        const int64_t dueNs = duration_cast<nanoseconds>((steady_clock::now() + milliseconds(5)).time_since_epoch())
+            .count();
+        ASSERT_EQ(MidiStatusCode::OK, ring->TryWriteEvent(
+            MakeMidiEventInner(static_cast<uint64_t>(dueNs), payloadWords), true));
+        for (int i = 0; i < 200 && driver.sentAtNs.load() == 0; ++i) {
+            std::this_thread::sleep_for(milliseconds(5));
+        }
+        EXPECT_GE(driver.sentAtNs.load(), dueNs);
+
+        worker.Detach(&port);
+        const MidiHistogram &lateness = port.GetHistograms().lateness;
+        EXPECT_EQ(1u, lateness.Count());
+        EXPECT_LE(static_cast<int64_t>(lateness.Max()), driver.sentAtNs.load() - dueNs);
+        worker.Stop();
+    }
+}
+
+/**
+ * @tc.name   : Test MidiOutputWorker parking
+ * @tc.number : OutputWorkerPark_001
+ * @tc.desc   : a client whose timer wheel is full keeps records in its ring, the worker still sleeps until the
+ *              earliest due time instead of polling the ring.
+ */
+HWTEST_F(MidiDeviceConnectionUnitTest, OutputWorkerPark_001, TestSize.Level1)
+{
+    MidiOutputWorker worker(0, MidiThreadConfig{}, MidiDeadlineConfig{});
+    ASSERT_EQ(MIDI_STATUS_OK, worker.Start());
+    CountingDriver driver;
+    DeviceConnectionInfo deviceConnectionInfo{};
+    deviceConnectionInfo.driver = &driver;
+    deviceConnectionInfo.deviceId = 10;
+    deviceConnectionInfo.direction = MidiPortDirection::OUTPUT;
+    DeviceConnectionForOutput port(deviceConnectionInfo);
+    ASSERT_EQ(MIDI_STATUS_OK, port.Start());
+    MidiOutputWorkerPool::GetInstance().Detach(&port);
+    std::shared_ptr<MidiSharedRing> ring;
+    ASSERT_EQ(MIDI_STATUS_OK, port.AddClientConnection(51, 1239, ring));
+    std::shared_ptr<ClientConnectionInServer> client = port.SnapshotClients()->front();
+    client->SetMaxPending(4);
+    ASSERT_EQ(MIDI_STATUS_OK, worker.Attach(&port));
+
+    std::vector<uint32_t> payloadWords{0x20903C7F};
+    const auto dueNs = static_cast<uint64_t>(
+        duration_cast<nanoseconds>((steady_clock::now() + seconds(10)).time_since_epoch()).count());
+    for (int i = 0; i < 8; ++i) {
+        ASSERT_EQ(MidiStatusCode::OK, ring->TryWriteEvent(MakeMidiEventInner(dueNs, payloadWords), true));
+    }
+    for (int i = 0; i < 200 && client->PendingCount() < 4; ++i) {
+        std::this_thread::sleep_for(milliseconds(5));
+    }
+    ASSERT_TRUE(client->IsPendingFull());
+    std::this_thread::sleep_for(milliseconds(20));
+    const uint64_t wakeupsBefore = worker.GetStats().wakeups;
+    std::this_thread::sleep_for(milliseconds(200));
+    EXPECT_LT(worker.GetStats().wakeups - wakeupsBefore, 5u);
+    EXPECT_FALSE(ring->IsEmpty());
+    EXPECT_EQ(0u, driver.sent.load());
+
+    worker.Detach(&port);
+    worker.Stop();
+}
+
+/**
+ * @tc.name   : Test MidiOutputWorkerPool deadline config
+ * @tc.number : OutputWorkerDeadline_002
+ * @tc.desc   : a malformed key keeps its previous value without discarding the valid keys next to it.
+ */
+HWTEST_F(MidiDeviceConnectionUnitTest, OutputWorkerDeadline_002, TestSize.Level1)
+{
+    auto &pool = MidiOutputWorkerPool::GetInstance();
+    const MidiDeadlineConfig savedConfig = pool.GetDeadlineConfig();
+    MidiDeadlineConfig baseConfig;
+    baseConfig.mode = MidiDeadlineMode::SLEEP;
+    pool.SetDeadlineConfig(baseConfig);
+
+    pool.LoadDeadlineConfig({{"output_deadline_mode", "busy"}, {"output_deadline_lead_us", "300"},
+        {"output_timer_slack_ns", "2000"}});
+    MidiDeadlineConfig loaded = pool.GetDeadlineConfig();
+    EXPECT_EQ(MidiDeadlineMode::SLEEP, loaded.mode);
+    EXPECT_EQ(300000, loaded.leadNs);
+    EXPECT_EQ(2000u, loaded.timerSlackNs);
+
+    pool.LoadDeadlineConfig({{"output_deadline_mode", "spin"}, {"output_deadline_lead_us", "-1"},
+        {"output_timer_slack_ns", "1e3"}});
+    loaded = pool.GetDeadlineConfig();
+    EXPECT_EQ(MidiDeadlineMode::SPIN, loaded.mode);
+    EXPECT_EQ(300000, loaded.leadNs);
+    EXPECT_EQ(2000u, loaded.timerSlackNs);
+    pool.SetDeadlineConfig(savedConfig);
+}
+
 } // namespace MIDI
 } // namespace OHOS
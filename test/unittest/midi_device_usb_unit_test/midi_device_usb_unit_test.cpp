@@ -13,12 +13,20 @@
  * limitations under the License.
  */
 
+#include "fake_midi_hdi.h"
 #include "midi_device_driver.h"
 #include "midi_device_usb.h"
+#include "midi_hdi_input_ring.h"
 #include "midi_info.h"
 #include "native_midi_base.h"
 #include "v1_0/imidi_interface.h"
 
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <utility>
+
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
@@ -247,4 +255,224 @@ HWTEST_F(MidiDeviceUsbUnitTest, CloseInputPort001, TestSize.Level0)
     EXPECT_CALL(*mockMidiHdi, CloseInputPort(deviceId, portIndex)).WillOnce(Return(MIDI_STATUS_OK));
 
     EXPECT_EQ(MIDI_STATUS_OK, driver.CloseInputPort(deviceId, portIndex));
+}
+
+/**
+ * @tc.name: HanleUmpInput001
+ * @tc.desc: every flush hands the events to the HDI, message payloads are reused from one flush to the next.
+ * @tc.type: FUNC
+ */
+HWTEST_F(MidiDeviceUsbUnitTest, HanleUmpInput001, TestSize.Level0)
+{
+    constexpr int64_t deviceId = 100;
+    constexpr uint32_t portIndex = 2;
+    sptr<MockIMidiInterface> mockMidiHdi = sptr<MockIMidiInterface>::MakeSptr();
+    ASSERT_NE(nullptr, mockMidiHdi);
+    UsbMidiTransportDeviceDriver driver;
+    driver.midiHdi_ = mockMidiHdi;
+
+    std::vector<std::vector<HDI::Midi::V1_0::MidiMessage>> sent;
+    std::vector<const uint32_t *> firstPayloads;
+    EXPECT_CALL(*mockMidiHdi, SendMidiMessages(deviceId, portIndex, _))
+        .Times(3)
+        .WillRepeatedly(Invoke([&](int64_t, uint32_t, const std::vector<HDI::Midi::V1_0::MidiMessage> &messages) {
+            sent.push_back(messages);
+            firstPayloads.push_back(messages.empty() ? nullptr : messages[0].data.data());
+            return MIDI_STATUS_OK;
+        }));
+
+    const uint32_t sysEx[2] = {0x30160102u, 0x03040506u};
+    const uint32_t noteOn[1] = {0x20903C7Fu};
+    std::vector<MidiEventInner> batch = {{10, 2, sysEx}, {20, 1, noteOn}};
+    EXPECT_EQ(MIDI_STATUS_OK, driver.HanleUmpInput(deviceId, portIndex, batch));
+    batch = {{30, 1, noteOn}};
+    EXPECT_EQ(MIDI_STATUS_OK, driver.HanleUmpInput(deviceId, portIndex, batch));
+    batch = {{40, 1, noteOn}, {50, 2, sysEx}};
+    EXPECT_EQ(MIDI_STATUS_OK, driver.HanleUmpInput(deviceId, portIndex, batch));
+
+    ASSERT_EQ(3u, sent.size());
+    ASSERT_EQ(2u, sent[0].size());
+    EXPECT_EQ(10, sent[0][0].timestamp);
+    EXPECT_EQ((std::vector<uint32_t>{0x30160102u, 0x03040506u}), sent[0][0].data);
+    EXPECT_EQ(20, sent[0][1].timestamp);
+    EXPECT_EQ((std::vector<uint32_t>{0x20903C7Fu}), sent[0][1].data);
+    ASSERT_EQ(1u, sent[1].size());
+    EXPECT_EQ(30, sent[1][0].timestamp);
+    EXPECT_EQ((std::vector<uint32_t>{0x20903C7Fu}), sent[1][0].data);
+    ASSERT_EQ(2u, sent[2].size());
+    EXPECT_EQ(50, sent[2][1].timestamp);
+    EXPECT_EQ((std::vector<uint32_t>{0x30160102u, 0x03040506u}), sent[2][1].data);
+    // the first message keeps its payload buffer across flushes
+    EXPECT_EQ(firstPayloads[0], firstPayloads[1]);
+    EXPECT_EQ(firstPayloads[0], firstPayloads[2]);
+}
+
+namespace {
+struct ReceivedInput {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<std::pair<uint64_t, std::vector<uint32_t>>> events;
+
+    UmpInputCallback MakeCallback()
+    {
+        return [this](std::vector<MidiEventInner> &batch) {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (const auto &event : batch) {
+                events.emplace_back(event.timestamp, std::vector<uint32_t>(event.data, event.data + event.length));
+            }
+            cv.notify_all();
+        };
+    }
+
+    bool WaitForCount(size_t count)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        return cv.wait_for(lock, std::chrono::seconds(5), [&]() { return events.size() >= count; });
+    }
+};
+} // namespace
+
+/**
+ * @tc.name: OpenInputPort_SharedRing_001
+ * @tc.desc: with a shared input HDI the port is read from the ring, closing stops the HDI writer and the reader.
+ * @tc.type: FUNC
+ */
+HWTEST_F(MidiDeviceUsbUnitTest, OpenInputPort_SharedRing_001, TestSize.Level0)
+{
+    constexpr int64_t deviceId = 100;
+    constexpr uint32_t portIndex = 1;
+    sptr<FakeMidiHdi> fakeHdi = sptr<FakeMidiHdi>::MakeSptr();
+    ASSERT_NE(nullptr, fakeHdi);
+    UsbMidiTransportDeviceDriver driver;
+    driver.midiHdi_ = fakeHdi;
+    driver.SetSharedInput(fakeHdi->GetSharedInput());
+
+    ReceivedInput received;
+    EXPECT_EQ(MIDI_STATUS_OK, driver.OpenInputPort(deviceId, portIndex, received.MakeCallback()));
+    EXPECT_TRUE(fakeHdi->GetSharedInput()->HasRing(deviceId, portIndex));
+    EXPECT_TRUE(fakeHdi->callbacks_.empty());
+
+    const uint32_t sysEx[2] = {0x30160102u, 0x03040506u};
+    const uint32_t noteOn[1] = {0x20903C7Fu};
+    EXPECT_EQ(2u, fakeHdi->Inject(deviceId, portIndex, {{10, 2, sysEx}, {20, 1, noteOn}}));
+    EXPECT_EQ(1u, fakeHdi->Inject(deviceId, portIndex, {{30, 1, noteOn}}));
+    ASSERT_TRUE(received.WaitForCount(3));
+    {
+        std::lock_guard<std::mutex> lock(received.mutex);
+        ASSERT_EQ(3u, received.events.size());
+        EXPECT_EQ(10u, received.events[0].first);
+        EXPECT_EQ((std::vector<uint32_t>{0x30160102u, 0x03040506u}), received.events[0].second);
+        EXPECT_EQ(20u, received.events[1].first);
+        EXPECT_EQ((std::vector<uint32_t>{0x20903C7Fu}), received.events[1].second);
+        EXPECT_EQ(30u, received.events[2].first);
+    }
+
+    EXPECT_EQ(MIDI_STATUS_OK, driver.CloseInputPort(deviceId, portIndex));
+    EXPECT_FALSE(fakeHdi->GetSharedInput()->HasRing(deviceId, portIndex));
+    EXPECT_TRUE(driver.inputRings_.empty());
+    EXPECT_EQ(0u, fakeHdi->Inject(deviceId, portIndex, {{40, 1, noteOn}}));
+}
+
+/**
+ * @tc.name: OpenInputPort_SharedRing_002
+ * @tc.desc: without a shared input HDI the same fake delivers through IMidiCallback.
+ * @tc.type: FUNC
+ */
+HWTEST_F(MidiDeviceUsbUnitTest, OpenInputPort_SharedRing_002, TestSize.Level0)
+{
+    constexpr int64_t deviceId = 100;
+    constexpr uint32_t portIndex = 1;
+    sptr<FakeMidiHdi> fakeHdi = sptr<FakeMidiHdi>::MakeSptr();
+    ASSERT_NE(nullptr, fakeHdi);
+    UsbMidiTransportDeviceDriver driver;
+    driver.midiHdi_ = fakeHdi;
+
+    ReceivedInput received;
+    EXPECT_EQ(MIDI_STATUS_OK, driver.OpenInputPort(deviceId, portIndex, received.MakeCallback()));
+    EXPECT_FALSE(fakeHdi->GetSharedInput()->HasRing(deviceId, portIndex));
+    EXPECT_EQ(1u, fakeHdi->callbacks_.size());
+
+    const uint32_t noteOn[1] = {0x20903C7Fu};
+    EXPECT_EQ(1u, fakeHdi->Inject(deviceId, portIndex, {{10, 1, noteOn}}));
+    ASSERT_TRUE(received.WaitForCount(1));
+    EXPECT_EQ(10u, received.events[0].first);
+
+    EXPECT_EQ(MIDI_STATUS_OK, driver.CloseInputPort(deviceId, portIndex));
+    EXPECT_TRUE(fakeHdi->callbacks_.empty());
+}
+
+/**
+ * @tc.name: OpenInputPort_SharedRing_003
+ * @tc.desc: an HDI ring that refuses the port falls back to the callback path.
+ * @tc.type: FUNC
+ */
+HWTEST_F(MidiDeviceUsbUnitTest, OpenInputPort_SharedRing_003, TestSize.Level0)
+{
+    class RefusingSharedInput : public MidiHdiSharedInput {
+    public:
+        int32_t OpenInputRing(int64_t, uint32_t, std::shared_ptr<MidiSharedRing> &) override
+        {
+            return MIDI_STATUS_UNKNOWN_ERROR;
+        }
+        int32_t CloseInputRing(int64_t, uint32_t) override { return MIDI_STATUS_UNKNOWN_ERROR; }
+    };
+    constexpr int64_t deviceId = 100;
+    constexpr uint32_t portIndex = 1;
+    sptr<MockIMidiInterface> mockMidiHdi = sptr<MockIMidiInterface>::MakeSptr();
+    ASSERT_NE(nullptr, mockMidiHdi);
+    UsbMidiTransportDeviceDriver driver;
+    driver.midiHdi_ = mockMidiHdi;
+    driver.SetSharedInput(std::make_shared<RefusingSharedInput>());
+
+    EXPECT_CALL(*mockMidiHdi, OpenInputPort(deviceId, portIndex, _)).WillOnce(Return(MIDI_STATUS_OK));
+    EXPECT_CALL(*mockMidiHdi, CloseInputPort(deviceId, portIndex)).WillOnce(Return(MIDI_STATUS_OK));
+    EXPECT_EQ(MIDI_STATUS_OK, driver.OpenInputPort(deviceId, portIndex, [](std::vector<MidiEventInner> &) {}));
+    EXPECT_TRUE(driver.inputRings_.empty());
+    EXPECT_EQ(MIDI_STATUS_OK, driver.CloseInputPort(deviceId, portIndex));
+}
+
+/**
+ * @tc.name: MidiHdiInputRingReader_001
+ * @tc.desc: the overflow marker the HDI writes after a full ring reaches the callback ahead of the next events.
+ * @tc.type: FUNC
+ */
+HWTEST_F(MidiDeviceUsbUnitTest, MidiHdiInputRingReader_001, TestSize.Level0)
+{
+    constexpr int64_t deviceId = 100;
+    constexpr uint32_t portIndex = 1;
+    FakeMidiHdiSharedInput sharedInput;
+    std::shared_ptr<MidiSharedRing> ring = nullptr;
+    ASSERT_EQ(MIDI_STATUS_OK, sharedInput.OpenInputRing(deviceId, portIndex, ring));
+    ASSERT_NE(nullptr, ring);
+
+    // nobody reads yet, fill the ring and lose a few
+    const uint32_t noteOn[1] = {0x20903C7Fu};
+    size_t queued = 0;
+    uint32_t lost = 0;
+    for (uint64_t ts = 0; lost < 3; ++ts) {
+        if (sharedInput.Write(deviceId, portIndex, {{ts, 1, noteOn}}) == 1) {
+            ++queued;
+        } else {
+            ++lost;
+        }
+    }
+
+    ReceivedInput received;
+    MidiHdiInputRingReader reader(ring, received.MakeCallback());
+    ASSERT_EQ(MIDI_STATUS_OK, reader.Start());
+    ASSERT_TRUE(received.WaitForCount(queued));
+    // the reader commits right after its callback returns
+    for (int i = 0; i < 1000 && !ring->IsEmpty(); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    // room again, the next burst leads with the marker
+    EXPECT_EQ(1u, sharedInput.Write(deviceId, portIndex, {{1000, 1, noteOn}}));
+    ASSERT_TRUE(received.WaitForCount(queued + 2));
+    reader.Stop();
+
+    std::lock_guard<std::mutex> lock(received.mutex);
+    ASSERT_EQ(queued + 2, received.events.size());
+    EXPECT_EQ((std::vector<uint32_t>{MIDI_RING_OVERFLOW_MARKER, 3u}), received.events[queued].second);
+    EXPECT_EQ(1000u, received.events.back().first);
+    EXPECT_EQ((std::vector<uint32_t>{0x20903C7Fu}), received.events.back().second);
 }
\ No newline at end of file
@@ -123,7 +123,7 @@ HWTEST_F(MidiServerUnitTest, MidiInServer_OpenInputPort001, TestSize.Level0)
     uint32_t portIndex = 1;
 
     MidiInServer client(id, mockCallback);
-    EXPECT_NE(MIDI_STATUS_OK, client.OpenInputPort(buffer, deviceId, portIndex));
+    EXPECT_NE(MIDI_STATUS_OK, client.OpenInputPort(buffer, deviceId, portIndex, 0));
 }
 
 /**
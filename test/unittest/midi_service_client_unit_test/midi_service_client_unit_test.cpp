@@ -39,11 +39,15 @@ public:
     MOCK_METHOD(int32_t, OpenBleDevice, (const std::string &address, const sptr<IRemoteObject> &object), (override));
     MOCK_METHOD(int32_t, CloseDevice, (int64_t), (override));
     MOCK_METHOD(int32_t, GetDevicePorts, (int64_t, (std::vector<std::map<int32_t, std::string>> &)), (override));
-    MOCK_METHOD(int32_t, OpenInputPort, (std::shared_ptr<MidiSharedRing> &, int64_t, uint32_t), (override));
-    MOCK_METHOD(int32_t, OpenOutputPort, (std::shared_ptr<MidiSharedRing> &, int64_t, uint32_t), (override));
+    MOCK_METHOD(int32_t, OpenInputPort, (std::shared_ptr<MidiSharedRing> &, int64_t, uint32_t, uint32_t), (override));
+    MOCK_METHOD(int32_t, OpenOutputPort, (std::shared_ptr<MidiSharedRing> &, int64_t, uint32_t, uint32_t, bool),
+        (override));
     MOCK_METHOD(int32_t, CloseInputPort, (int64_t, uint32_t), (override));
     MOCK_METHOD(int32_t, CloseOutputPort, (int64_t, uint32_t), (override));
     MOCK_METHOD(int32_t, DestroyMidiClient, (), (override));
+    MOCK_METHOD(int32_t, GetStatistics, (std::string &statistics), (override));
+    MOCK_METHOD(int32_t, OpenOutputLane, (std::shared_ptr<MidiSharedRing> &, int64_t, uint32_t, uint32_t),
+        (override));
     MOCK_METHOD(sptr<IRemoteObject>, AsObject, (), (override));
 };
 
@@ -225,7 +229,7 @@ HWTEST_F(MidiServiceClientUnitTest, OpenInputPort_001, TestSize.Level0)
 {
     MidiServiceClient client;
     std::shared_ptr<MidiSharedRing> buffer;
-    EXPECT_EQ(client.OpenInputPort(buffer, 1, 0), MIDI_STATUS_GENERIC_IPC_FAILURE);
+    EXPECT_EQ(client.OpenInputPort(buffer, 1, 0, 0), MIDI_STATUS_GENERIC_IPC_FAILURE);
 }
 
 /**
@@ -244,14 +248,14 @@ HWTEST_F(MidiServiceClientUnitTest, OpenInputPort_002, TestSize.Level0)
     int64_t deviceId = 1003;
     uint32_t portIndex = 3;
 
-    EXPECT_CALL(*mockIpc, OpenInputPort(_, deviceId, portIndex))
+    EXPECT_CALL(*mockIpc, OpenInputPort(_, deviceId, portIndex, 0))
         .Times(1)
-        .WillOnce(Invoke([](std::shared_ptr<MidiSharedRing> &outBuffer, int64_t, uint32_t) {
+        .WillOnce(Invoke([](std::shared_ptr<MidiSharedRing> &outBuffer, int64_t, uint32_t, uint32_t) {
             outBuffer = MidiSharedRing::CreateFromLocal(256);
             return (outBuffer != nullptr) ? MIDI_STATUS_OK : MIDI_STATUS_UNKNOWN_ERROR;
         }));
 
-    EXPECT_EQ(client.OpenInputPort(buffer, deviceId, portIndex), MIDI_STATUS_OK);
+    EXPECT_EQ(client.OpenInputPort(buffer, deviceId, portIndex, 0), MIDI_STATUS_OK);
     EXPECT_NE(buffer, nullptr);
 }
 
@@ -298,4 +302,24 @@ HWTEST_F(MidiServiceClientUnitTest, DestroyMidiClient_001, TestSize.Level0)
     ASSERT_NE(nullptr, mockIpc);
     client->ipc_ = mockIpc;
     EXPECT_EQ(MIDI_STATUS_OK, client->DestroyMidiClient());
+}
+
+/**
+ * @tc.name: GetStatistics_001
+ * @tc.desc: without ipc_ the call fails, otherwise the text comes from ipc_->GetStatistics.
+ * @tc.type: FUNC
+ */
+HWTEST_F(MidiServiceClientUnitTest, GetStatistics_001, TestSize.Level0)
+{
+    MidiServiceClient client;
+    std::string statistics;
+    EXPECT_EQ(MIDI_STATUS_GENERIC_IPC_FAILURE, client.GetStatistics(statistics));
+
+    sptr<MockIpcMidiInServer> mockIpc = sptr<MockIpcMidiInServer>::MakeSptr();
+    ASSERT_NE(mockIpc, nullptr);
+    InjectIpcForTest(client, mockIpc);
+    EXPECT_CALL(*mockIpc, GetStatistics(_)).WillOnce(DoAll(SetArgReferee<0>("MIDI clients 1"),
+        Return(MIDI_STATUS_OK)));
+    EXPECT_EQ(MIDI_STATUS_OK, client.GetStatistics(statistics));
+    EXPECT_EQ("MIDI clients 1", statistics);
 }
\ No newline at end of file
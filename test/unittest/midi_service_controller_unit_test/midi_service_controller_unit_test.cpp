@@ -361,6 +361,73 @@ HWTEST_F(MidiServiceControllerUnitTest, OpenInputPort001, TestSize.Level0)
     EXPECT_NE(inputPort, inputPortConnections.end());
 }
 
+/**
+ * @tc.name: Dump001
+ * @tc.desc: the statistics dump lists the open port with its port and client counters
+ * @tc.type: FUNC
+ */
+HWTEST_F(MidiServiceControllerUnitTest, Dump001, TestSize.Level0)
+{
+    int64_t driverId = 201;
+    int64_t deviceId = SimulateDeviceConnection(driverId, "Midi Controller");
+    uint32_t portIndex = 0;
+    EXPECT_CALL(*rawMockDriver_, OpenDevice(driverId)).WillOnce(Return(MIDI_STATUS_OK));
+    controller_->OpenDevice(clientId_, deviceId);
+    EXPECT_CALL(*rawMockDriver_, OpenInputPort(driverId, portIndex, _)).WillOnce(Return(MIDI_STATUS_OK));
+    std::shared_ptr<MidiSharedRing> buffer;
+    ASSERT_EQ(MIDI_STATUS_OK, controller_->OpenInputPort(clientId_, buffer, deviceId, portIndex));
+
+    auto it = controller_->deviceClientContexts_.find(deviceId);
+    ASSERT_NE(it, controller_->deviceClientContexts_.end());
+    auto connection = it->second->inputDeviceconnections_[portIndex];
+    ASSERT_NE(nullptr, connection);
+    std::vector<uint32_t> payloadWords{0x20903C7F};
+    std::vector<MidiEventInner> events{{1, payloadWords.size(), payloadWords.data()}};
+    connection->HandleDeviceUmpInput(events);
+
+    std::string dump;
+    controller_->Dump(dump);
+    EXPECT_NE(std::string::npos, dump.find("device " + std::to_string(deviceId) + " input port 0"));
+    EXPECT_NE(std::string::npos, dump.find("events_in 1 events_out 1 bytes_in 4 bytes_out 4 driver_errors 0"));
+    EXPECT_NE(std::string::npos, dump.find("client " + std::to_string(clientId_) + ": events 1 bytes 4"));
+    EXPECT_NE(std::string::npos, dump.find("MIDI output workers"));
+}
+
+/**
+ * @tc.name: DumpClient001
+ * @tc.desc: the per client statistics only carry the caller's own connections
+ * @tc.type: FUNC
+ */
+HWTEST_F(MidiServiceControllerUnitTest, DumpClient001, TestSize.Level0)
+{
+    int64_t driverId = 202;
+    int64_t deviceId = SimulateDeviceConnection(driverId, "Midi Controller");
+    uint32_t portIndex = 0;
+    EXPECT_CALL(*rawMockDriver_, OpenDevice(driverId)).WillOnce(Return(MIDI_STATUS_OK));
+    controller_->OpenDevice(clientId_, deviceId);
+    EXPECT_CALL(*rawMockDriver_, OpenInputPort(driverId, portIndex, _)).WillOnce(Return(MIDI_STATUS_OK));
+    std::shared_ptr<MidiSharedRing> buffer;
+    ASSERT_EQ(MIDI_STATUS_OK, controller_->OpenInputPort(clientId_, buffer, deviceId, portIndex));
+
+    sptr<IRemoteObject> otherObj;
+    uint32_t otherClientId = 0;
+    controller_->CreateMidiInServer(mockCallback_->AsObject(), otherObj, otherClientId);
+    ASSERT_NE(clientId_, otherClientId);
+
+    std::string own;
+    controller_->DumpClient(clientId_, own);
+    EXPECT_NE(std::string::npos, own.find("device " + std::to_string(deviceId) + " input port 0"));
+    EXPECT_NE(std::string::npos, own.find("client " + std::to_string(clientId_) + ": events 0"));
+    EXPECT_EQ(std::string::npos, own.find("events_in"));
+    EXPECT_EQ(std::string::npos, own.find("MIDI output workers"));
+
+    std::string other;
+    controller_->DumpClient(otherClientId, other);
+    EXPECT_EQ(std::string::npos, other.find("device "));
+    EXPECT_EQ(std::string::npos, other.find("client " + std::to_string(clientId_)));
+    controller_->DestroyMidiClient(otherClientId);
+}
+
 /**
  * @tc.name: OpenInputPort002
  * @tc.desc: Fail to Open Input Port if Device not opened first